@@ -0,0 +1,125 @@
+/**
+ * @file account_bench.cpp
+ * @brief Times the per-account hot paths: a withdrawal split into its parts, and lazy interest.
+ *
+ * Build and run with `make bench`. Each figure is the mean over every account and round, in nanoseconds:
+ *   withdraw (logged)    Withdraw with its message formatted, as the menu runs it
+ *   withdraw (quiet)     Withdraw inside a QuietScope: policy check, arithmetic and BalanceIndex update
+ *   policy check only    VisitAccount and the AccountPolicy minimum-balance check, nothing changed
+ *   interest             a rollover of every bank, then GetBalance settling it
+ * The difference between the first two is the iostream cost, and between the last two withdrawal
+ * figures the cost of the BalanceIndex update and the balance change. The objects are built with the
+ * Makefile's flags; to time an optimised build, run `make clean` and then
+ * `make bench CPPFLAGS="-std=c++20 -pthread -O2"`.
+ */
+
+#include "../include/activity_log.hpp"
+#include "../include/bank.hpp"
+#include "../include/bank_account.hpp"
+#include "../include/customer.hpp"
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <streambuf>
+#include <type_traits>
+#include <vector>
+
+namespace
+{
+    constexpr size_t CUSTOMERS = 20'000; // Each with a checking and a saving account
+    constexpr size_t ROUNDS = 50;
+    constexpr f64 OPENING_BALANCE = 1'000'000.0;
+    constexpr f64 WITHDRAWAL = 1.0;
+
+    /**
+     * @brief Accepts and drops every character, so messages are still formatted but never written.
+     */
+    class DiscardBuffer : public std::streambuf
+    {
+    protected:
+        int overflow(int c) override { return c; }
+        std::streamsize xsputn(const char *, std::streamsize count) override { return count; }
+    };
+
+    /**
+     * @brief Runs fn once per account and returns the total time in nanoseconds.
+     */
+    template <typename Fn>
+    f64 TimeRound(const std::vector<Bank::BankAccount *> &accounts, Fn &&fn)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (Bank::BankAccount *account : accounts)
+            fn(*account);
+        return std::chrono::duration<f64, std::nano>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+int main()
+{
+    using namespace Bank;
+
+    std::vector<BankAccount *> accounts;
+    accounts.reserve(2 * CUSTOMERS);
+    std::unique_ptr<::Bank::Bank> bank;
+    {
+        QuietScope quiet;
+        bank = std::make_unique<::Bank::Bank>("Bench");
+        bank->Reserve(CUSTOMERS, 2 * CUSTOMERS);
+        for (size_t i = 0; i < CUSTOMERS; i++)
+        {
+            Customer &customer = bank->AddCustomer("Bench", "Customer", 30);
+            accounts.push_back(&customer.CreateBankAccount(AccountType::CHECKING, OPENING_BALANCE));
+            accounts.push_back(&customer.CreateBankAccount(AccountType::SAVING, OPENING_BALANCE));
+        }
+    }
+
+    // Logged and quiet withdrawals alternate round by round, so both see the index in the same state
+    DiscardBuffer discard;
+    size_t withdrawn = 0;
+    auto withdraw = [&withdrawn](BankAccount &account)
+    { withdrawn += account.Withdraw(WITHDRAWAL); };
+    f64 logged = 0.0, quiet_withdraw = 0.0;
+    for (size_t round = 0; round < ROUNDS; round++)
+    {
+        std::streambuf *cout_buffer = std::cout.rdbuf(&discard);
+        logged += TimeRound(accounts, withdraw);
+        std::cout.rdbuf(cout_buffer);
+
+        QuietScope quiet;
+        quiet_withdraw += TimeRound(accounts, withdraw);
+    }
+
+    size_t allowed = 0;
+    f64 policy = 0.0;
+    for (size_t round = 0; round < ROUNDS; round++)
+        policy += TimeRound(accounts, [&allowed](BankAccount &account)
+                            { allowed += VisitAccount(account, [](auto &kind)
+                                                      { return kind.GetBalance() - WITHDRAWAL >=
+                                                               std::remove_reference_t<decltype(kind)>::Policy::MIN_BALANCE; }); });
+
+    f64 total = 0.0, interest = 0.0;
+    for (size_t round = 0; round < ROUNDS; round++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        bank->ApplyInterestToAllAccounts();
+        interest += std::chrono::duration<f64, std::nano>(std::chrono::steady_clock::now() - start).count();
+        interest += TimeRound(accounts, [&total](BankAccount &account)
+                              { total += account.GetBalance(); });
+    }
+
+    const f64 calls = static_cast<f64>(ROUNDS * accounts.size());
+    logged /= calls;
+    quiet_withdraw /= calls;
+    policy /= calls;
+    interest /= calls;
+    std::printf("%zu accounts, %zu rounds (%zu withdrawals, %zu allowed, balances %.2f)\n", accounts.size(), ROUNDS,
+                withdrawn, allowed, total);
+    std::printf("  withdraw (logged)   %9.1f ns\n", logged);
+    std::printf("  withdraw (quiet)    %9.1f ns   iostream %.1f ns\n", quiet_withdraw, logged - quiet_withdraw);
+    std::printf("  policy check only   %9.1f ns   index and update %.1f ns\n", policy, quiet_withdraw - policy);
+    std::printf("  interest            %9.1f ns\n", interest);
+
+    QuietScope quiet;
+    bank.reset();
+    return 0;
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "account_type.hpp"
+#include "types.hpp"
+#include <array>
+#include <compare>
+#include <cstddef>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+namespace Bank
+{
+    /**
+     * @brief An account ID packed into 64 bits: the account number in the high bits and the account type in the low byte.
+     *
+     * The text form is the number followed by 'C' (checking) or 'S' (saving), e.g. "123456C". Packing
+     * keeps that order (all numbers have the same width and 'C' sorts before 'S'), so sorted containers
+     * list accounts exactly as before, while comparing, hashing and searching become integer operations.
+     * Parse and Format are constexpr, so IDs can be checked and built at compile time.
+     */
+    class AccountID
+    {
+    private:
+        static constexpr u32 TYPE_BITS = 8;
+        u64 m_value = 0; // 0 means "no account"
+
+        constexpr explicit AccountID(u64 value) : m_value(value) {}
+
+    public:
+        /**
+         * @brief The text form of an ID, held inline so formatting never allocates.
+         */
+        struct Text
+        {
+            std::array<char, 24> chars{};
+            size_t length = 0;
+
+            constexpr std::string_view View() const { return std::string_view(chars.data(), length); }
+        };
+
+        constexpr AccountID() = default;
+        constexpr AccountID(u32 number, AccountType type)
+            : m_value((static_cast<u64>(number) << TYPE_BITS) | static_cast<u64>(type))
+        {
+        }
+
+        /**
+         * @brief Parses the text form ("123456C" or "123456S").
+         * @return The ID, or an invalid ID if the text is not a well-formed account ID.
+         */
+        static constexpr AccountID Parse(std::string_view text)
+        {
+            if (text.size() < 2 || text.size() > 11)
+                return AccountID();
+
+            AccountType type;
+            if (text.back() == 'C')
+                type = AccountType::CHECKING;
+            else if (text.back() == 'S')
+                type = AccountType::SAVING;
+            else
+                return AccountID();
+
+            u64 number = 0;
+            for (size_t i = 0; i + 1 < text.size(); i++)
+            {
+                if (text[i] < '0' || text[i] > '9')
+                    return AccountID();
+                number = number * 10 + static_cast<u64>(text[i] - '0');
+            }
+            if (number == 0 || number > 0xFFFF'FFFFULL)
+                return AccountID();
+            return AccountID(static_cast<u32>(number), type);
+        }
+
+        /**
+         * @brief Formats the ID as text, e.g. "123456C". An invalid ID formats as an empty string.
+         */
+        constexpr Text Format() const
+        {
+            Text text;
+            if (!IsValid())
+                return text;
+
+            // Write the digits backwards, then reverse them in place
+            u64 number = GetNumber();
+            do
+            {
+                text.chars[text.length++] = static_cast<char>('0' + number % 10);
+                number /= 10;
+            } while (number > 0);
+            for (size_t i = 0, j = text.length - 1; i < j; i++, j--)
+            {
+                char c = text.chars[i];
+                text.chars[i] = text.chars[j];
+                text.chars[j] = c;
+            }
+            text.chars[text.length++] = GetType() == AccountType::SAVING ? 'S' : 'C';
+            return text;
+        }
+
+        inline std::string ToString() const { return std::string(Format().View()); }
+
+        constexpr bool IsValid() const { return m_value != 0; }
+        constexpr u32 GetNumber() const { return static_cast<u32>(m_value >> TYPE_BITS); }
+        constexpr AccountType GetType() const { return static_cast<AccountType>(m_value & ((1u << TYPE_BITS) - 1)); }
+        constexpr u64 GetValue() const { return m_value; }
+
+        constexpr auto operator<=>(const AccountID &) const = default;
+    };
+
+    static_assert(AccountID::Parse("123456C") == AccountID(123456, AccountType::CHECKING));
+    static_assert(AccountID::Parse("123456S").Format().View() == "123456S");
+    static_assert(AccountID::Parse("123456C") < AccountID::Parse("123456S"));
+    static_assert(!AccountID::Parse("12x456C").IsValid() && !AccountID::Parse("123456").IsValid());
+
+    inline std::ostream &operator<<(std::ostream &os, AccountID id)
+    {
+        return os << id.Format().View();
+    }
+}
+
+template <>
+struct std::hash<Bank::AccountID>
+{
+    size_t operator()(Bank::AccountID id) const noexcept { return std::hash<u64>()(id.GetValue()); }
+};
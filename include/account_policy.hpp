@@ -0,0 +1,38 @@
+#pragma once
+
+#include "account_type.hpp"
+#include "global.hpp"
+#include "types.hpp"
+
+namespace Bank
+{
+    /**
+     * @brief The rules of one kind of account, fixed at compile time.
+     *
+     * Each kind of account is an Account<Type>, which reads its rules from here. Code that knows the kind,
+     * or branches on it once, gets them as constants, so the checks they guard fold away instead of being
+     * looked up through a virtual call per operation.
+     *
+     * @tparam Type The kind of account.
+     */
+    template <AccountType Type>
+    struct AccountPolicy;
+
+    template <>
+    struct AccountPolicy<AccountType::CHECKING>
+    {
+        static constexpr const char *NAME = "Checking";
+        static constexpr f64 MIN_BALANCE = -OVERDRAFT_LIMIT; // A withdrawal may overdraw down to this
+        static constexpr bool CHARGES_OVERDRAFT_FEE = true;
+        static constexpr bool EARNS_INTEREST = false;
+    };
+
+    template <>
+    struct AccountPolicy<AccountType::SAVING>
+    {
+        static constexpr const char *NAME = "Saving";
+        static constexpr f64 MIN_BALANCE = 0.0;
+        static constexpr bool CHARGES_OVERDRAFT_FEE = false;
+        static constexpr bool EARNS_INTEREST = true;
+    };
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "types.hpp"
+#include <iostream>
+
+namespace Bank
+{
+    /**
+     * @brief Silences, on the calling thread and for as long as it lives, the messages that banks,
+     *        customers, accounts and transactions print as they are created, changed and destroyed.
+     *
+     * Bulk operations (loading, restoring, sealing, archiving, batch transfers) would otherwise print a line
+     * per object. Scopes nest, other threads keep printing, and the messages come back even if the
+     * operation throws.
+     */
+    class QuietScope
+    {
+    private:
+        static inline thread_local u32 t_depth = 0;
+
+    public:
+        QuietScope() { t_depth++; }
+        ~QuietScope() { t_depth--; }
+        QuietScope(const QuietScope &) = delete;
+        QuietScope &operator=(const QuietScope &) = delete;
+
+        static inline bool IsActive() { return t_depth > 0; }
+    };
+
+    /**
+     * @brief Returns the stream those messages go to: std::cout, or within a QuietScope a stream that discards them.
+     */
+    inline std::ostream &ActivityLog()
+    {
+        thread_local std::ostream discard(nullptr);
+        return QuietScope::IsActive() ? discard : std::cout;
+    }
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "bank.hpp"
+#include "types.hpp"
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace Bank
+{
+    /**
+     * @brief A single ledger invariant violation, located down to the account (and transaction, if any).
+     */
+    struct AuditDiscrepancy
+    {
+        i32 bank_id = 0;
+        i32 customer_id = 0;
+        AccountID account_id;    // Invalid for customer-level findings
+        i32 transaction_id = 0;  // 0 for account-level findings
+        std::string message;
+    };
+
+    /**
+     * @brief The outcome of a full ledger audit across every bank.
+     */
+    struct AuditReport
+    {
+        std::vector<AuditDiscrepancy> discrepancies;
+        size_t accounts_checked = 0;
+        size_t transactions_checked = 0;
+        f64 elapsed_seconds = 0.0;
+    };
+
+    size_t AuditCustomer(i32 bank_id, const Customer &customer, std::vector<AuditDiscrepancy> &out);
+    AuditReport AuditLedger(const std::vector<std::unique_ptr<Bank>> &banks);
+    void PrintAuditDiscrepancy(const AuditDiscrepancy &discrepancy, std::ostream &os);
+    void PrintAuditReport(const AuditReport &report, std::ostream &os);
+}
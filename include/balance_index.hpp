@@ -0,0 +1,68 @@
+#pragma once
+
+#include "order_statistic_tree.hpp"
+#include "types.hpp"
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Bank
+{
+    class Bank;
+    class BankAccount;
+    struct MemoryUsage;
+
+    /**
+     * @brief Keeps one bank's accounts ordered by balance, for top-K, range and rank queries in O(log n).
+     *
+     * Checking accounts are ordered by their balance. Saving accounts accrue interest lazily, so their
+     * stored balance lags behind until they are next touched; they are ordered instead by their balance
+     * discounted back to interest period 0, which a rollover changes for none of them, and which is
+     * brought back to the current period when comparing with checking accounts or with a bound. Every
+     * place that changes a balance calls Update, so the index never has to be rebuilt.
+     */
+    class BalanceIndex
+    {
+    private:
+        struct Key
+        {
+            f64 order;   // Balance, or for a saving account its discounted log-balance
+            u64 account; // The account ID's value, so that equal balances are still distinct keys
+
+            friend bool operator<(const Key &a, const Key &b)
+            {
+                return a.order < b.order || (a.order == b.order && a.account < b.account);
+            }
+        };
+
+        mutable std::mutex m_mutex;
+        const u64 &m_interest_period; // The owning Bank's
+        OrderStatisticTree<Key, BankAccount *> m_checking;
+        OrderStatisticTree<Key, BankAccount *> m_saving;
+
+        f64 SavingOrder(f64 balance, u64 period) const;
+        f64 SavingBalance(f64 order) const;
+        Key MakeKey(const BankAccount &account) const;
+        size_t CheckingAbove(f64 balance) const;
+        size_t SavingAbove(f64 balance, f64 order) const;
+
+    public:
+        explicit BalanceIndex(const u64 &interest_period) : m_interest_period(interest_period) {}
+        BalanceIndex(const BalanceIndex &) = delete;
+        BalanceIndex &operator=(const BalanceIndex &) = delete;
+
+        void Insert(BankAccount &account);
+        void Update(BankAccount &account);
+
+        size_t size() const;
+        size_t CountAbove(f64 balance) const;
+        size_t CountAbove(const BankAccount &account) const;
+        void Top(size_t count, std::vector<BankAccount *> &out) const;
+        void Range(f64 min_balance, f64 max_balance, std::vector<BankAccount *> &out) const;
+        void MeasureMemory(MemoryUsage &usage) const;
+    };
+
+    std::vector<BankAccount *> TopBalances(const std::vector<std::unique_ptr<Bank>> &banks, size_t count);
+    std::vector<BankAccount *> BalancesInRange(const std::vector<std::unique_ptr<Bank>> &banks, f64 min_balance, f64 max_balance);
+    size_t CountBalancesAbove(const std::vector<std::unique_ptr<Bank>> &banks, const BankAccount &account);
+}
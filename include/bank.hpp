@@ -1,35 +1,68 @@
 #pragma once
 
 #include "customer.hpp"
+#include "bank_account.hpp"
+#include "balance_index.hpp"
+#include "slot_map.hpp"
+#include "transaction_archive.hpp"
 #include "types.hpp"
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <memory>
+#include <unordered_map>
 #include <vector>
 
 namespace Bank
 {
     class Customer;
+    struct BankMemory;
+
     class Bank
     {
     private:
         i32 m_bank_id;
-        std::string m_bank_name;
-        std::vector<std::unique_ptr<Customer>> m_customers;
+        std::string_view m_bank_name; // Interned in the StringPool
+        // Customers and accounts live in slot maps, in creation order, and are looked up by ID through the indexes
+        SlotMap<Customer> m_customers;
+        SlotMap<BankAccount> m_accounts{ACCOUNT_SLOT_SIZE, ACCOUNT_SLOT_ALIGN};
+        std::unordered_map<i32, CustomerHandle> m_customer_index;
+        std::unordered_map<AccountID, AccountHandle> m_account_index;
+        u64 m_interest_period = 0; // Number of interest rollovers so far; SavingAccounts accrue up to it lazily
+        BalanceIndex m_balance_index{m_interest_period}; // Every account, ordered by balance
+        i32 m_saving_accounts = 0;
+        std::unique_ptr<TransactionArchive> m_archive; // Created the first time this bank archives
+        std::shared_ptr<const TransactionArchive> m_checkpoint; // The checkpoint this bank was restored from, if any
         void GenerateID();
 
+        friend class Customer;
+        BankAccount &OpenAccount(Customer &owner, AccountType account_type, f64 balance, AccountID account_id);
+
     public:
         Bank() = default;
         Bank(const std::string &bank_name);
+        Bank(const std::string &bank_name, i32 bank_id);
         ~Bank();
 
-        void AddCustomer(const std::string &fname, const std::string &lname, i32 age);
+        Customer &AddCustomer(const std::string &fname, const std::string &lname, i32 age, i32 customer_id = 0);
+        void Reserve(size_t customers, size_t accounts);
         void ViewAllCustomers() const;
-        inline std::string GetName() const { return m_bank_name; }
+        inline std::string_view GetName() const { return m_bank_name; }
         inline i32 GetID() const { return m_bank_id; }
         inline i32 GetNumberOfCustomers() const { return m_customers.size(); }
-        const inline std::vector<std::unique_ptr<Customer>> &GetCustomers() const { return m_customers; }
+        const inline SlotMap<Customer> &GetCustomers() const { return m_customers; }
+        const inline SlotMap<BankAccount> &GetAccounts() const { return m_accounts; }
+        Customer *FindCustomer(i32 customer_id) const;
+        BankAccount *FindAccount(AccountID account_id) const;
+        void MeasureMemory(BankMemory &memory) const;
+        size_t ArchiveTransactions(i64 cutoff);
+        inline const TransactionArchive *GetArchive() const { return m_archive.get(); }
+        void Restore(std::shared_ptr<const TransactionArchive> checkpoint, u64 interest_period);
 
         void ApplyInterestToAllAccounts();
+        inline const u64 &GetInterestPeriod() const { return m_interest_period; }
+        inline i32 GetNumberOfSavingAccounts() const { return m_saving_accounts; }
+        inline BalanceIndex &GetBalanceIndex() { return m_balance_index; }
+        inline const BalanceIndex &GetBalanceIndex() const { return m_balance_index; }
     };
 }
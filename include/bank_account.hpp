@@ -2,63 +2,181 @@
 
 #include "customer.hpp"
 #include "types.hpp"
+#include "account_policy.hpp"
 #include "account_type.hpp"
+#include "account_id.hpp"
 #include "transaction.hpp"
+#include "transaction_archive.hpp"
+#include "transaction_block.hpp"
+#include "velocity.hpp"
+#include "small_vector.hpp"
 #include <iostream>
 #include <string>
 #include <vector>
 #include <memory>
 #include <chrono>
+#include <algorithm>
 
 namespace Bank
 {
+    class Bank;
+    struct BankMemory;
+    struct AccountCheckpoint;
+
+    /**
+     * @brief The state and operations every kind of account shares.
+     *
+     * There are no virtual functions: each kind is an Account<Type> whose rules come from its AccountPolicy,
+     * and the operations that differ by kind branch once on the account type and then run code specialised
+     * for it (see VisitAccount).
+     */
     class BankAccount
     {
     public:
+        // Most accounts only ever see a few transactions, which then need no allocation beyond their own
+        using TransactionList = SmallVector<std::unique_ptr<Transaction>, 4>;
+
         BankAccount() = default;
-        BankAccount(AccountType account_type, Customer &customer, f64 balance);
-        virtual ~BankAccount();
+        BankAccount(AccountType account_type, Customer &customer, f64 balance, AccountID account_id = AccountID());
+        ~BankAccount();
 
-        virtual bool Withdraw(f64 amount) = 0;
-        virtual void ApplyInterest() {}
-        virtual void ApplyOverdraftFee() {}
+        bool Withdraw(f64 amount);
 
         void Deposit(f64 amount);
-        void Transfer(const std::string &account_index, f64 amount);
-        void CreateTransaction(TransactionType transaction_type, f64 amount, const std::string &destination_account_id = "");
-        void ViewAccountTransactions() const;
-        inline std::string GetID() const { return m_account_id; }
-        inline f64 GetBalance() const { return m_balance; }
-        const inline Customer &GetAccountOwner() const { return m_associated_customer; }
+        bool Transfer(AccountID destination_account_id, f64 amount);
+        const Transaction &CreateTransaction(TransactionType transaction_type, f64 amount, AccountID destination_account_id = AccountID(),
+                                             i32 transaction_id = 0);
+        const Transaction *SubmitTransaction(const std::string &idempotency_key, TransactionType transaction_type, f64 amount,
+                                             AccountID destination_account_id = AccountID());
+        void ViewAccountTransactions();
+        inline AccountID GetID() const { return m_account_id; }
+        inline f64 GetBalance() const
+        {
+            SettleInterest();
+            return m_balance;
+        }
+        const Customer &GetAccountOwner() const;
+        Customer &GetAccountOwner();
+        inline Bank &GetBank() const { return m_bank; }
+        inline AccountHandle GetHandle() const { return m_handle; }
         inline AccountType GetAccountType() const { return m_account_type; }
-        inline i32 GetNumberOfTransactions() const { return m_transactions.size(); }
-        const inline std::vector<std::unique_ptr<Transaction>> &GetTransactions() const { return m_transactions; }
+        i32 GetNumberOfTransactions() const;
+        // Only those not yet sealed; loads a history restored from a checkpoint first
+        const inline TransactionList &GetTransactions()
+        {
+            LoadHistory();
+            return m_transactions;
+        }
+        void GetResidentHistory(std::vector<TransactionImage> &out) const;
+        std::vector<TransactionImage> GetHistoryByID() const;
+        bool FindTransaction(i32 transaction_id, TransactionImage &out) const;
+        size_t ArchiveTransactions(i64 cutoff, TransactionArchive &archive);
+        void Restore(const AccountCheckpoint &checkpoint, const TransactionArchive &checkpoint_file);
+        void LoadHistory();
+        inline bool IsHistoryLoaded() const { return !m_history_unloaded; }
+        inline u64 GetNextSequence() const { return m_next_sequence; }
+        inline const std::shared_ptr<const ArchivedHistory> &GetArchivedHistory() const { return m_archived; }
+        inline f64 GetOpeningBalance() const { return m_opening_balance; }
+        inline f64 GetInterestPosted() const
+        {
+            SettleInterest();
+            return m_interest_posted;
+        }
+        inline f64 GetTransfersReceived() const { return m_transfers_received; }
+        inline f64 GetFeesAssessed() const { return m_fees_assessed; }
+        void SetVelocityLimits(const VelocityLimits &limits);
+        inline VelocityTracker *GetVelocityTracker() { return m_velocity.get(); }
+        inline const VelocityTracker *GetVelocityTracker() const { return m_velocity.get(); }
+        size_t MeasureMemory(BankMemory &memory) const;
 
     private:
+        friend class Transaction;
+        friend class Bank;
+        friend class BalanceIndex;
+
         AccountType m_account_type;
-        std::vector<std::unique_ptr<Transaction>> m_transactions;
+        TransactionList m_transactions;                    // Sorted by transaction ID; older ones may be sealed or archived
+        std::vector<TransactionBlock> m_sealed;            // Older transactions, compressed, oldest block first
+        std::shared_ptr<const ArchivedHistory> m_archived; // Null until this account first archives
+        bool m_history_unloaded = false; // m_archived is the history in a checkpoint, not yet read into memory
+        u64 m_next_sequence = 0;
+        std::unique_ptr<VelocityTracker> m_velocity; // Only allocated once limits are set
+        f64 m_balance_order = 0.0;                   // This account's key in its Bank's BalanceIndex
         void GenerateAccountID();
+        void SealOldestTransactions();
 
     protected:
-        std::string m_account_id;
-        f64 m_balance;
-        Customer &m_associated_customer;
-    };
+        AccountID m_account_id;
 
-    class CheckingAccount : public BankAccount
-    {
-    public:
-        CheckingAccount(AccountType account_type, Customer &customer, f64 balance);
-        bool Withdraw(f64 amount) override;
-        void ApplyOverdraftFee() override;
+        // Interest is accrued lazily on the next access, so even const reads may bring these up to date
+        mutable f64 m_balance;
+        f64 m_opening_balance;
+        mutable f64 m_interest_posted = 0.0; // Credits from interest, which happen outside any Transaction
+        f64 m_transfers_received = 0.0;      // Credits from other accounts' transfers, recorded only on the source account
+        f64 m_fees_assessed = 0.0;           // End-of-day overdraft fees, which happen outside any Transaction
+        mutable u64 m_interest_period = 0;   // Last interest period applied to m_balance
+        const u64 *m_interest_clock = nullptr; // The owning Bank's current interest period; null if the account earns none
+        Bank &m_bank;
+        CustomerHandle m_owner;
+        AccountHandle m_handle; // Assigned by the Bank once this account has a slot
+
+        /**
+         * @brief Applies any interest periods that have elapsed since this account was last touched.
+         */
+        inline void SettleInterest() const
+        {
+            if (m_interest_clock && m_interest_period != *m_interest_clock)
+                AccrueInterest();
+        }
+        void AccrueInterest() const;
+        void CompoundInterest() const;
+        void Reindex();
     };
 
-    class SavingAccount : public BankAccount
+    /**
+     * @brief One kind of account, with the rules of its AccountPolicy.
+     *
+     * Its members are defined in bank_account.cpp for the two kinds only.
+     *
+     * @tparam Type The kind of account.
+     */
+    template <AccountType Type>
+    class Account final : public BankAccount
     {
     public:
-        SavingAccount(AccountType account_type, Customer &customer, f64 balance);
-        bool Withdraw(f64 amount) override;
-        void ApplyInterest() override;
+        using Policy = AccountPolicy<Type>;
+
+        Account(Customer &customer, f64 balance, AccountID account_id = AccountID());
+        bool Withdraw(f64 amount);
+        bool AssessOverdraftFee()
+            requires Policy::CHARGES_OVERDRAFT_FEE;
+
+    private:
+        void ApplyOverdraftFee()
+            requires Policy::CHARGES_OVERDRAFT_FEE;
     };
 
+    extern template class Account<AccountType::CHECKING>;
+    extern template class Account<AccountType::SAVING>;
+    using CheckingAccount = Account<AccountType::CHECKING>;
+    using SavingAccount = Account<AccountType::SAVING>;
+
+    // Every kind of account fits in one slot, so a Bank can keep all of its accounts in a single SlotMap
+    inline constexpr size_t ACCOUNT_SLOT_SIZE = std::max(sizeof(CheckingAccount), sizeof(SavingAccount));
+    inline constexpr size_t ACCOUNT_SLOT_ALIGN = std::max(alignof(CheckingAccount), alignof(SavingAccount));
+
+    /**
+     * @brief Calls fn with the account as its own kind, so that fn is compiled once per kind with that
+     *        kind's rules known. Loops over many accounts pay one branch per account, not a virtual call per operation.
+     * @param account The account.
+     * @param fn Called with a CheckingAccount& or a SavingAccount&.
+     * @return Whatever fn returns.
+     */
+    template <typename Fn>
+    inline decltype(auto) VisitAccount(BankAccount &account, Fn &&fn)
+    {
+        if (account.GetAccountType() == AccountType::SAVING)
+            return fn(static_cast<SavingAccount &>(account));
+        return fn(static_cast<CheckingAccount &>(account));
+    }
 }
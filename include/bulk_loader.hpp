@@ -0,0 +1,50 @@
+#pragma once
+
+#include "bank.hpp"
+#include "account_type.hpp"
+#include "types.hpp"
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Bank
+{
+    /**
+     * @brief An account to open for a bulk-loaded customer.
+     */
+    struct AccountRecord
+    {
+        AccountType account_type = AccountType::CHECKING;
+        f64 balance = 0.0;
+    };
+
+    /**
+     * @brief One customer to add in a bulk load, with the accounts to open for them.
+     */
+    struct CustomerRecord
+    {
+        i32 customer_id = 0; // 0 to generate a random one
+        std::string_view first_name;
+        std::string_view last_name;
+        i32 age = 0;
+        std::vector<AccountRecord> accounts;
+    };
+
+    /**
+     * @brief The outcome of a bulk load.
+     */
+    struct BulkLoadReport
+    {
+        size_t rows = 0;      // Customer rows read (comments and blank lines excluded)
+        size_t customers = 0; // Customers added
+        size_t accounts = 0;  // Accounts opened
+        size_t rejected = 0;  // Rows that were malformed, out of range or clashed with an existing customer ID
+        f64 parse_seconds = 0.0;
+        f64 load_seconds = 0.0;
+    };
+
+    void LoadCustomers(Bank &bank, const std::vector<CustomerRecord> &records, BulkLoadReport &report);
+    BulkLoadReport ImportCustomers(Bank &bank, const std::string &path);
+    void PrintBulkLoadReport(const BulkLoadReport &report, std::ostream &os);
+}
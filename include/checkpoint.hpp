@@ -0,0 +1,88 @@
+#pragma once
+
+#include "account_type.hpp"
+#include "account_id.hpp"
+#include "transaction_archive.hpp"
+#include "velocity.hpp"
+#include "types.hpp"
+#include <memory>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace Bank
+{
+    class Bank;
+
+    /**
+     * @brief How one account is stored in a checkpoint: everything needed to reopen it, plus where its
+     *        history is in the file and a summary of that history for the ledger audit.
+     */
+    struct AccountCheckpoint
+    {
+        AccountID account_id;
+        AccountType account_type;
+        f64 balance;
+        f64 opening_balance;
+        f64 interest_posted;
+        f64 transfers_received;
+        f64 fees_assessed;
+        u64 next_sequence;
+        VelocityLimits limits;
+        ArchiveExtent history; // Every transaction of the account, oldest first
+        f64 balance_after;     // As in ArchivedHistory, over the whole history
+        f64 net_change;
+        f64 transferred_out;
+        f64 balance_drops;
+    };
+
+    // Checkpoint records are written byte for byte, like archived transactions
+    static_assert(std::is_trivially_copyable_v<AccountCheckpoint>, "AccountCheckpoint must be trivially copyable to be checkpointed");
+
+    /**
+     * @brief The outcome of saving or restoring a checkpoint.
+     */
+    struct CheckpointReport
+    {
+        size_t banks = 0;
+        size_t customers = 0;
+        size_t accounts = 0;
+        size_t transactions = 0; // Saved, or left on disk until first read when restoring
+        u64 bytes = 0;
+        f64 seconds = 0.0;       // Spent writing or reading
+        f64 pause_seconds = 0.0; // How long the menu was held up by a background save
+    };
+
+    /**
+     * @brief Saves checkpoints in the background, without holding up the menu while the file is written.
+     *
+     * On Linux and macOS the writer forks. The child gets a copy-on-write image of every bank as of the
+     * fork, which no later change in the parent can tear, and saves it while the parent carries on; the
+     * parent is paused only for the fork itself. The child sends its report back through a pipe. On
+     * Windows the checkpoint is saved in place, pausing for the whole save.
+     */
+    class CheckpointWriter
+    {
+    private:
+        i64 m_child = -1;  // Process ID of the running writer, or -1
+        i32 m_result = -1; // Read end of the pipe the writer reports through
+        std::string m_path;
+        f64 m_pause_seconds = 0.0;
+        bool m_finished = false; // Saved, but its report not yet collected
+        bool m_succeeded = false;
+        CheckpointReport m_report;
+
+    public:
+        static CheckpointWriter &Shared();
+
+        bool Start(const std::vector<std::unique_ptr<Bank>> &banks, const std::string &path);
+        bool Collect(bool wait, bool &succeeded, CheckpointReport &report);
+        inline bool IsRunning() const { return m_child >= 0 || m_finished; }
+        inline const std::string &GetPath() const { return m_path; }
+    };
+
+    bool SaveCheckpoint(const std::vector<std::unique_ptr<Bank>> &banks, const std::string &path, CheckpointReport &report);
+    bool RestoreCheckpoint(const std::string &path, std::vector<std::unique_ptr<Bank>> &banks, CheckpointReport &report);
+    void PrintCheckpointReport(const CheckpointReport &report, std::ostream &os);
+}
@@ -2,35 +2,60 @@
 
 #include "types.hpp"
 #include "account_type.hpp"
+#include "account_id.hpp"
 #include "transaction.hpp"
+#include "velocity.hpp"
+#include "slot_map.hpp"
+#include "small_vector.hpp"
 #include <string>
+#include <string_view>
 #include <vector>
 #include <memory>
 
 namespace Bank
 {
+    class Bank;
+    class Customer;
+    struct BankMemory;
+    using CustomerHandle = SlotHandle<Customer>;
+
     class Customer
     {
     private:
+        friend class Bank;
+
+        Bank &m_bank;
+        CustomerHandle m_handle; // Assigned by the Bank once this Customer has a slot
         i32 m_customer_id;
-        std::string m_fName;
-        std::string m_lName;
+        // Names are interned in the StringPool, so reading them never allocates
+        std::string_view m_fName;
+        std::string_view m_lName;
+        std::string_view m_name; // "First Last"
         i32 m_age;
-        std::vector<std::unique_ptr<BankAccount>> m_accounts;
+        SmallVector<AccountHandle, 2> m_accounts; // In creation order; the accounts themselves live in the Bank
+        std::unique_ptr<VelocityTracker> m_velocity; // Limits across all of this customer's accounts; only allocated once set
         void GenerateCustomerID();
 
     public:
         Customer() = default;
-        Customer(const std::string &fName, const std::string &lName, i32 age);
+        Customer(Bank &bank, const std::string &fName, const std::string &lName, i32 age, i32 customer_id = 0);
         ~Customer();
 
         void DisplayCustomerInfo() const;
-        void CreateBankAccount(AccountType account_type, f64 account_initial_balance);
+        BankAccount &CreateBankAccount(AccountType account_type, f64 account_initial_balance, AccountID account_id = AccountID());
         void ViewCustomerAccounts() const;
         inline i32 GetID() const { return m_customer_id; }
-        inline std::string GetName() const { return m_fName + " " + m_lName; }
+        inline Bank &GetBank() const { return m_bank; }
+        inline CustomerHandle GetHandle() const { return m_handle; }
+        inline std::string_view GetName() const { return m_name; }
+        inline std::string_view GetFirstName() const { return m_fName; }
+        inline std::string_view GetLastName() const { return m_lName; }
         inline i32 GetAge() const { return m_age; }
         inline i32 GetNumberOfAccounts() const { return m_accounts.size(); }
-        const inline std::vector<std::unique_ptr<BankAccount>> &GetAccounts() const { return m_accounts; }
+        SlotRange<BankAccount> GetAccounts() const;
+        void SetVelocityLimits(const VelocityLimits &limits);
+        inline VelocityTracker *GetVelocityTracker() { return m_velocity.get(); }
+        inline const VelocityTracker *GetVelocityTracker() const { return m_velocity.get(); }
+        size_t MeasureMemory(BankMemory &memory) const;
     };
 }
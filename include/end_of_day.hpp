@@ -0,0 +1,70 @@
+#pragma once
+
+#include "audit.hpp"
+#include "bank.hpp"
+#include "types.hpp"
+#include <array>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace Bank
+{
+    enum class EndOfDayStage
+    {
+        INTEREST,
+        OVERDRAFT_FEES,
+        RECONCILIATION,
+        EXPORT
+    };
+
+    constexpr size_t END_OF_DAY_STAGES = 4;
+
+    /**
+     * @brief The end-of-day batch: interest, overdraft fee assessment, reconciliation and export,
+     *        streamed over every customer in a single pipelined traversal.
+     *
+     * Customers are split into small batches. Each stage runs on its own thread and processes a batch
+     * as soon as the previous stage has released it, so a batch is still hot in cache when the next
+     * stage touches it and all four stages make progress at the same time. Per-stage progress is kept
+     * between runs, so a run interrupted with Ctrl+C resumes from the last batch each stage completed.
+     */
+    class EndOfDay
+    {
+    private:
+        struct WorkItem
+        {
+            Bank *bank;         // Null for padding, which starts work added on resume on a fresh batch
+            Customer *customer; // Null for the item that writes the Bank's header line
+        };
+
+        std::vector<WorkItem> m_work;
+        size_t m_batch_count = 0;
+        bool m_in_progress = false;
+        i64 m_business_date = 0;
+        std::string m_export_path;
+        u64 m_export_offset = 0;
+
+        std::array<size_t, END_OF_DAY_STAGES> m_completed_batches{};
+        std::array<size_t, END_OF_DAY_STAGES> m_items{};
+        std::array<f64, END_OF_DAY_STAGES> m_busy_seconds{};
+        f64 m_elapsed_seconds = 0.0;
+        size_t m_fees_charged = 0;
+        std::vector<AuditDiscrepancy> m_discrepancies;
+
+        void Begin(const std::vector<std::unique_ptr<Bank>> &banks);
+        size_t ExtendWork(const std::vector<std::unique_ptr<Bank>> &banks);
+        size_t ProcessBatch(EndOfDayStage stage, size_t batch, std::ostream &export_stream);
+        void SaveProgress() const;
+
+    public:
+        static EndOfDay &Shared();
+
+        bool Run(const std::vector<std::unique_ptr<Bank>> &banks);
+        inline bool IsInProgress() const { return m_in_progress; }
+        void PrintReport(std::ostream &os) const;
+    };
+
+    std::string EndOfDayStageToString(EndOfDayStage stage);
+}
@@ -1,5 +1,6 @@
 #pragma once
 #include "types.hpp"
+#include <cstddef>
 
 constexpr i32 MIN_BANK_ID = 1'000;
 constexpr i32 MAX_BANK_ID = 9'999;
@@ -21,7 +22,7 @@ constexpr i32 MIN_AGE = 16;
 constexpr i32 MAX_AGE = 120;
 
 constexpr i32 MIN_MENU_CHOICE = 1;
-constexpr i32 MAX_MENU_CHOICE = 15;
+constexpr i32 MAX_MENU_CHOICE = 30;
 
 constexpr i32 MIN_ACCOUNT_TYPE = 0;
 constexpr i32 MAX_ACCOUNT_TYPE = 1;
@@ -36,3 +37,61 @@ constexpr f64 INTEREST_RATE = 0.05;
 
 constexpr f64 OVERDRAFT_FEE = 35.00;
 constexpr f64 OVERDRAFT_LIMIT = 100.00;
+
+constexpr f64 AUDIT_TOLERANCE = 0.005;
+
+constexpr i64 SECONDS_PER_DAY = 86'400;
+constexpr i64 SCHEDULER_TICK_SECONDS = 3'600;
+
+constexpr i32 MIN_FREQUENCY = 0;
+constexpr i32 MAX_FREQUENCY = 2;
+
+constexpr i32 MIN_SCHEDULE_DELAY_DAYS = 0;
+constexpr i32 MAX_SCHEDULE_DELAY_DAYS = 365;
+
+constexpr u64 MIN_STANDING_ORDER_ID = 1;
+constexpr u64 MAX_STANDING_ORDER_ID = 999'999'999;
+
+constexpr i32 MIN_ADVANCE_DAYS = 1;
+constexpr i32 MAX_ADVANCE_DAYS = 3'650;
+
+constexpr size_t END_OF_DAY_BATCH_SIZE = 256;  // Customers per pipeline batch
+constexpr size_t END_OF_DAY_PIPELINE_DEPTH = 8; // Batches the first stage may run ahead of the export
+
+constexpr size_t SNAPSHOT_CHUNK_SIZE = 64; // Transactions per sealed history block in a snapshot
+constexpr size_t TRANSACTION_BLOCK_SIZE = 32; // Transactions an account seals at a time once twice as many are live
+
+constexpr i32 MIN_SHARDS = 1;
+constexpr i32 MAX_SHARDS = 64;
+
+constexpr size_t IDEMPOTENCY_CAPACITY = 65'536;        // Most request keys remembered at once
+constexpr size_t IDEMPOTENCY_BLOOM_BITS = 1'048'576;   // Bloom filter size (128 KiB)
+constexpr size_t IDEMPOTENCY_BLOOM_HASHES = 4;
+constexpr i64 IDEMPOTENCY_TTL_SECONDS = SECONDS_PER_DAY; // How long a key is remembered (simulated time)
+
+constexpr i32 MIN_LIMIT_SCOPE = 0; // 0: customer, 1: account
+constexpr i32 MAX_LIMIT_SCOPE = 1;
+constexpr i32 MAX_WITHDRAWALS_PER_HOUR = 1'000;
+
+constexpr size_t MAX_BULK_ACCOUNTS_PER_CUSTOMER = 8; // Keeps a full bank of customers within the account ID range
+
+constexpr size_t PIPELINE_THREADS = 4;          // Threads shared by every in-flight feed request
+constexpr size_t PIPELINE_MAX_IN_FLIGHT = 256;  // Feed requests admitted before the reader waits
+
+constexpr size_t MAX_TRANSFER_BATCH_LEGS = 100'000; // Legs a single transfer batch may have
+
+constexpr i32 MIN_ARCHIVE_AGE_DAYS = 0;
+constexpr i32 MAX_ARCHIVE_AGE_DAYS = 3'650;
+
+constexpr size_t QUERY_ACCOUNTS_PER_TASK = 16; // Accounts a query scans per thread-pool task
+constexpr size_t QUERY_PAGE_SIZE = 20;         // Rows shown per page of query results
+constexpr i32 MAX_QUERY_VALIDITY = 2;          // 0: any, 1: valid only, 2: declined only
+constexpr i32 MAX_QUERY_GROUP = 4;             // 0: none, 1: bank, 2: customer, 3: account type, 4: transaction type
+
+constexpr size_t MAX_RANKING_RESULTS = 100; // Accounts a balance ranking lists
+constexpr i32 MAX_RANKING_MODE = 2;         // 0: largest balances, 1: balance range, 2: one account's rank
+
+constexpr size_t MEMORY_REPORT_LARGEST = 5; // Customers and accounts a memory report lists per bank
+
+constexpr size_t TRACE_BUFFER_EVENTS = 4'096;  // Spans a thread buffers before handing them to the trace writer
+constexpr i64 TRACE_FLUSH_INTERVAL_MS = 250;   // How often the trace writer collects partly filled buffers
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "types.hpp"
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace Bank
+{
+    /**
+     * @brief Remembers recently used request keys so a retried submission is rejected instead of applied twice.
+     *
+     * Keys are reduced to 64-bit fingerprints. A Bloom filter answers "never seen" without touching the
+     * set, which is the common case for a fresh key; only possible repeats are checked against a hash set
+     * holding at most IDEMPOTENCY_CAPACITY fingerprints. Fingerprints expire IDEMPOTENCY_TTL_SECONDS of
+     * simulated time after they were recorded, and the oldest are evicted first when the set is full, so
+     * memory stays bounded. The Bloom filter is rebuilt from the set after enough insertions that expired
+     * keys would otherwise keep raising its false-positive rate.
+     */
+    class IdempotencyFilter
+    {
+    private:
+        std::mutex m_mutex;
+        std::vector<u64> m_bloom;                    // IDEMPOTENCY_BLOOM_BITS bits
+        std::unordered_set<u64> m_keys;              // Fingerprints that are still remembered
+        std::deque<std::pair<u64, i64>> m_expiry;    // (fingerprint, expiry time), oldest first
+        size_t m_bloom_insertions = 0;
+
+        u64 m_bloom_negatives = 0; // Lookups answered by the Bloom filter alone
+        u64 m_duplicates = 0;
+
+        static u64 Fingerprint(const std::string &key);
+        bool BloomMayContain(u64 fingerprint) const;
+        void BloomInsert(u64 fingerprint);
+        void Expire(i64 now);
+
+    public:
+        IdempotencyFilter();
+
+        static IdempotencyFilter &Shared();
+
+        bool CheckAndRecord(const std::string &key);
+
+        size_t GetRememberedKeys();
+        u64 GetBloomNegatives();
+        u64 GetDuplicatesRejected();
+    };
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "types.hpp"
+#include "account_id.hpp"
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <ostream>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace Bank
+{
+    class Bank;
+
+    /**
+     * @brief The kinds of entity that memory is attributed to.
+     */
+    enum class MemoryCategory
+    {
+        CUSTOMERS,    // Customer slots, their account handle lists and velocity trackers
+        ACCOUNTS,     // Account slots and their velocity trackers
+        TRANSACTIONS, // Transaction objects and each account's list of them
+        INDEXES,      // Customer and account ID indexes
+        COUNT
+    };
+
+    /**
+     * @brief Bytes held for one category: in use, plus reserved capacity that nothing occupies yet.
+     */
+    struct MemoryUsage
+    {
+        size_t objects = 0;
+        size_t bytes = 0;        // Everything held, including the wasted part
+        size_t wasted_bytes = 0; // Reserved but unused capacity (free slots, spare vector capacity, empty buckets)
+
+        inline void Add(size_t object_count, size_t used, size_t reserved)
+        {
+            objects += object_count;
+            bytes += reserved;
+            wasted_bytes += reserved - used;
+        }
+
+        inline MemoryUsage &operator+=(const MemoryUsage &other)
+        {
+            objects += other.objects;
+            bytes += other.bytes;
+            wasted_bytes += other.wasted_bytes;
+            return *this;
+        }
+    };
+
+    /**
+     * @brief The bytes one customer holds, counting its own slot and allocations and all of its accounts.
+     */
+    struct CustomerMemory
+    {
+        i32 customer_id = 0;
+        size_t bytes = 0;
+    };
+
+    /**
+     * @brief The bytes one account holds: its slot, its transactions and any velocity tracker.
+     */
+    struct AccountMemory
+    {
+        AccountID account_id;
+        size_t bytes = 0;
+    };
+
+    /**
+     * @brief The memory one Bank holds, broken down by category, and the customers and accounts that hold the most.
+     */
+    struct BankMemory
+    {
+        i32 bank_id = 0;
+        std::string_view bank_name;
+        std::array<MemoryUsage, static_cast<size_t>(MemoryCategory::COUNT)> categories{};
+        size_t customer_bytes = 0; // Summed over every customer, accounts included, for the average
+        size_t account_bytes = 0;  // Summed over every account, for the average
+        std::vector<CustomerMemory> largest_customers; // At most MEMORY_REPORT_LARGEST, largest first once measured
+        std::vector<AccountMemory> largest_accounts;   // Likewise
+
+        inline MemoryUsage &operator[](MemoryCategory category) { return categories[static_cast<size_t>(category)]; }
+        inline const MemoryUsage &operator[](MemoryCategory category) const { return categories[static_cast<size_t>(category)]; }
+        MemoryUsage Total() const;
+        void AddCustomer(i32 customer_id, size_t bytes);
+        void AddAccount(AccountID account_id, size_t bytes);
+    };
+
+    /**
+     * @brief Memory held by every bank, and by the structures they share.
+     */
+    struct MemoryReport
+    {
+        std::vector<BankMemory> banks;
+        MemoryUsage interned_names; // The shared StringPool
+        f64 elapsed_seconds = 0.0;
+    };
+
+    /**
+     * @brief Estimates the bytes held by an unordered_map: its bucket array and one node per element.
+     *
+     * Node size assumes the usual layout of a next pointer followed by the element. Empty buckets count as waste.
+     */
+    template <typename K, typename V, typename H>
+    void MeasureIndex(const std::unordered_map<K, V, H> &index, MemoryUsage &usage)
+    {
+        constexpr size_t node_bytes = sizeof(void *) + sizeof(typename std::unordered_map<K, V, H>::value_type);
+        const size_t buckets = index.bucket_count() * sizeof(void *);
+        const size_t used_buckets = std::min(index.size(), index.bucket_count()) * sizeof(void *);
+        usage.Add(index.size(), index.size() * node_bytes + used_buckets, index.size() * node_bytes + buckets);
+    }
+
+    MemoryReport MeasureMemory(const std::vector<std::unique_ptr<Bank>> &banks);
+    void PrintMemoryReport(const MemoryReport &report, std::ostream &os);
+}
@@ -0,0 +1,199 @@
+#pragma once
+
+#include "types.hpp"
+#include <cassert>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace Bank
+{
+    /**
+     * @brief An ordered set of unique keys, each carrying a value, that also answers "how many keys are
+     *        below this one" and "which key is the k-th smallest" in logarithmic time.
+     *
+     * It is a treap (a binary search tree kept balanced in expectation by random heap priorities) whose
+     * nodes also count the size of their subtree. Nodes live in one vector and refer to each other by
+     * index, and erased nodes are reused, so a tree that churns in place allocates nothing.
+     *
+     * @tparam Key The key type; keys must be unique and ordered by operator<.
+     * @tparam Value The value stored with each key.
+     */
+    template <typename Key, typename Value>
+    class OrderStatisticTree
+    {
+    private:
+        static constexpr u32 NIL = 0; // Node 0 is a sentinel with size 0
+
+        struct Node
+        {
+            Key key{};
+            Value value{};
+            u32 priority = 0;
+            u32 left = NIL;
+            u32 right = NIL;
+            u32 size = 0;
+        };
+
+        std::vector<Node> m_nodes = std::vector<Node>(1);
+        std::vector<u32> m_free;
+        u32 m_root = NIL;
+        u32 m_random = 0x9E3779B9u;
+
+        inline u32 NextPriority()
+        {
+            // xorshift32: cheap, and only needs to look random to the shape of the tree
+            m_random ^= m_random << 13;
+            m_random ^= m_random >> 17;
+            m_random ^= m_random << 5;
+            return m_random;
+        }
+
+        inline void Update(u32 node) { m_nodes[node].size = 1 + m_nodes[m_nodes[node].left].size + m_nodes[m_nodes[node].right].size; }
+
+        /**
+         * @brief Splits a subtree into the keys below key and the rest.
+         */
+        std::pair<u32, u32> Split(u32 node, const Key &key)
+        {
+            if (node == NIL)
+                return {NIL, NIL};
+            if (m_nodes[node].key < key)
+            {
+                auto [below, rest] = Split(m_nodes[node].right, key);
+                m_nodes[node].right = below;
+                Update(node);
+                return {node, rest};
+            }
+            auto [below, rest] = Split(m_nodes[node].left, key);
+            m_nodes[node].left = rest;
+            Update(node);
+            return {below, node};
+        }
+
+        /**
+         * @brief Joins two subtrees, every key of the first being below every key of the second.
+         */
+        u32 Merge(u32 first, u32 second)
+        {
+            if (first == NIL || second == NIL)
+                return first == NIL ? second : first;
+            if (m_nodes[first].priority > m_nodes[second].priority)
+            {
+                m_nodes[first].right = Merge(m_nodes[first].right, second);
+                Update(first);
+                return first;
+            }
+            m_nodes[second].left = Merge(first, m_nodes[second].left);
+            Update(second);
+            return second;
+        }
+
+        u32 Erase(u32 node, const Key &key, bool &erased)
+        {
+            if (node == NIL)
+                return NIL;
+            if (key < m_nodes[node].key)
+                m_nodes[node].left = Erase(m_nodes[node].left, key, erased);
+            else if (m_nodes[node].key < key)
+                m_nodes[node].right = Erase(m_nodes[node].right, key, erased);
+            else
+            {
+                erased = true;
+                const u32 replacement = Merge(m_nodes[node].left, m_nodes[node].right);
+                m_nodes[node] = Node{};
+                m_free.push_back(node);
+                return replacement;
+            }
+            Update(node);
+            return node;
+        }
+
+    public:
+        inline size_t size() const { return m_nodes[m_root].size; }
+        inline bool empty() const { return m_root == NIL; }
+
+        /**
+         * @brief Adds a key, which must not already be present.
+         */
+        void Insert(const Key &key, const Value &value)
+        {
+            u32 node;
+            if (m_free.empty())
+            {
+                node = static_cast<u32>(m_nodes.size());
+                m_nodes.emplace_back();
+            }
+            else
+            {
+                node = m_free.back();
+                m_free.pop_back();
+            }
+            m_nodes[node] = Node{key, value, NextPriority(), NIL, NIL, 1};
+
+            auto [below, rest] = Split(m_root, key);
+            m_root = Merge(Merge(below, node), rest);
+        }
+
+        /**
+         * @brief Removes a key.
+         * @return False if the key was not present.
+         */
+        bool Erase(const Key &key)
+        {
+            bool erased = false;
+            m_root = Erase(m_root, key, erased);
+            return erased;
+        }
+
+        /**
+         * @brief Returns how many keys are below the given one (which need not be present).
+         */
+        size_t Rank(const Key &key) const
+        {
+            size_t rank = 0;
+            for (u32 node = m_root; node != NIL;)
+            {
+                if (m_nodes[node].key < key)
+                {
+                    rank += m_nodes[m_nodes[node].left].size + 1;
+                    node = m_nodes[node].right;
+                }
+                else
+                {
+                    node = m_nodes[node].left;
+                }
+            }
+            return rank;
+        }
+
+        /**
+         * @brief Returns the key and value at a rank, 0 being the smallest key.
+         */
+        std::pair<const Key &, const Value &> Select(size_t rank) const
+        {
+            assert(rank < size());
+            u32 node = m_root;
+            while (true)
+            {
+                const size_t left = m_nodes[m_nodes[node].left].size;
+                if (rank < left)
+                {
+                    node = m_nodes[node].left;
+                }
+                else if (rank == left)
+                {
+                    return {m_nodes[node].key, m_nodes[node].value};
+                }
+                else
+                {
+                    rank -= left + 1;
+                    node = m_nodes[node].right;
+                }
+            }
+        }
+
+        inline size_t GetUsedBytes() const { return (size() + 1) * sizeof(Node); }
+        inline size_t GetReservedBytes() const { return m_nodes.capacity() * sizeof(Node) + m_free.capacity() * sizeof(u32); }
+    };
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include "snapshot.hpp"
+#include "account_type.hpp"
+#include "account_id.hpp"
+#include "transaction.hpp"
+#include "transaction_type.hpp"
+#include "types.hpp"
+#include <limits>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Bank
+{
+    enum class QueryValidity
+    {
+        ANY,
+        VALID_ONLY,  // Transactions that went through
+        INVALID_ONLY // Transactions that were declined
+    };
+
+    enum class QueryGroup
+    {
+        NONE,
+        BANK,
+        CUSTOMER,
+        ACCOUNT_TYPE,
+        TRANSACTION_TYPE
+    };
+
+    /**
+     * @brief A filter over every transaction in a snapshot, and how to group the matches for totals.
+     *
+     * Each condition narrows the match; the defaults match everything.
+     */
+    struct TransactionQuery
+    {
+        i32 bank_id = 0;     // 0 for every bank
+        i32 customer_id = 0; // 0 for every customer
+        u8 transaction_types = 0x07; // Bit per TransactionType
+        u8 account_types = 0x03;     // Bit per AccountType
+        QueryValidity validity = QueryValidity::ANY;
+        f64 min_amount = 0.0;
+        f64 max_amount = std::numeric_limits<f64>::infinity();
+        QueryGroup group_by = QueryGroup::NONE;
+
+        inline bool MatchesType(TransactionType type) const { return transaction_types & (1u << static_cast<u32>(type)); }
+        inline bool MatchesAccount(AccountType type) const { return account_types & (1u << static_cast<u32>(type)); }
+        bool Matches(const TransactionImage &transaction) const;
+    };
+
+    /**
+     * @brief One matching transaction, with the account it belongs to.
+     */
+    struct QueryRow
+    {
+        i32 bank_id;
+        i32 customer_id;
+        AccountID account_id;
+        AccountType account_type;
+        TransactionImage transaction;
+    };
+
+    /**
+     * @brief How much of the data a query had to look at, and how much its indexes let it skip.
+     */
+    struct QueryStats
+    {
+        size_t accounts_scanned = 0;
+        size_t accounts_skipped = 0; // Excluded by bank, customer or account type without reading any history
+        size_t blocks_scanned = 0;
+        size_t blocks_skipped = 0;  // Sealed blocks whose index ruled out every record
+        size_t records_decoded = 0; // Records decoded or read, whether or not they matched
+
+        void Add(const QueryStats &other);
+    };
+
+    /**
+     * @brief The count and sum of the matching amounts in one group.
+     */
+    struct QueryTotal
+    {
+        size_t count = 0;
+        f64 sum = 0.0;
+    };
+
+    /**
+     * @brief The totals of a query over a whole snapshot.
+     */
+    struct QuerySummary
+    {
+        QueryTotal total;
+        std::map<std::pair<i32, i32>, QueryTotal> groups; // Keyed by (bank ID, customer ID) or (0, enum value)
+        QueryStats stats;
+        f64 seconds = 0.0;
+    };
+
+    /**
+     * @brief An account a query will scan, with the IDs of its owners.
+     */
+    struct QueryTarget
+    {
+        i32 bank_id;
+        i32 customer_id;
+        const AccountImage *account;
+    };
+
+    /**
+     * @brief Streams the rows of a query a page at a time, scanning only as many accounts as each page needs.
+     *
+     * The cursor holds the snapshot it was opened on, so every page comes from the same version however
+     * much the bank graph changes in between. Rows come in bank, customer and account order, and each
+     * account's rows in chronological order.
+     */
+    class QueryCursor
+    {
+    private:
+        std::shared_ptr<const SystemImage> m_snapshot;
+        TransactionQuery m_query;
+        std::vector<QueryTarget> m_targets;
+        size_t m_next_target = 0;
+        std::vector<QueryRow> m_buffer; // Rows scanned but not yet returned
+        size_t m_buffer_position = 0;
+        QueryStats m_stats;
+
+    public:
+        QueryCursor(std::shared_ptr<const SystemImage> snapshot, const TransactionQuery &query);
+
+        bool NextPage(size_t page_size, std::vector<QueryRow> &page);
+        inline const QueryStats &GetStats() const { return m_stats; }
+    };
+
+    QuerySummary RunQuery(const SystemImage &snapshot, const TransactionQuery &query);
+    std::string QueryGroupLabel(QueryGroup group, const std::pair<i32, i32> &key);
+}
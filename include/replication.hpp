@@ -0,0 +1,93 @@
+#pragma once
+
+#include "types.hpp"
+#include <atomic>
+#include <fstream>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Bank
+{
+    class Bank;
+    class Customer;
+    class BankAccount;
+    class Transaction;
+    struct VelocityLimits;
+
+    /**
+     * @brief The primary's side of log shipping: an append-only record of every operation that changes
+     *        the bank graph, written to a file or named pipe that a standby tails.
+     *
+     * Records are tab-separated lines "<lsn> <primary time in ms> <kind> <fields...>". They carry every
+     * generated ID and the simulated time, so replaying them reproduces the primary's graph exactly.
+     * Logging is disabled (and free) until Open is called.
+     */
+    class ReplicationLog
+    {
+    private:
+        std::mutex m_mutex;
+        std::ofstream m_stream;
+        u64 m_next_lsn = 1;
+        u32 m_batch_depth = 0; // While non-zero, records are written but not flushed
+        bool m_enabled = false;
+
+        void Append(const std::string &kind, const std::string &fields);
+
+    public:
+        static ReplicationLog &Shared();
+
+        bool Open(const std::string &path);
+        inline bool IsEnabled() const { return m_enabled; }
+        void BeginBatch();
+        void EndBatch();
+
+        void LogBankCreated(const Bank &bank);
+        void LogCustomerAdded(const Customer &customer);
+        void LogAccountCreated(const BankAccount &account);
+        void LogTransaction(const BankAccount &account, const Transaction &transaction);
+        void LogInterestRollover(const Bank &bank);
+        void LogOverdraftFee(const BankAccount &account);
+        void LogVelocityLimits(const Customer &customer, const BankAccount *account, const VelocityLimits &limits);
+    };
+
+    /**
+     * @brief A read-only hot standby that applies a primary's replication log to its own bank graph.
+     *
+     * An applier thread tails the log and replays each record; after every batch it publishes a snapshot,
+     * which is what the standby console reads, so reporting queries never block replay.
+     */
+    class StandbyReplica
+    {
+    private:
+        std::string m_path;
+        std::vector<std::unique_ptr<Bank>> m_banks; // Owned by the applier thread
+        std::thread m_applier;
+        std::atomic<bool> m_stop{false};
+
+        std::atomic<u64> m_applied_lsn{0};
+        std::atomic<u64> m_records_applied{0};
+        std::atomic<u64> m_divergences{0};
+        std::atomic<u64> m_bytes_applied{0};
+        std::atomic<i64> m_last_record_ms{0}; // Primary time of the last applied record
+        std::atomic<bool> m_caught_up{false};  // True while the last read found nothing new
+
+        void ApplyLoop();
+        bool Apply(const std::string &record);
+
+    public:
+        explicit StandbyReplica(const std::string &path);
+        ~StandbyReplica();
+
+        void Start();
+        void Stop();
+        void PrintStatus(std::ostream &out) const;
+        void RunConsole(std::istream &in, std::ostream &out);
+    };
+
+    i32 RunStandbyMode(const std::string &path);
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "types.hpp"
+#include "account_id.hpp"
+#include "transaction_type.hpp"
+#include "timer_wheel.hpp"
+#include <ostream>
+#include <string>
+#include <unordered_map>
+
+namespace Bank
+{
+    class BankAccount;
+
+    enum class Frequency
+    {
+        DAILY,
+        WEEKLY,
+        MONTHLY
+    };
+
+    /**
+     * @brief A recurring transaction registered against a BankAccount.
+     */
+    struct StandingOrder
+    {
+        u64 order_id;
+        BankAccount *account;
+        TransactionType transaction_type;
+        f64 amount;
+        AccountID destination_account_id;
+        Frequency frequency;
+        i32 anchor_day; // Day of month for MONTHLY orders
+        i64 next_due;
+        u32 times_executed = 0;
+    };
+
+    /**
+     * @brief Executes standing orders through BankAccount::CreateTransaction as the SimClock advances.
+     *
+     * Due times are kept in a TimerWheel with one slot per SCHEDULER_TICK_SECONDS, so advancing the
+     * clock costs O(1) per tick plus O(1) per order that actually falls due.
+     */
+    class Scheduler
+    {
+    private:
+        TimerWheel<u64> m_wheel;
+        std::unordered_map<u64, StandingOrder> m_orders;
+        u64 m_next_order_id = 1;
+
+        static u64 ToTick(i64 time);
+        static i64 NextDueAfter(const StandingOrder &order);
+
+    public:
+        Scheduler();
+
+        static Scheduler &Shared();
+
+        u64 AddStandingOrder(BankAccount &account, TransactionType transaction_type, f64 amount,
+                             Frequency frequency, i64 first_due, AccountID destination_account_id = AccountID());
+        bool CancelStandingOrder(u64 order_id);
+        size_t AdvanceTo(i64 time);
+        void ViewStandingOrders(std::ostream &os) const;
+        inline size_t GetNumberOfStandingOrders() const { return m_orders.size(); }
+    };
+
+    std::string FrequencyToString(Frequency frequency);
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "types.hpp"
+#include <fstream>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Bank
+{
+    /**
+     * @brief Partitions banks across local worker processes and routes every operation by bank ID.
+     *
+     * Each worker is a forked copy of this program that owns a disjoint set of Bank objects and serves
+     * a line-based protocol over a Unix socket pair. Transfers between any two accounts are run as a
+     * two-phase commit: every participant first prepares its leg (validating the account and holding
+     * the funds), and only if all legs prepared does the coordinator log and send COMMIT; otherwise it
+     * sends ABORT. Workers can be pinned to separate CPUs so shards spread across sockets.
+     */
+    class ShardCoordinator
+    {
+    private:
+        struct Shard
+        {
+            i32 pid = -1;
+            i32 fd = -1;
+            std::string read_buffer;
+            size_t banks = 0;
+        };
+
+        std::vector<Shard> m_shards;
+        std::unordered_map<i32, size_t> m_routes; // Bank ID -> index into m_shards
+        u64 m_next_transfer_id = 1;
+        std::ofstream m_decision_log;
+
+        std::string Request(size_t shard, const std::string &command);
+        bool Route(i32 bank_id, size_t &shard, std::ostream &out) const;
+        i32 GenerateBankID() const;
+        void CreateBank(const std::string &bank_name, std::ostream &out);
+        void Transfer(i32 source_bank, i32 source_customer, const std::string &source_account,
+                      i32 destination_bank, i32 destination_customer, const std::string &destination_account,
+                      f64 amount, std::ostream &out);
+
+    public:
+        ShardCoordinator() = default;
+        ~ShardCoordinator();
+
+        bool Start(size_t shard_count);
+        void RunConsole(std::istream &in, std::ostream &out);
+        void Stop();
+    };
+
+    i32 RunShardedMode(size_t shard_count);
+}
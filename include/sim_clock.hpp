@@ -0,0 +1,32 @@
+#pragma once
+
+#include "types.hpp"
+#include <string>
+
+namespace Bank
+{
+    /**
+     * @brief A simulated wall clock, in seconds since the Unix epoch.
+     *
+     * Every time-dependent feature (transaction timestamps, standing orders) reads the time from here
+     * instead of the system clock, so a test can fast-forward months without waiting.
+     */
+    class SimClock
+    {
+    private:
+        i64 m_now;
+
+    public:
+        SimClock();
+
+        static SimClock &Shared();
+
+        inline i64 Now() const { return m_now; }
+        void AdvanceBy(i64 seconds);
+        void AdvanceTo(i64 time);
+
+        static i64 AddMonths(i64 time, i32 months, i32 anchor_day);
+        static i32 DayOfMonth(i64 time);
+        static std::string FormatDate(i64 time);
+    };
+}
@@ -0,0 +1,346 @@
+#pragma once
+
+#include "types.hpp"
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Bank
+{
+    /**
+     * @brief A generation-checked reference to an object in a SlotMap.
+     *
+     * A handle stays cheap to copy and store, and unlike a raw pointer it can tell when its object is gone:
+     * erasing bumps the slot's generation, so older handles to that slot no longer resolve.
+     */
+    template <typename T>
+    struct SlotHandle
+    {
+        static constexpr u32 INVALID_INDEX = std::numeric_limits<u32>::max();
+
+        u32 index = INVALID_INDEX;
+        u32 generation = 0;
+
+        inline bool IsValid() const { return index != INVALID_INDEX; }
+        friend bool operator==(SlotHandle, SlotHandle) = default;
+    };
+
+    /**
+     * @brief Owns objects in fixed-size blocks of slots and refers to them through SlotHandles.
+     *
+     * Insertion is O(1): it reuses a freed slot or appends one, and never moves existing objects, so their
+     * addresses stay valid for as long as they live. Objects sit side by side within each block, and iteration
+     * is a linear scan of the slots in insertion order (freed slots are refilled first).
+     *
+     * Slots may be sized for a family of types, so a single map can hold, say, every kind of account: construct
+     * it with the largest slot size and alignment and Emplace the derived type. Each object is destroyed as
+     * the type it was emplaced as, so T needs no virtual destructor. Constness is shallow, as with a
+     * container of owning pointers: a const map still hands out mutable objects.
+     *
+     * @tparam T The (base) type of the stored objects.
+     */
+    template <typename T>
+    class SlotMap
+    {
+    private:
+        static constexpr u32 BLOCK_SLOTS = 64;
+        static constexpr u32 NO_SLOT = SlotHandle<T>::INVALID_INDEX;
+
+        struct Slot
+        {
+            T *object = nullptr;            // Null while the slot is free
+            void (*destroy)(T *) = nullptr; // Runs the destructor of the type that was emplaced, which T's may not be
+            u32 generation = 0;
+            u32 next_free = NO_SLOT;
+        };
+
+        /**
+         * @brief Destroys an object as the type it was constructed as.
+         */
+        template <typename U>
+        static void Destroy(T *object)
+        {
+            static_cast<U *>(object)->~U();
+        }
+
+        std::vector<Slot> m_slots;
+        std::vector<std::byte *> m_blocks; // Each holds BLOCK_SLOTS * m_stride bytes and is never moved
+        size_t m_stride;
+        size_t m_align;
+        u32 m_free = NO_SLOT; // Head of the list of freed slots
+        size_t m_size = 0;
+
+        inline std::byte *Storage(u32 index) const
+        {
+            return m_blocks[index / BLOCK_SLOTS] + static_cast<size_t>(index % BLOCK_SLOTS) * m_stride;
+        }
+
+        /**
+         * @brief Returns a free slot, taking one from the free list or appending one (and a block when needed).
+         */
+        u32 Allocate()
+        {
+            if (m_free != NO_SLOT)
+            {
+                const u32 index = m_free;
+                m_free = m_slots[index].next_free;
+                return index;
+            }
+
+            const u32 index = static_cast<u32>(m_slots.size());
+            assert(index != NO_SLOT);
+            if (index / BLOCK_SLOTS == m_blocks.size())
+                m_blocks.push_back(static_cast<std::byte *>(::operator new(BLOCK_SLOTS * m_stride, std::align_val_t(m_align))));
+            m_slots.emplace_back();
+            return index;
+        }
+
+        /**
+         * @brief Makes a slot available again and invalidates every handle to it.
+         */
+        void Release(u32 index)
+        {
+            Slot &slot = m_slots[index];
+            slot.object = nullptr;
+            slot.generation++;
+            slot.next_free = m_free;
+            m_free = index;
+        }
+
+    public:
+        /**
+         * @brief A forward iterator over the live objects of a SlotMap.
+         */
+        class Iterator
+        {
+        private:
+            const Slot *m_slot;
+            const Slot *m_end;
+
+            inline void SkipFree()
+            {
+                while (m_slot != m_end && !m_slot->object)
+                    ++m_slot;
+            }
+
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+            using pointer = T *;
+            using reference = T &;
+
+            Iterator() : m_slot(nullptr), m_end(nullptr) {}
+            Iterator(const Slot *slot, const Slot *end) : m_slot(slot), m_end(end) { SkipFree(); }
+
+            inline T &operator*() const { return *m_slot->object; }
+            inline T *operator->() const { return m_slot->object; }
+            inline Iterator &operator++()
+            {
+                ++m_slot;
+                SkipFree();
+                return *this;
+            }
+            inline Iterator operator++(int)
+            {
+                Iterator previous = *this;
+                ++*this;
+                return previous;
+            }
+            friend bool operator==(const Iterator &a, const Iterator &b) { return a.m_slot == b.m_slot; }
+        };
+
+        /**
+         * @brief Constructs an empty map whose slots fit objects of up to the given size and alignment.
+         * @param slot_size The largest object size to be stored; defaults to sizeof(T).
+         * @param slot_align The strictest object alignment to be stored; defaults to alignof(T).
+         */
+        explicit SlotMap(size_t slot_size = sizeof(T), size_t slot_align = alignof(T))
+            : m_stride((slot_size + slot_align - 1) / slot_align * slot_align), m_align(slot_align)
+        {
+        }
+
+        SlotMap(const SlotMap &) = delete;
+        SlotMap &operator=(const SlotMap &) = delete;
+
+        /**
+         * @brief Destroys every live object (in insertion order) and frees the blocks.
+         */
+        ~SlotMap()
+        {
+            for (Slot &slot : m_slots)
+            {
+                if (slot.object)
+                    slot.destroy(slot.object);
+            }
+            for (std::byte *block : m_blocks)
+                ::operator delete(block, std::align_val_t(m_align));
+        }
+
+        /**
+         * @brief Constructs a new object in a free slot.
+         * @tparam U The type to construct: T or a type derived from it that fits the slot.
+         * @param args The constructor arguments.
+         * @return The handle to the new object and a reference to it.
+         */
+        template <typename U = T, typename... Args>
+        std::pair<SlotHandle<T>, U &> Emplace(Args &&...args)
+        {
+            static_assert(std::is_base_of_v<T, U>, "SlotMap can only hold T or types derived from it");
+            assert(sizeof(U) <= m_stride && alignof(U) <= m_align);
+
+            const u32 index = Allocate();
+            U *object;
+            try
+            {
+                object = ::new (static_cast<void *>(Storage(index))) U(std::forward<Args>(args)...);
+            }
+            catch (...)
+            {
+                Release(index);
+                throw;
+            }
+
+            Slot &slot = m_slots[index];
+            slot.object = object;
+            slot.destroy = &Destroy<U>;
+            m_size++;
+            return {SlotHandle<T>{index, slot.generation}, *object};
+        }
+
+        /**
+         * @brief Makes room for at least count objects in total, allocating their blocks up front.
+         * @param count The number of objects the map should hold without allocating again.
+         */
+        void Reserve(size_t count)
+        {
+            m_slots.reserve(count);
+            const size_t blocks = (count + BLOCK_SLOTS - 1) / BLOCK_SLOTS;
+            m_blocks.reserve(blocks);
+            while (m_blocks.size() < blocks)
+                m_blocks.push_back(static_cast<std::byte *>(::operator new(BLOCK_SLOTS * m_stride, std::align_val_t(m_align))));
+        }
+
+        /**
+         * @brief Destroys the object a handle refers to and frees its slot for reuse.
+         * @return False if the handle was stale or invalid.
+         */
+        bool Erase(SlotHandle<T> handle)
+        {
+            T *object = Get(handle);
+            if (!object)
+                return false;
+
+            m_slots[handle.index].destroy(object);
+            Release(handle.index);
+            m_size--;
+            return true;
+        }
+
+        /**
+         * @brief Resolves a handle.
+         * @return The object, or nullptr if the handle is invalid or its object has been erased.
+         */
+        inline T *Get(SlotHandle<T> handle) const
+        {
+            if (handle.index >= m_slots.size())
+                return nullptr;
+            const Slot &slot = m_slots[handle.index];
+            return slot.generation == handle.generation ? slot.object : nullptr;
+        }
+
+        /**
+         * @brief Returns the bytes taken by the live objects' slots and their bookkeeping.
+         */
+        inline size_t GetUsedBytes() const { return m_size * GetSlotBytes(); }
+
+        /**
+         * @brief Returns the bytes one live object takes: its slot and its bookkeeping.
+         */
+        inline size_t GetSlotBytes() const { return m_stride + sizeof(Slot); }
+
+        /**
+         * @brief Returns the bytes the map has allocated: every block, whether its slots are used or not, and the bookkeeping.
+         */
+        inline size_t GetReservedBytes() const
+        {
+            return m_blocks.size() * BLOCK_SLOTS * m_stride + m_slots.capacity() * sizeof(Slot) +
+                   m_blocks.capacity() * sizeof(std::byte *);
+        }
+
+        inline size_t size() const { return m_size; }
+        inline bool empty() const { return m_size == 0; }
+        inline Iterator begin() const { return Iterator(m_slots.data(), m_slots.data() + m_slots.size()); }
+        inline Iterator end() const { return Iterator(m_slots.data() + m_slots.size(), m_slots.data() + m_slots.size()); }
+    };
+
+    /**
+     * @brief A view of the objects that a list of handles refers to, e.g. one customer's accounts in its bank's map.
+     *
+     * Iteration yields the objects in the order of the handles. Every handle is expected to be live.
+     */
+    template <typename T>
+    class SlotRange
+    {
+    private:
+        const SlotMap<T> *m_map;
+        const SlotHandle<T> *m_first;
+        const SlotHandle<T> *m_last;
+
+    public:
+        /**
+         * @brief A forward iterator that resolves each handle as it goes.
+         */
+        class Iterator
+        {
+        private:
+            const SlotMap<T> *m_map;
+            const SlotHandle<T> *m_handle;
+
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+            using pointer = T *;
+            using reference = T &;
+
+            Iterator() : m_map(nullptr), m_handle(nullptr) {}
+            Iterator(const SlotMap<T> *map, const SlotHandle<T> *handle) : m_map(map), m_handle(handle) {}
+
+            inline T &operator*() const
+            {
+                T *object = m_map->Get(*m_handle);
+                assert(object);
+                return *object;
+            }
+            inline T *operator->() const { return &**this; }
+            inline Iterator &operator++()
+            {
+                ++m_handle;
+                return *this;
+            }
+            inline Iterator operator++(int)
+            {
+                Iterator previous = *this;
+                ++m_handle;
+                return previous;
+            }
+            friend bool operator==(const Iterator &a, const Iterator &b) { return a.m_handle == b.m_handle; }
+        };
+
+        SlotRange(const SlotMap<T> &map, const SlotHandle<T> *first, const SlotHandle<T> *last)
+            : m_map(&map), m_first(first), m_last(last)
+        {
+        }
+
+        inline size_t size() const { return static_cast<size_t>(m_last - m_first); }
+        inline bool empty() const { return m_first == m_last; }
+        inline Iterator begin() const { return Iterator(m_map, m_first); }
+        inline Iterator end() const { return Iterator(m_map, m_last); }
+    };
+}
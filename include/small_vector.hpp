@@ -0,0 +1,181 @@
+#pragma once
+
+#include "types.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace Bank
+{
+    /**
+     * @brief A vector that keeps its first N elements inside the object itself and only allocates beyond that.
+     *
+     * Most customers have one or two accounts and most accounts a handful of transactions, so sizing N for
+     * the common case means those lists never touch the heap. Past N the elements move to a heap buffer that
+     * doubles as it fills, as a std::vector would. Iterators are plain pointers and are invalidated by any
+     * insertion that grows the buffer.
+     *
+     * @tparam T The element type.
+     * @tparam N The number of elements stored inline.
+     */
+    template <typename T, size_t N>
+    class SmallVector
+    {
+    private:
+        static_assert(N > 0, "A SmallVector needs room for at least one inline element");
+
+        T *m_data;
+        u32 m_size = 0;
+        u32 m_capacity = N;
+        alignas(T) std::byte m_inline[N * sizeof(T)];
+
+        inline T *InlineData() { return std::launder(reinterpret_cast<T *>(m_inline)); }
+
+        /**
+         * @brief Moves the elements into a buffer of the given capacity, releasing the previous heap buffer if any.
+         */
+        void Grow(size_t capacity)
+        {
+            T *buffer = static_cast<T *>(::operator new(capacity * sizeof(T), std::align_val_t(alignof(T))));
+            std::uninitialized_move(m_data, m_data + m_size, buffer);
+            std::destroy(m_data, m_data + m_size);
+            ReleaseHeap();
+            m_data = buffer;
+            m_capacity = static_cast<u32>(capacity);
+        }
+
+        inline void ReleaseHeap()
+        {
+            if (!IsInline())
+                ::operator delete(m_data, std::align_val_t(alignof(T)));
+        }
+
+    public:
+        using value_type = T;
+        using iterator = T *;
+        using const_iterator = const T *;
+
+        SmallVector() : m_data(InlineData()) {}
+        SmallVector(const SmallVector &) = delete;
+        SmallVector &operator=(const SmallVector &) = delete;
+
+        ~SmallVector()
+        {
+            std::destroy(m_data, m_data + m_size);
+            ReleaseHeap();
+        }
+
+        /**
+         * @brief Returns true while the elements still fit in the inline storage.
+         */
+        inline bool IsInline() const { return m_data == reinterpret_cast<const T *>(m_inline); }
+
+        inline size_t size() const { return m_size; }
+        inline size_t capacity() const { return m_capacity; }
+        inline bool empty() const { return m_size == 0; }
+
+        inline T *data() { return m_data; }
+        inline const T *data() const { return m_data; }
+        inline T *begin() { return m_data; }
+        inline T *end() { return m_data + m_size; }
+        inline const T *begin() const { return m_data; }
+        inline const T *end() const { return m_data + m_size; }
+
+        inline T &operator[](size_t index) { return m_data[index]; }
+        inline const T &operator[](size_t index) const { return m_data[index]; }
+        inline T &front() { return m_data[0]; }
+        inline const T &front() const { return m_data[0]; }
+        inline T &back() { return m_data[m_size - 1]; }
+        inline const T &back() const { return m_data[m_size - 1]; }
+
+        /**
+         * @brief Makes room for at least capacity elements without further allocation.
+         */
+        void reserve(size_t capacity)
+        {
+            if (capacity > m_capacity)
+                Grow(capacity);
+        }
+
+        /**
+         * @brief Constructs an element at the end, doubling the capacity when full.
+         * @return A reference to the new element.
+         */
+        template <typename... Args>
+        T &emplace_back(Args &&...args)
+        {
+            if (m_size == m_capacity)
+                Grow(static_cast<size_t>(m_capacity) * 2);
+            T *element = ::new (static_cast<void *>(m_data + m_size)) T(std::forward<Args>(args)...);
+            m_size++;
+            return *element;
+        }
+
+        inline void push_back(T &&value) { emplace_back(std::move(value)); }
+        inline void push_back(const T &value) { emplace_back(value); }
+
+        /**
+         * @brief Inserts an element before position, shifting the later elements up by one.
+         * @param position Where to insert, from begin() to end().
+         * @param value The element to insert.
+         * @return An iterator to the inserted element.
+         */
+        T *insert(const T *position, T &&value)
+        {
+            const size_t index = static_cast<size_t>(position - m_data);
+            assert(index <= m_size);
+
+            emplace_back(std::move(value));
+            std::rotate(m_data + index, m_data + m_size - 1, m_data + m_size);
+            return m_data + index;
+        }
+
+        /**
+         * @brief Removes the elements in [first, last), shifting the later elements down.
+         * @return An iterator to the element that followed the removed ones.
+         */
+        T *erase(const T *first, const T *last)
+        {
+            T *begin = m_data + (first - m_data);
+            T *end = std::move(m_data + (last - m_data), m_data + m_size, begin);
+            std::destroy(end, m_data + m_size);
+            m_size = static_cast<u32>(end - m_data);
+            return begin;
+        }
+
+        /**
+         * @brief Releases unused heap capacity, moving the elements back inline if they fit.
+         */
+        void shrink_to_fit()
+        {
+            if (IsInline() || m_size == m_capacity)
+                return;
+
+            if (m_size > N)
+            {
+                Grow(m_size);
+                return;
+            }
+
+            T *heap = m_data;
+            std::uninitialized_move(heap, heap + m_size, InlineData());
+            std::destroy(heap, heap + m_size);
+            ::operator delete(heap, std::align_val_t(alignof(T)));
+            m_data = InlineData();
+            m_capacity = N;
+        }
+
+        /**
+         * @brief Destroys every element, keeping the current buffer.
+         */
+        void clear()
+        {
+            std::destroy(m_data, m_data + m_size);
+            m_size = 0;
+        }
+    };
+}
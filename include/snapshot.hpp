@@ -0,0 +1,153 @@
+#pragma once
+
+#include "account_type.hpp"
+#include "account_id.hpp"
+#include "transaction_type.hpp"
+#include "transaction_archive.hpp"
+#include "transaction_block.hpp"
+#include "types.hpp"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace Bank
+{
+    class Bank;
+    class Customer;
+    class BankAccount;
+    class Transaction;
+
+    /**
+     * @brief The newest transactions of an account image, fewer than SNAPSHOT_CHUNK_SIZE, in chronological order.
+     *
+     * Once a chunk fills it is sealed into a compressed TransactionBlock. Blocks and chunks are shared
+     * between every version of an account, so publishing a new transaction copies at most one chunk
+     * plus the list of block pointers rather than the whole history.
+     */
+    using TransactionChunk = std::vector<TransactionImage>;
+
+    /**
+     * @brief An immutable copy of a BankAccount as of one published version.
+     */
+    struct AccountImage
+    {
+        AccountID account_id;
+        AccountType account_type;
+        f64 balance;              // Balance as of interest_period
+        u64 interest_period;      // The owning Bank's interest period when the balance was captured
+        size_t transaction_count = 0; // Including archived ones
+        // Transactions still in memory when captured: the older ones sealed, the newest in the tail
+        std::vector<std::shared_ptr<const TransactionBlock>> blocks;
+        std::shared_ptr<const TransactionChunk> tail;
+        std::shared_ptr<const ArchivedHistory> archived;            // The older ones, read from disk on demand
+
+        f64 GetBalance(u64 bank_interest_period) const;
+        std::vector<TransactionImage> GetTransactionsByID() const;
+        void ViewAccountTransactions() const;
+    };
+
+    /**
+     * @brief An immutable copy of a Customer and its accounts as of one published version.
+     */
+    struct CustomerImage
+    {
+        i32 customer_id;
+        // Views into the StringPool, which outlives every snapshot
+        std::string_view first_name;
+        std::string_view last_name;
+        std::string_view name;
+        i32 age;
+        std::vector<std::shared_ptr<const AccountImage>> accounts; // In the order the accounts were opened
+
+        inline std::string_view GetName() const { return name; }
+        const AccountImage *FindAccount(AccountID account_id) const;
+        void DisplayCustomerInfo() const;
+    };
+
+    /**
+     * @brief An immutable copy of a Bank and its customers as of one published version.
+     */
+    struct BankImage
+    {
+        i32 bank_id;
+        std::string_view bank_name;
+        u64 interest_period;
+        std::vector<std::shared_ptr<const CustomerImage>> customers; // In the order the customers were added
+
+        const CustomerImage *FindCustomer(i32 customer_id) const;
+        void ViewAllCustomers() const;
+    };
+
+    /**
+     * @brief A consistent point-in-time view of every bank, customer, account and balance.
+     *
+     * Holding the shared_ptr keeps this version (and every image it shares with later versions) alive;
+     * once the last reader lets go, whatever no newer version still references is freed.
+     */
+    struct SystemImage
+    {
+        u64 version = 0;
+        std::vector<std::shared_ptr<const BankImage>> banks; // Sorted by bank ID
+
+        SystemImage();
+        SystemImage(const SystemImage &) = delete;
+        ~SystemImage();
+
+        const BankImage *FindBank(i32 bank_id) const;
+        void WriteToStream(std::ostream &os) const;
+    };
+
+    /**
+     * @brief Publishes multi-version snapshots of the bank graph for readers that must not see torn state.
+     *
+     * Writers record what they changed with MarkDirty. Publish then rebuilds only the images on the path
+     * from each changed account up to the root (path copying) and swaps the new root in atomically.
+     * Readers call Acquire and work on an immutable version while writers keep committing.
+     */
+    class SnapshotManager
+    {
+    private:
+        std::atomic<std::shared_ptr<const SystemImage>> m_current;
+        u64 m_version = 0;
+
+        std::mutex m_dirty_mutex;
+        bool m_banks_dirty = true;
+        std::unordered_set<const Bank *> m_dirty_banks;
+        std::unordered_set<const Customer *> m_dirty_customers;
+        std::unordered_map<const BankAccount *, std::vector<TransactionImage>> m_dirty_accounts;
+        std::unordered_set<const BankAccount *> m_archived_accounts;
+
+        // The latest image of each entity, reused by the next version if the entity has not changed
+        std::mutex m_publish_mutex;
+        std::unordered_map<const Bank *, std::shared_ptr<const BankImage>> m_bank_images;
+        std::unordered_map<const Customer *, std::shared_ptr<const CustomerImage>> m_customer_images;
+        std::unordered_map<const BankAccount *, std::shared_ptr<const AccountImage>> m_account_images;
+
+        std::shared_ptr<const AccountImage> BuildAccountImage(const BankAccount &account,
+                                                              std::vector<TransactionImage> new_transactions);
+        std::shared_ptr<const CustomerImage> BuildCustomerImage(const Customer &customer);
+        std::shared_ptr<const BankImage> BuildBankImage(const Bank &bank);
+
+    public:
+        SnapshotManager();
+
+        static SnapshotManager &Shared();
+
+        void MarkBanksDirty();
+        void MarkDirty(const Bank &bank);
+        void MarkDirty(const Customer &customer);
+        void MarkDirty(const BankAccount &account, const Transaction *new_transaction = nullptr);
+        void MarkArchived(const BankAccount &account);
+
+        std::shared_ptr<const SystemImage> Publish(const std::vector<std::unique_ptr<Bank>> &banks);
+        inline std::shared_ptr<const SystemImage> Acquire() const { return m_current.load(); }
+
+        static size_t GetLiveVersions();
+    };
+}
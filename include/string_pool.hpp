@@ -0,0 +1,42 @@
+#pragma once
+
+#include "types.hpp"
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace Bank
+{
+    /**
+     * @brief Stores each distinct string once and hands out views that stay valid for the whole run.
+     *
+     * Names are interned when an object is created, so a thousand customers called "Smith" share one
+     * copy, and every later read (log lines, listings, exports) is a view with no allocation. Strings
+     * are packed into large blocks that are never moved or freed, which is what keeps the views stable.
+     */
+    class StringPool
+    {
+    private:
+        static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+        std::mutex m_mutex;
+        std::unordered_set<std::string_view> m_strings;
+        std::vector<std::unique_ptr<char[]>> m_blocks; // Shared blocks of BLOCK_SIZE bytes; only the last has room
+        std::vector<std::unique_ptr<char[]>> m_large;  // Strings longer than a quarter block
+        size_t m_block_used = BLOCK_SIZE; // Bytes used in the newest block; full until the first one exists
+        size_t m_bytes = 0;
+        size_t m_large_bytes = 0;
+
+    public:
+        static StringPool &Shared();
+
+        std::string_view Intern(std::string_view text);
+
+        size_t GetStringCount();
+        size_t GetBytes();
+        size_t GetReservedBytes();
+    };
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "types.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief A fixed-size pool of worker threads that executes submitted tasks in FIFO order.
+ *
+ * Long-running passes over every bank (audits, batch jobs, loaders) split their work into
+ * chunks and hand them to the shared pool instead of spawning threads on every call.
+ */
+class ThreadPool
+{
+private:
+    std::vector<std::thread> m_workers;
+    std::queue<std::function<void()>> m_tasks;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    bool m_stopping = false;
+
+    void WorkerLoop();
+
+public:
+    explicit ThreadPool(size_t thread_count = std::thread::hardware_concurrency());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    static ThreadPool &Shared();
+
+    inline size_t GetThreadCount() const { return m_workers.size(); }
+
+    /**
+     * @brief Queues a callable for execution on one of the worker threads.
+     * @tparam F A callable type taking no arguments.
+     * @param task The callable to run.
+     * @return A future that becomes ready once the task has finished (or thrown).
+     */
+    template <typename F>
+    auto Submit(F &&task) -> std::future<decltype(task())>
+    {
+        using R = decltype(task());
+        auto packaged = std::make_shared<std::packaged_task<R()>>(std::forward<F>(task));
+        std::future<R> result = packaged->get_future();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_tasks.emplace([packaged]()
+                            { (*packaged)(); });
+        }
+        m_condition.notify_one();
+        return result;
+    }
+
+    /**
+     * @brief Queues a callable without tracking its completion, for callers that signal it themselves.
+     *
+     * Cheaper than Submit since no future is created; used to resume coroutines on a worker thread.
+     *
+     * @param task The callable to run. It must not throw.
+     */
+    void Post(std::function<void()> task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_tasks.push(std::move(task));
+        }
+        m_condition.notify_one();
+    }
+
+    /**
+     * @brief Splits the index range [0, count) into contiguous chunks and runs body(begin, end) on each in parallel.
+     *
+     * Blocks until every chunk has completed. Exceptions thrown by a chunk are rethrown here.
+     *
+     * @param count The number of items to process.
+     * @param body A callable invoked as body(begin, end) for each chunk.
+     * @param min_chunk The smallest chunk worth handing to a separate thread.
+     */
+    template <typename F>
+    void ParallelFor(size_t count, F &&body, size_t min_chunk = 64)
+    {
+        if (count == 0)
+            return;
+
+        // Small inputs are not worth the hand-off cost
+        size_t chunks = std::max<size_t>(1, std::min(GetThreadCount() * 4, count / std::max<size_t>(1, min_chunk)));
+        if (chunks == 1)
+        {
+            body(size_t{0}, count);
+            return;
+        }
+
+        size_t chunk_size = (count + chunks - 1) / chunks;
+        std::vector<std::future<void>> pending;
+        pending.reserve(chunks);
+        for (size_t begin = 0; begin < count; begin += chunk_size)
+        {
+            size_t end = std::min(count, begin + chunk_size);
+            pending.push_back(Submit([&body, begin, end]()
+                                     { body(begin, end); }));
+        }
+
+        for (auto &future : pending)
+            future.get();
+    }
+};
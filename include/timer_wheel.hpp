@@ -0,0 +1,143 @@
+#pragma once
+
+#include "types.hpp"
+#include <array>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace Bank
+{
+    /**
+     * @brief A hierarchical timing wheel that fires payloads at whole-tick deadlines.
+     *
+     * Level 0 holds the next SLOTS ticks one slot per tick; each higher level covers SLOTS times the
+     * span of the level below. Scheduling is O(1), and each tick only touches the current level-0 slot
+     * plus, once every SLOTS ticks, one slot of a higher level whose entries cascade down. The cost of a
+     * tick therefore depends on how many timers are due, not on how many are registered.
+     *
+     * @tparam T The payload type carried by each timer.
+     */
+    template <typename T>
+    class TimerWheel
+    {
+    private:
+        static constexpr u32 SLOT_BITS = 6;
+        static constexpr u32 SLOTS = 1u << SLOT_BITS;
+        static constexpr u32 SLOT_MASK = SLOTS - 1;
+        static constexpr u32 LEVELS = 4;
+
+        struct Entry
+        {
+            u64 deadline;
+            T payload;
+        };
+
+        std::array<std::array<std::vector<Entry>, SLOTS>, LEVELS> m_levels;
+        u64 m_current_tick;
+        size_t m_size = 0;
+
+        /**
+         * @brief Places an entry in the slot covering its deadline, relative to the current tick.
+         */
+        void Place(Entry &&entry)
+        {
+            u64 delta = entry.deadline > m_current_tick ? entry.deadline - m_current_tick : 0;
+
+            u32 level = 0;
+            while (level + 1 < LEVELS && delta >= (u64{1} << (SLOT_BITS * (level + 1))))
+                level++;
+
+            // Deadlines beyond the top level's span wait in its furthest slot and re-cascade later
+            u64 deadline = entry.deadline;
+            if (level == LEVELS - 1)
+            {
+                u64 max_delta = (u64{1} << (SLOT_BITS * LEVELS)) - 1;
+                if (delta > max_delta)
+                    deadline = m_current_tick + max_delta;
+            }
+            else if (delta == 0)
+            {
+                deadline = m_current_tick;
+            }
+
+            u32 slot = static_cast<u32>(deadline >> (SLOT_BITS * level)) & SLOT_MASK;
+            m_levels[level][slot].push_back(std::move(entry));
+        }
+
+        /**
+         * @brief Moves every entry of one higher-level slot down into the levels below it.
+         */
+        void Cascade(u32 level)
+        {
+            u32 slot = static_cast<u32>(m_current_tick >> (SLOT_BITS * level)) & SLOT_MASK;
+            std::vector<Entry> entries = std::move(m_levels[level][slot]);
+            m_levels[level][slot].clear();
+            for (auto &entry : entries)
+                Place(std::move(entry));
+        }
+
+    public:
+        explicit TimerWheel(u64 start_tick = 0) : m_current_tick(start_tick) {}
+
+        inline u64 GetCurrentTick() const { return m_current_tick; }
+        inline size_t GetSize() const { return m_size; }
+
+        /**
+         * @brief Registers a payload to fire at the given tick. Past deadlines fire on the next Advance.
+         * @param deadline The tick at which the payload becomes due.
+         * @param payload The value handed back when the timer fires.
+         */
+        void Schedule(u64 deadline, T payload)
+        {
+            Place(Entry{deadline, std::move(payload)});
+            m_size++;
+        }
+
+        /**
+         * @brief Fires everything due in the current tick, then advances one tick at a time up to target_tick.
+         *
+         * @param target_tick The last tick to process (inclusive of entries due at that tick).
+         * @param on_fire A callable invoked as on_fire(payload, deadline) for each due timer. It may
+         *                schedule new timers, including ones that fall due within the same advance.
+         */
+        template <typename F>
+        void Advance(u64 target_tick, F &&on_fire)
+        {
+            while (true)
+            {
+                // Drain the current slot; firing may schedule more entries into it
+                auto &slot = m_levels[0][m_current_tick & SLOT_MASK];
+                while (!slot.empty())
+                {
+                    std::vector<Entry> due = std::move(slot);
+                    slot.clear();
+                    for (auto &entry : due)
+                    {
+                        // Entries parked at the top level with a clamped deadline are not due yet
+                        if (entry.deadline > m_current_tick)
+                        {
+                            Place(std::move(entry));
+                            continue;
+                        }
+                        m_size--;
+                        on_fire(entry.payload, entry.deadline);
+                    }
+                }
+
+                if (m_current_tick >= target_tick)
+                    break;
+
+                m_current_tick++;
+
+                // When a lower level wraps around, pull the next span down from the level above.
+                // Higher levels go first so their entries can land in the lower slots cascaded next.
+                u32 wrapped = 0;
+                while (wrapped + 1 < LEVELS && (m_current_tick & ((u64{1} << (SLOT_BITS * (wrapped + 1))) - 1)) == 0)
+                    wrapped++;
+                for (u32 level = wrapped; level >= 1; level--)
+                    Cascade(level);
+            }
+        }
+    };
+}
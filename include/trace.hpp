@@ -0,0 +1,118 @@
+#pragma once
+
+#include "types.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Bank
+{
+    /**
+     * @brief One finished span, written as a Chrome trace "complete" event.
+     */
+    struct TraceEvent
+    {
+        const char *name; // A string literal, so recording copies no text
+        i64 start_ns;     // Since the trace was opened
+        i64 duration_ns;
+        u32 thread; // Small sequential ID of the thread that recorded it
+    };
+
+    /**
+     * @brief Writes a timeline of nested spans as Chrome trace-event JSON, for chrome://tracing or Perfetto.
+     *
+     * Tracing is disabled (and costs one atomic load per span) until Open is called. Each thread records
+     * finished spans into a buffer of its own, locking only that buffer. A writer thread formats and
+     * writes them in the background: it takes over a buffer as soon as it fills, and every buffer every
+     * TRACE_FLUSH_INTERVAL_MS. Spans on one thread nest by their times, so the viewer shows, say,
+     * HandleUserChoice > AddTransaction > CreateTransaction as a stack, with one row per thread.
+     */
+    class Tracer
+    {
+    private:
+        struct ThreadBuffer
+        {
+            std::mutex mutex; // Contended only while the writer takes the events over
+            std::vector<TraceEvent> events;
+            u32 thread = 0;
+        };
+
+        std::atomic<bool> m_enabled{false};
+        std::chrono::steady_clock::time_point m_origin;
+        std::string m_path;
+        std::ofstream m_stream; // Written only by the writer thread while open
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+        std::vector<std::shared_ptr<ThreadBuffer>> m_buffers; // Shared with the thread that records into each
+        std::vector<std::vector<TraceEvent>> m_pending;       // Full buffers, waiting to be written
+        std::thread m_writer;
+        bool m_stopping = false;
+        u32 m_next_thread = 1;
+        u64 m_events_written = 0;
+
+        ThreadBuffer &GetThreadBuffer();
+        void CollectBuffers(std::vector<std::vector<TraceEvent>> &out);
+        void WriterLoop();
+        void Write(const std::vector<TraceEvent> &events);
+
+    public:
+        Tracer() = default;
+        ~Tracer();
+        Tracer(const Tracer &) = delete;
+        Tracer &operator=(const Tracer &) = delete;
+
+        static Tracer &Shared();
+
+        bool Open(const std::string &path);
+        u64 Close();
+        inline bool IsEnabled() const { return m_enabled.load(std::memory_order_acquire); }
+        // Stops recording without touching the writer, e.g. in a forked child that must not take its locks
+        inline void Disable() { m_enabled.store(false); }
+        inline const std::string &GetPath() const { return m_path; }
+        inline i64 Now() const
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_origin).count();
+        }
+        void Record(const char *name, i64 start_ns, i64 duration_ns);
+    };
+
+    /**
+     * @brief Times the enclosing scope, or until End, as a span of the trace, if tracing is on.
+     */
+    class TraceSpan
+    {
+    private:
+        const char *m_name;
+        i64 m_start = -1; // -1 if not recording
+
+    public:
+        /**
+         * @param name The span's name, which must be a string literal.
+         */
+        explicit TraceSpan(const char *name) : m_name(name)
+        {
+            if (Tracer::Shared().IsEnabled())
+                m_start = Tracer::Shared().Now();
+        }
+        ~TraceSpan() { End(); }
+        TraceSpan(const TraceSpan &) = delete;
+        TraceSpan &operator=(const TraceSpan &) = delete;
+
+        /**
+         * @brief Ends the span early, e.g. before waiting on the user.
+         */
+        inline void End()
+        {
+            if (m_start < 0)
+                return;
+            Tracer::Shared().Record(m_name, m_start, Tracer::Shared().Now() - m_start);
+            m_start = -1;
+        }
+    };
+}
@@ -2,40 +2,75 @@
 
 #include "types.hpp"
 #include "transaction_type.hpp"
+#include "account_id.hpp"
+#include "slot_map.hpp"
 #include <string>
+#include <string_view>
 #include <memory>
 #include <iomanip>
 
 namespace Bank
 {
     class BankAccount;
+    struct TransactionImage;
+    using AccountHandle = SlotHandle<BankAccount>;
 
     class Transaction
     {
     private:
         i32 m_transaction_id;
-        BankAccount &m_associated_account;
+        u64 m_sequence; // Position of this transaction in its account's history (IDs are random, not chronological)
+        AccountHandle m_associated_account; // Resolved through the owning Bank
         f64 m_transaction_amount;
-        std::string m_destination_account_id;
+        AccountID m_destination_account_id;
         TransactionType m_transaction_type;
         f64 m_balance_before_transaction;
         f64 m_balance_after_transaction;
         bool m_was_invalid = false;
+        i64 m_timestamp; // Simulated time at which the transaction was executed
 
-        void ExecuteTransaction();
+        void ExecuteTransaction(BankAccount &account);
+        bool WithinVelocityLimits(BankAccount &account) const;
         void GenerateTransactionID();
 
     public:
         Transaction() = default;
-        Transaction(BankAccount &account, f64 amount, TransactionType transaction_type, const std::string &destination_account_id);
+        Transaction(BankAccount &account, f64 amount, TransactionType transaction_type, AccountID destination_account_id,
+                    i32 transaction_id = 0);
+        Transaction(const BankAccount &account, const TransactionImage &image);
         ~Transaction();
 
         inline i32 GetTransactionID() const { return m_transaction_id; }
+        inline u64 GetSequence() const { return m_sequence; }
+        inline AccountHandle GetAccountHandle() const { return m_associated_account; }
+        inline TransactionType GetType() const { return m_transaction_type; }
+        inline AccountID GetDestinationAccountID() const { return m_destination_account_id; }
         void DisplayTransaction() const;
         inline f64 GetTransactionAmount() const { return m_transaction_amount; }
         inline f64 GetBalanceBeforeTransaction() const { return m_balance_before_transaction; }
         inline f64 GetBalanceAfterTransaction() const { return m_balance_after_transaction; }
-        std::string GetTransactionType() const;
+        std::string_view GetTransactionType() const;
         inline bool WasInvalid() const { return m_was_invalid; }
+        inline i64 GetTimestamp() const { return m_timestamp; }
     };
+
+    /**
+     * @brief An immutable copy of a Transaction, as captured by snapshots and written to archives.
+     */
+    struct TransactionImage
+    {
+        i32 transaction_id;
+        u64 sequence;
+        TransactionType transaction_type;
+        f64 amount;
+        f64 balance_before;
+        f64 balance_after;
+        bool was_invalid;
+        i64 timestamp;
+    };
+
+    TransactionImage CaptureTransaction(const Transaction &transaction);
+    std::string_view TransactionTypeToString(TransactionType type);
+    void DisplayTransactionDetails(i32 transaction_id, TransactionType transaction_type, i64 timestamp,
+                                   f64 amount, f64 balance_before, f64 balance_after);
 }
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "transaction.hpp"
+#include "types.hpp"
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace Bank
+{
+    class TransactionArchive;
+
+    // Archive files hold TransactionImages byte for byte
+    static_assert(std::is_trivially_copyable_v<TransactionImage>, "TransactionImage must be trivially copyable to be archived");
+
+    /**
+     * @brief A run of one account's transactions in its bank's archive file, in chronological order.
+     */
+    struct ArchiveExtent
+    {
+        u64 offset; // In bytes from the start of the file
+        u32 count;
+    };
+
+    /**
+     * @brief The part of an account's history that has been moved out of memory, and a checkpoint summarising it.
+     *
+     * Archived transactions are always the oldest ones, so the checkpoint is all that is needed to carry
+     * on checking the balance chain through the transactions still in memory. An ArchivedHistory is never
+     * modified once an account holds it: archiving more builds a new one, so snapshots can keep sharing
+     * the one they captured.
+     */
+    struct ArchivedHistory
+    {
+        const TransactionArchive *archive = nullptr; // Owned by the account's Bank
+        std::vector<ArchiveExtent> extents;          // One per archival pass, oldest first
+        size_t transaction_count = 0;
+        f64 balance_after = 0.0;   // Balance left by the last archived transaction
+        f64 net_change = 0.0;      // Sum of (after - before) over the archived transactions
+        f64 transferred_out = 0.0; // Successful transfers out among them
+        f64 balance_drops = 0.0;   // Falls in balance between archived transactions (end-of-day fees)
+
+        void Summarise(const TransactionImage *transactions, size_t count, f64 opening_balance);
+        void Load(std::vector<TransactionImage> &out) const;
+        bool Find(i32 transaction_id, TransactionImage &out) const;
+    };
+
+    /**
+     * @brief An append-only file of one bank's archived transactions, read back on demand.
+     *
+     * The file is recreated the first time a bank archives in a run. Every append is flushed before its
+     * extent is handed out, and each read opens its own stream, so snapshot readers on other threads may
+     * read while the writer appends.
+     *
+     * An archive can also be opened read-only over an existing file, such as the checkpoint a run was
+     * restored from. It then keeps the file open for every read, so the data stays readable even if the
+     * file is replaced by a newer checkpoint. Reads from it never move a shared file offset, so threads
+     * and a forked checkpoint writer may all read at once.
+     */
+    class TransactionArchive
+    {
+    private:
+        std::string m_path;
+        std::ofstream m_file;
+        u64 m_size = 0;
+        // Only open for a read-only archive
+#ifdef _WIN32
+        mutable std::ifstream m_reader;
+        mutable std::mutex m_reader_mutex;
+#else
+        i32 m_reader = -1; // Read with pread, which takes its own offset
+#endif
+
+    public:
+        explicit TransactionArchive(i32 bank_id);
+        explicit TransactionArchive(const std::string &path);
+        ~TransactionArchive();
+        TransactionArchive(const TransactionArchive &) = delete;
+        TransactionArchive &operator=(const TransactionArchive &) = delete;
+
+        bool Append(const TransactionImage *transactions, size_t count, ArchiveExtent &extent);
+        bool Read(const ArchiveExtent &extent, std::vector<TransactionImage> &out) const;
+        inline bool IsOpen() const { return m_file.is_open(); }
+        inline const std::string &GetPath() const { return m_path; }
+        inline u64 GetSize() const { return m_size; }
+    };
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "transaction.hpp"
+#include "types.hpp"
+#include "transaction_type.hpp"
+#include <array>
+#include <memory>
+#include <vector>
+
+namespace Bank
+{
+    /**
+     * @brief A sealed, compressed run of transactions from one account's history, in chronological order.
+     *
+     * Consecutive records differ little, so each is stored relative to the one before it: sequence
+     * numbers and timestamps as varint deltas, amounts as varint cents, and balances not at all when
+     * they follow from the previous balance and the amount (as they almost always do). Values that do
+     * not fit that pattern, such as balances after interest, fall back to cents or to the raw double,
+     * so decoding always reproduces the original records exactly. A typical record takes about 10 bytes
+     * instead of a full Transaction.
+     *
+     * Blocks are immutable once sealed and are only ever read front to back. Each also keeps a small
+     * index (a bitmap of its records per transaction type, one of its invalid records, and its range of
+     * amounts) so that queries can skip a block, or stop decoding it early, without touching its bytes.
+     */
+    class TransactionBlock
+    {
+    private:
+        std::unique_ptr<u8[]> m_bytes;
+        u32 m_size = 0;  // Bytes of encoded records
+        u32 m_count = 0; // Records in the block
+        std::array<u64, TRANSACTION_TYPES> m_type_bits{}; // Bit i is set if record i is of that type
+        u64 m_invalid_bits = 0;                            // Bit i is set if record i was declined
+        f64 m_min_amount = 0.0;
+        f64 m_max_amount = 0.0;
+
+    public:
+        static constexpr size_t MAX_RECORDS = 64; // One bit per record in the index
+
+        TransactionBlock() = default;
+        TransactionBlock(const TransactionImage *transactions, size_t count);
+
+        void Decode(std::vector<TransactionImage> &out) const;
+        void DecodeSelected(u64 selection, std::vector<TransactionImage> &out) const;
+        bool Find(i32 transaction_id, TransactionImage &out) const;
+        inline u64 GetTypeBits(TransactionType type) const { return m_type_bits[static_cast<size_t>(type)]; }
+        inline u64 GetInvalidBits() const { return m_invalid_bits; }
+        inline u64 GetAllBits() const { return m_count == MAX_RECORDS ? ~u64{0} : (u64{1} << m_count) - 1; }
+        inline f64 GetMinAmount() const { return m_min_amount; }
+        inline f64 GetMaxAmount() const { return m_max_amount; }
+        inline size_t size() const { return m_count; }
+        inline size_t GetBytes() const { return m_size; }
+    };
+}
@@ -0,0 +1,186 @@
+#pragma once
+
+#include "bank.hpp"
+#include "account_id.hpp"
+#include "thread_pool.hpp"
+#include "transaction_type.hpp"
+#include "types.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <exception>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace Bank
+{
+    enum class PipelineStage
+    {
+        PARSE,
+        VALIDATE,
+        ROUTE,
+        APPLY,
+        JOURNAL,
+        ACKNOWLEDGE
+    };
+
+    constexpr size_t PIPELINE_STAGES = 6;
+
+    enum class FeedOutcome
+    {
+        APPLIED,   // Executed (possibly declined by the account, like any other transaction)
+        DUPLICATE, // Its request key was already submitted
+        REJECTED   // Malformed, out of range, or naming an account that does not exist
+    };
+
+    /**
+     * @brief One feed line on its way through the pipeline, filled in stage by stage.
+     */
+    struct FeedRequest
+    {
+        size_t ticket = 0; // Position in the feed; requests are applied in this order
+        size_t line_number = 0;
+        std::string line;
+
+        std::string key;
+        i32 bank_id = 0;
+        i32 customer_id = 0;
+        AccountID account_id;
+        AccountID destination_account_id;
+        TransactionType transaction_type = TransactionType::DEPOSIT;
+        f64 amount = 0.0;
+
+        FeedOutcome outcome = FeedOutcome::REJECTED;
+        i32 transaction_id = 0;
+        bool declined = false;
+    };
+
+    /**
+     * @brief The outcome of running a feed through the pipeline.
+     */
+    struct PipelineReport
+    {
+        size_t applied = 0;
+        size_t duplicates = 0;
+        size_t rejected = 0;
+        size_t peak_in_flight = 0;
+        std::vector<size_t> rejected_lines; // In feed order
+        std::array<f64, PIPELINE_STAGES> stage_seconds{}; // Time spent in each stage, summed over requests
+        f64 elapsed_seconds = 0.0;
+    };
+
+    /**
+     * @brief A fire-and-forget coroutine: it runs as soon as it is called and frees itself when it returns.
+     *
+     * Completion is signalled by the coroutine itself (see TransactionPipeline::Acknowledge).
+     */
+    struct PipelineTask
+    {
+        struct promise_type
+        {
+            PipelineTask get_return_object() noexcept { return {}; }
+            std::suspend_never initial_suspend() noexcept { return {}; }
+            std::suspend_never final_suspend() noexcept { return {}; }
+            void return_void() noexcept {}
+            void unhandled_exception() noexcept { std::terminate(); }
+        };
+    };
+
+    /**
+     * @brief Awaiting this moves the coroutine onto one of a pool's worker threads.
+     */
+    struct ResumeOn
+    {
+        ThreadPool &pool;
+
+        inline bool await_ready() const noexcept { return false; }
+        inline void await_suspend(std::coroutine_handle<> handle) { pool.Post([handle]() { handle.resume(); }); }
+        inline void await_resume() const noexcept {}
+    };
+
+    /**
+     * @brief Lets coroutines through a critical section one at a time, strictly in ticket order.
+     *
+     * A coroutine that arrives before its turn is parked rather than blocking its thread, and is resumed
+     * on the pool once every earlier ticket has called EndTurn. Tickets must be handed out consecutively
+     * from zero, and at most window of them may be waiting at once.
+     */
+    class Sequencer
+    {
+    private:
+        ThreadPool &m_pool;
+        std::mutex m_mutex;
+        size_t m_next = 0;
+        std::vector<std::coroutine_handle<>> m_waiting; // Indexed by ticket modulo the window
+
+    public:
+        Sequencer(ThreadPool &pool, size_t window) : m_pool(pool), m_waiting(window) {}
+
+        struct Turn
+        {
+            Sequencer &sequencer;
+            size_t ticket;
+
+            inline bool await_ready() const noexcept { return false; }
+            bool await_suspend(std::coroutine_handle<> handle);
+            inline void await_resume() const noexcept {}
+        };
+
+        inline Turn WaitForTurn(size_t ticket) { return {*this, ticket}; }
+        void EndTurn();
+    };
+
+    /**
+     * @brief Runs submitted transactions as coroutines through parse, validate, route, apply, journal and acknowledge.
+     *
+     * Each request is a coroutine that suspends between stages instead of holding a thread, so many
+     * requests are in flight on a few PIPELINE_THREADS. Parsing, validation and journaling run in
+     * parallel; the bank graph is only touched in the apply stage, which the route stage enters one
+     * request at a time in feed order, so the result is the same as applying the feed line by line.
+     * While one request is being applied, others are parsed and journaled. At most
+     * PIPELINE_MAX_IN_FLIGHT requests are in flight; Submit waits for a slot.
+     */
+    class TransactionPipeline
+    {
+    private:
+        std::vector<std::unique_ptr<Bank>> &m_banks;
+        ThreadPool &m_executor;
+        Sequencer m_sequencer;
+
+        std::ofstream m_journal;
+        std::mutex m_journal_mutex;
+
+        std::mutex m_mutex;
+        std::condition_variable m_slot_free;
+        size_t m_submitted = 0;
+        size_t m_in_flight = 0;
+        PipelineReport m_report;
+        std::array<std::atomic<u64>, PIPELINE_STAGES> m_stage_nanoseconds{};
+        std::chrono::steady_clock::time_point m_start;
+
+        PipelineTask Run(std::unique_ptr<FeedRequest> request);
+        std::chrono::steady_clock::time_point EndStage(PipelineStage stage, std::chrono::steady_clock::time_point start);
+        bool Validate(FeedRequest &request) const;
+        void Apply(FeedRequest &request);
+        void Journal(const FeedRequest &request);
+        void Acknowledge(const FeedRequest &request);
+
+    public:
+        TransactionPipeline(std::vector<std::unique_ptr<Bank>> &banks, const std::string &journal_path);
+        TransactionPipeline(const TransactionPipeline &) = delete;
+        TransactionPipeline &operator=(const TransactionPipeline &) = delete;
+
+        static ThreadPool &Executor();
+
+        void Submit(size_t line_number, std::string line);
+        PipelineReport Finish();
+    };
+
+    std::string PipelineStageToString(PipelineStage stage);
+}
@@ -8,4 +8,6 @@ namespace Bank
         WITHDRAW,
         TRANSFER
     };
+
+    constexpr unsigned TRANSACTION_TYPES = 3;
 }
\ No newline at end of file
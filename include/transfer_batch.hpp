@@ -0,0 +1,41 @@
+#pragma once
+
+#include "customer.hpp"
+#include "account_id.hpp"
+#include "types.hpp"
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace Bank
+{
+    /**
+     * @brief One movement of money in a transfer batch.
+     */
+    struct TransferLeg
+    {
+        AccountID source;
+        AccountID destination;
+        f64 amount = 0.0;
+    };
+
+    /**
+     * @brief The outcome of a transfer batch, which is either applied in full or not at all.
+     */
+    struct TransferBatchReport
+    {
+        size_t legs = 0;     // Legs in the batch
+        size_t accounts = 0; // Distinct accounts the batch touches
+        f64 total = 0.0;     // Sum of the leg amounts
+        bool committed = false;
+        size_t failed_leg = 0; // 1-based line (for a file) or leg number that made the batch fail; 0 if none
+        std::string reason;    // Why the batch was not committed
+        size_t unreversed = 0; // Legs that stayed applied because undoing a failed batch failed too
+        f64 validate_seconds = 0.0;
+        f64 apply_seconds = 0.0;
+    };
+
+    TransferBatchReport ApplyTransferBatch(Customer &customer, const std::vector<TransferLeg> &legs);
+    TransferBatchReport ImportTransferBatch(Customer &customer, const std::string &path);
+    void PrintTransferBatchReport(const TransferBatchReport &report, std::ostream &os);
+}
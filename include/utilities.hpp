@@ -7,6 +7,7 @@
 #include "bank.hpp"
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <memory>
 #include <regex>
@@ -88,7 +89,8 @@ public:
 
 Bank::Bank *FindBank(const std::vector<std::unique_ptr<Bank::Bank>> &banks, i32 bank_id);
 Bank::Customer *FindCustomer(const Bank::Bank *const bank, i32 customer_id);
-Bank::BankAccount *FindAccount(const Bank::Customer *const customer, const std::string &account_id);
+Bank::BankAccount *FindAccount(const Bank::Customer *const customer, Bank::AccountID account_id);
+Bank::BankAccount *FindAccount(const Bank::Customer *const customer, std::string_view account_id);
 
 Bank::Bank *SelectBank(const std::vector<std::unique_ptr<Bank::Bank>> &banks);
 Bank::Customer *SelectCustomer(const Bank::Bank *bank);
@@ -115,5 +117,25 @@ void SearchForAccount(std::vector<std::unique_ptr<Bank::Bank>> &banks);
 void SearchForTransaction(std::vector<std::unique_ptr<Bank::Bank>> &banks);
 
 void ApplyInterest(const std::vector<std::unique_ptr<Bank::Bank>> &banks);
+void AuditAllAccounts(const std::vector<std::unique_ptr<Bank::Bank>> &banks);
+
+void ScheduleStandingOrder(std::vector<std::unique_ptr<Bank::Bank>> &banks);
+void ViewStandingOrders();
+void CancelStandingOrder();
+void AdvanceClock();
+void RunEndOfDay(const std::vector<std::unique_ptr<Bank::Bank>> &banks);
+void SubmitTransactionFeed(std::vector<std::unique_ptr<Bank::Bank>> &banks);
+void ConfigureVelocityLimits(std::vector<std::unique_ptr<Bank::Bank>> &banks);
+void BulkLoadCustomers(std::vector<std::unique_ptr<Bank::Bank>> &banks);
+void ReportMemoryUsage(const std::vector<std::unique_ptr<Bank::Bank>> &banks);
+void ArchiveOldTransactions(std::vector<std::unique_ptr<Bank::Bank>> &banks);
+void BatchTransfer(std::vector<std::unique_ptr<Bank::Bank>> &banks);
+void QueryTransactions(const std::vector<std::unique_ptr<Bank::Bank>> &banks);
+void RankBalances(const std::vector<std::unique_ptr<Bank::Bank>> &banks);
+void PrintBalanceRanking(const std::vector<Bank::BankAccount *> &accounts);
+void SaveBankCheckpoint(const std::vector<std::unique_ptr<Bank::Bank>> &banks);
+bool CollectCheckpoint(bool wait);
 
 void WriteToFile(const std::vector<std::unique_ptr<Bank::Bank>> &banks);
+void WriteBankRecord(std::ostream &os, const Bank::Bank &bank);
+void WriteCustomerRecord(std::ostream &os, const Bank::Customer &customer);
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "types.hpp"
+#include <array>
+#include <cstddef>
+#include <string>
+
+namespace Bank
+{
+    /**
+     * @brief A running total over the last Buckets * BucketSeconds seconds, kept in fixed time buckets.
+     *
+     * Adding and reading are O(1): the total is maintained incrementally, and moving the window forward
+     * only clears the buckets that fell out of it (at most Buckets of them, however long the gap).
+     * Expiry is exact to one bucket.
+     *
+     * @tparam Buckets The number of buckets in the window.
+     * @tparam BucketSeconds The span of each bucket in (simulated) seconds.
+     */
+    template <size_t Buckets, i64 BucketSeconds>
+    class SlidingWindow
+    {
+    private:
+        std::array<i64, Buckets> m_buckets{};
+        i64 m_total = 0;
+        i64 m_newest = 0; // Index (time / BucketSeconds) of the newest bucket
+
+        /**
+         * @brief Drops the buckets that are older than the window ending at now.
+         */
+        void Advance(i64 now)
+        {
+            const i64 bucket = now / BucketSeconds;
+            if (bucket - m_newest >= static_cast<i64>(Buckets))
+            {
+                m_buckets.fill(0);
+                m_total = 0;
+                m_newest = bucket;
+                return;
+            }
+
+            while (m_newest < bucket)
+            {
+                m_newest++;
+                i64 &expired = m_buckets[static_cast<size_t>(m_newest) % Buckets];
+                m_total -= expired;
+                expired = 0;
+            }
+        }
+
+    public:
+        /**
+         * @brief Returns the sum of everything added within the window ending at now.
+         */
+        i64 Total(i64 now)
+        {
+            Advance(now);
+            return m_total;
+        }
+
+        /**
+         * @brief Adds a value at time now.
+         */
+        void Add(i64 now, i64 value)
+        {
+            Advance(now);
+            m_buckets[static_cast<size_t>(m_newest) % Buckets] += value;
+            m_total += value;
+        }
+    };
+
+    /**
+     * @brief Configurable limits on money leaving an account or a customer. Zero means unlimited.
+     */
+    struct VelocityLimits
+    {
+        i32 max_withdrawals_per_hour = 0; // Withdrawals and outgoing transfers
+        f64 max_amount_per_day = 0.0;     // Total withdrawn or transferred out
+
+        inline bool IsUnlimited() const { return max_withdrawals_per_hour == 0 && max_amount_per_day == 0.0; }
+    };
+
+    /**
+     * @brief Tracks recent withdrawals against a set of VelocityLimits.
+     *
+     * The hourly count uses one-minute buckets and the daily amount one-hour buckets, so a check is a
+     * couple of additions instead of a scan of the transaction history.
+     */
+    class VelocityTracker
+    {
+    private:
+        VelocityLimits m_limits;
+        SlidingWindow<60, 60> m_withdrawals_per_hour;
+        SlidingWindow<24, 3'600> m_cents_per_day; // Amounts in whole cents, so the running total never drifts
+
+    public:
+        explicit VelocityTracker(const VelocityLimits &limits);
+
+        inline const VelocityLimits &GetLimits() const { return m_limits; }
+        inline void SetLimits(const VelocityLimits &limits) { m_limits = limits; }
+
+        bool Allows(f64 amount, i64 now, std::string &reason);
+        void Record(f64 amount, i64 now);
+    };
+}
@@ -0,0 +1,248 @@
+/**
+ * @file audit.cpp
+ * @brief This file implements the ledger audit, which verifies that every account's transaction history
+ *        reconciles with its balance and that transfers between accounts conserve money.
+ */
+
+#include "../include/audit.hpp"
+#include "../include/bank_account.hpp"
+#include "../include/customer.hpp"
+#include "../include/global.hpp"
+#include "../include/thread_pool.hpp"
+#include "../include/trace.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace Bank
+{
+    namespace
+    {
+        /**
+         * @brief Returns true if two monetary amounts agree to within AUDIT_TOLERANCE.
+         */
+        bool AmountsMatch(f64 a, f64 b)
+        {
+            return std::fabs(a - b) <= AUDIT_TOLERANCE;
+        }
+
+        /**
+         * @brief Formats a monetary amount with two decimals for use in a discrepancy message.
+         */
+        std::string Money(f64 amount)
+        {
+            std::ostringstream oss;
+            oss << '$' << std::fixed << std::setprecision(2) << amount;
+            return oss.str();
+        }
+
+        /**
+         * @brief Checks one account's balance chain and records any violations.
+         * @param bank_id The ID of the Bank owning the account (for reporting).
+         * @param account The account to audit.
+         * @param out Receives the discrepancies found.
+         * @return The total amount this account successfully transferred out.
+         */
+        f64 AuditAccount(i32 bank_id, const BankAccount &account, std::vector<AuditDiscrepancy> &out)
+        {
+            const i32 customer_id = account.GetAccountOwner().GetID();
+            auto report = [&](i32 transaction_id, std::string message)
+            {
+                out.push_back({bank_id, customer_id, account.GetID(), transaction_id, std::move(message)});
+            };
+
+            // Live transactions are stored by random ID, so this restores their chronological order
+            std::vector<TransactionImage> history;
+            account.GetResidentHistory(history);
+
+            // Archived history is covered by its checkpoint, so the chain carries on from where it ends
+            const ArchivedHistory *archived = account.GetArchivedHistory().get();
+            f64 previous_after = archived ? archived->balance_after : account.GetOpeningBalance();
+            f64 net_change = archived ? archived->net_change : 0.0;
+            f64 transferred_out = archived ? archived->transferred_out : 0.0;
+
+            // End-of-day fees are the only thing allowed to lower the balance between two transactions
+            f64 unexplained_drop = archived ? archived->balance_drops : 0.0;
+            const f64 fees_assessed = account.GetFeesAssessed();
+
+            for (const TransactionImage &transaction : history)
+            {
+                const i32 id = transaction.transaction_id;
+                const f64 before = transaction.balance_before;
+                const f64 after = transaction.balance_after;
+                const f64 amount = transaction.amount;
+
+                // Between two transactions, the balance may only fall by end-of-day fees
+                if (before < previous_after)
+                {
+                    unexplained_drop += previous_after - before;
+                    if (unexplained_drop > fees_assessed + AUDIT_TOLERANCE)
+                    {
+                        report(id, "Balance chain broken: previous transaction left " + Money(previous_after) +
+                                       " but this one started from " + Money(before));
+                    }
+                }
+
+                if (transaction.was_invalid)
+                {
+                    if (!AmountsMatch(before, after))
+                        report(id, "Invalid transaction changed the balance from " + Money(before) + " to " + Money(after));
+                }
+                else
+                {
+                    switch (transaction.transaction_type)
+                    {
+                    case TransactionType::DEPOSIT:
+                        if (!AmountsMatch(after - before, amount))
+                            report(id, "Deposit of " + Money(amount) + " changed the balance by " + Money(after - before));
+                        break;
+                    case TransactionType::WITHDRAW:
+                        // A checking withdrawal that overdraws also carries the overdraft fee
+                        if (!AmountsMatch(before - after, amount) &&
+                            !(after < 0 && AmountsMatch(before - after, amount + OVERDRAFT_FEE)))
+                            report(id, "Withdrawal of " + Money(amount) + " changed the balance by " + Money(after - before));
+                        break;
+                    case TransactionType::TRANSFER:
+                        if (!AmountsMatch(before - after, amount))
+                            report(id, "Transfer of " + Money(amount) + " changed the balance by " + Money(after - before));
+                        transferred_out += amount;
+                        break;
+                    }
+                }
+
+                net_change += after - before;
+                previous_after = after;
+            }
+
+            if (account.GetBalance() < previous_after - fees_assessed - AUDIT_TOLERANCE)
+            {
+                report(0, "Balance " + Money(account.GetBalance()) + " is below the last recorded transaction balance " +
+                              Money(previous_after));
+            }
+
+            // Opening balance plus every recorded movement must reproduce the live balance
+            const f64 expected = account.GetOpeningBalance() + net_change +
+                                 account.GetInterestPosted() + account.GetTransfersReceived() - fees_assessed;
+            if (!AmountsMatch(expected, account.GetBalance()))
+            {
+                report(0, "Ledger does not reconcile: history implies " + Money(expected) +
+                              " but the balance is " + Money(account.GetBalance()));
+            }
+
+            return transferred_out;
+        }
+    }
+
+    /**
+     * @brief Audits every account of one customer and checks that transfers between them conserve money.
+     * @param bank_id The ID of the Bank owning the customer (for reporting).
+     * @param customer The customer to audit.
+     * @param out Receives the discrepancies found.
+     * @return The number of transactions checked.
+     */
+    size_t AuditCustomer(i32 bank_id, const Customer &customer, std::vector<AuditDiscrepancy> &out)
+    {
+        f64 sent = 0.0;
+        f64 received = 0.0;
+        size_t transactions = 0;
+
+        for (const BankAccount &account : customer.GetAccounts())
+        {
+            sent += AuditAccount(bank_id, account, out);
+            received += account.GetTransfersReceived();
+            // Archived transactions are covered by their checkpoint rather than checked again
+            const auto &archived = account.GetArchivedHistory();
+            transactions += account.GetNumberOfTransactions() - (archived ? archived->transaction_count : 0);
+        }
+
+        if (!AmountsMatch(sent, received))
+        {
+            out.push_back({bank_id, customer.GetID(), AccountID(), 0,
+                           "Transfers do not conserve money: " + Money(sent) + " sent but " +
+                               Money(received) + " received"});
+        }
+        return transactions;
+    }
+
+    /**
+     * @brief Audits every account of every bank in parallel using the shared ThreadPool.
+     *
+     * For each account the transaction history is replayed in chronological order and checked against
+     * the opening balance, interest, incoming transfers and end-of-day fees. For each customer, money
+     * transferred out of their accounts must equal money received by their accounts.
+     *
+     * @param banks A const reference to a vector of unique_ptr to Bank objects.
+     * @return An AuditReport listing every discrepancy found, in bank/customer order.
+     */
+    AuditReport AuditLedger(const std::vector<std::unique_ptr<Bank>> &banks)
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        // Customers are the unit of work, since transfers never leave a customer's accounts
+        std::vector<std::pair<i32, const Customer *>> work;
+        for (const auto &bank : banks)
+        {
+            for (const Customer &customer : bank->GetCustomers())
+                work.emplace_back(bank->GetID(), &customer);
+        }
+
+        std::vector<std::vector<AuditDiscrepancy>> findings(work.size());
+        std::vector<size_t> transaction_counts(work.size(), 0);
+
+        ThreadPool::Shared().ParallelFor(work.size(), [&](size_t begin, size_t end)
+                                         {
+            TraceSpan span("AuditCustomers");
+            for (size_t i = begin; i < end; i++)
+                transaction_counts[i] = AuditCustomer(work[i].first, *work[i].second, findings[i]); }, 16);
+
+        AuditReport report;
+        for (size_t i = 0; i < work.size(); i++)
+        {
+            report.accounts_checked += work[i].second->GetAccounts().size();
+            report.transactions_checked += transaction_counts[i];
+            for (auto &discrepancy : findings[i])
+                report.discrepancies.push_back(std::move(discrepancy));
+        }
+
+        report.elapsed_seconds = std::chrono::duration<f64>(std::chrono::steady_clock::now() - start).count();
+        return report;
+    }
+
+    /**
+     * @brief Prints one discrepancy as a single line prefixed with its location.
+     * @param d The discrepancy to print.
+     * @param os The stream to print to.
+     */
+    void PrintAuditDiscrepancy(const AuditDiscrepancy &d, std::ostream &os)
+    {
+        os << "Bank " << d.bank_id << " > Customer " << d.customer_id;
+        if (d.account_id.IsValid())
+            os << " > Account " << d.account_id;
+        if (d.transaction_id != 0)
+            os << " > Transaction " << d.transaction_id;
+        os << ": " << d.message << "\n";
+    }
+
+    /**
+     * @brief Prints a human-readable summary of an AuditReport, one line per discrepancy.
+     * @param report The report to print.
+     * @param os The stream to print to.
+     */
+    void PrintAuditReport(const AuditReport &report, std::ostream &os)
+    {
+        for (const auto &discrepancy : report.discrepancies)
+            PrintAuditDiscrepancy(discrepancy, os);
+
+        const std::ios::fmtflags flags = os.flags();
+        const std::streamsize precision = os.precision();
+        os << "Audited " << report.accounts_checked << " account(s) and "
+           << report.transactions_checked << " transaction(s) in "
+           << std::fixed << std::setprecision(3) << report.elapsed_seconds << "s: "
+           << report.discrepancies.size() << " discrepancy(ies) found.\n";
+        os.flags(flags);
+        os.precision(precision);
+    }
+}
@@ -0,0 +1,268 @@
+/**
+ * @file balance_index.cpp
+ * @brief This file implements the per-bank index of accounts ordered by balance, and the system-wide
+ *        top-K, range and rank queries built on it.
+ */
+
+#include "../include/balance_index.hpp"
+#include "../include/bank.hpp"
+#include "../include/bank_account.hpp"
+#include "../include/global.hpp"
+#include "../include/memory_report.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Bank
+{
+    namespace
+    {
+        constexpr u64 LAST_ACCOUNT = std::numeric_limits<u64>::max(); // Above every account ID's value
+        constexpr f64 SAVING_ORDER_SLACK = 1e-9; // Allowance for rounding when a bound is discounted
+
+        bool ByBalanceDescending(const BankAccount *a, const BankAccount *b)
+        {
+            return a->GetBalance() > b->GetBalance();
+        }
+    }
+
+    /**
+     * @brief Returns the order of a saving account: its balance discounted back to interest period 0, as a logarithm.
+     *
+     * Each rollover multiplies every saving balance by the same factor, which leaves this unchanged.
+     */
+    f64 BalanceIndex::SavingOrder(f64 balance, u64 period) const
+    {
+        if (balance <= 0.0)
+            return -std::numeric_limits<f64>::infinity();
+        return std::log(balance) - static_cast<f64>(period) * std::log1p(INTEREST_RATE);
+    }
+
+    /**
+     * @brief Returns the balance a saving account of the given order has as of the bank's current period.
+     */
+    f64 BalanceIndex::SavingBalance(f64 order) const
+    {
+        return std::exp(order + static_cast<f64>(m_interest_period) * std::log1p(INTEREST_RATE));
+    }
+
+    BalanceIndex::Key BalanceIndex::MakeKey(const BankAccount &account) const
+    {
+        // The stored balance as of the account's own period, so that nothing is settled here
+        const f64 order = account.GetAccountType() == AccountType::SAVING
+                              ? SavingOrder(account.m_balance, account.m_interest_period)
+                              : account.m_balance;
+        return {order, account.GetID().GetValue()};
+    }
+
+    /**
+     * @brief Adds a newly opened account.
+     * @param account The account, which must not be in the index yet.
+     */
+    void BalanceIndex::Insert(BankAccount &account)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const Key key = MakeKey(account);
+        account.m_balance_order = key.order;
+        (account.GetAccountType() == AccountType::SAVING ? m_saving : m_checking).Insert(key, &account);
+    }
+
+    /**
+     * @brief Moves an account to its place for its current balance. O(log n).
+     * @param account The account whose balance changed.
+     */
+    void BalanceIndex::Update(BankAccount &account)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const Key key = MakeKey(account);
+        if (key.order == account.m_balance_order)
+            return;
+
+        auto &tree = account.GetAccountType() == AccountType::SAVING ? m_saving : m_checking;
+        tree.Erase({account.m_balance_order, key.account});
+        tree.Insert(key, &account);
+        account.m_balance_order = key.order;
+    }
+
+    /**
+     * @brief Returns the number of accounts in the index.
+     */
+    size_t BalanceIndex::size() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_checking.size() + m_saving.size();
+    }
+
+    /**
+     * @brief Counts the checking accounts with a balance above the given one. The caller holds the lock.
+     */
+    size_t BalanceIndex::CheckingAbove(f64 balance) const
+    {
+        return m_checking.size() - m_checking.Rank({balance, LAST_ACCOUNT});
+    }
+
+    /**
+     * @brief Counts the saving accounts with a balance above the given one. The caller holds the lock.
+     *
+     * Lazy settlement never reindexes, so a stored order and one recomputed from a settled balance may
+     * differ by a rounding error; the accounts that close to the order are checked against their settled
+     * balance, as in Range.
+     *
+     * @param balance The balance to compare against.
+     * @param order Its saving order.
+     */
+    size_t BalanceIndex::SavingAbove(f64 balance, f64 order) const
+    {
+        const size_t first = m_saving.Rank({order - SAVING_ORDER_SLACK, 0});
+        const size_t end = m_saving.Rank({order + SAVING_ORDER_SLACK, LAST_ACCOUNT});
+        size_t count = m_saving.size() - end;
+        for (size_t i = first; i < end; i++)
+        {
+            if (m_saving.Select(i).second->GetBalance() > balance)
+                count++;
+        }
+        return count;
+    }
+
+    /**
+     * @brief Counts the accounts with a balance above the given one. O(log n), plus O(log n) per saving account
+     *        within a rounding error of it.
+     * @param balance The balance to compare against.
+     * @return The number of accounts whose balance is strictly greater.
+     */
+    size_t BalanceIndex::CountAbove(f64 balance) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return CheckingAbove(balance) + SavingAbove(balance, SavingOrder(balance, m_interest_period));
+    }
+
+    /**
+     * @brief Counts the accounts ranked above one of this index's accounts, in the same time as CountAbove(f64).
+     *
+     * Among its own kind the account is looked up by its stored key, and saving accounts within a rounding
+     * error of it by their settled balance, so that it is never counted as above itself.
+     *
+     * @param account The account, which must be in this index.
+     * @return The number of accounts whose balance is strictly greater (so the account's rank is this plus one).
+     */
+    size_t BalanceIndex::CountAbove(const BankAccount &account) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const f64 balance = account.GetBalance();
+        if (account.GetAccountType() == AccountType::SAVING)
+            return SavingAbove(balance, account.m_balance_order) + CheckingAbove(balance);
+        return m_checking.size() - m_checking.Rank({account.m_balance_order, LAST_ACCOUNT}) +
+               SavingAbove(balance, SavingOrder(balance, m_interest_period));
+    }
+
+    /**
+     * @brief Appends the accounts with the largest balances, largest first. O(count log n).
+     * @param count The most accounts to return.
+     * @param out The vector to append them to.
+     */
+    void BalanceIndex::Top(size_t count, std::vector<BankAccount *> &out) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        size_t checking = m_checking.size();
+        size_t saving = m_saving.size();
+        for (; count > 0 && (checking > 0 || saving > 0); count--)
+        {
+            // Walk both trees down from their largest key, taking the larger balance each time
+            const bool take_checking =
+                saving == 0 || (checking > 0 && m_checking.Select(checking - 1).first.order >=
+                                                    SavingBalance(m_saving.Select(saving - 1).first.order));
+            out.push_back(take_checking ? m_checking.Select(--checking).second : m_saving.Select(--saving).second);
+        }
+    }
+
+    /**
+     * @brief Appends the accounts whose balance is within a range, smallest first. O(log n) plus O(log n) per account found.
+     * @param min_balance The smallest balance to include.
+     * @param max_balance The largest balance to include.
+     * @param out The vector to append them to.
+     */
+    void BalanceIndex::Range(f64 min_balance, f64 max_balance, std::vector<BankAccount *> &out) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const size_t first = out.size();
+        for (size_t i = m_checking.Rank({min_balance, 0}), end = m_checking.Rank({max_balance, LAST_ACCOUNT}); i < end; i++)
+            out.push_back(m_checking.Select(i).second);
+
+        // Discounting a bound may round either way, so widen it a little and check the candidates exactly
+        const f64 low = SavingOrder(min_balance, m_interest_period) - SAVING_ORDER_SLACK;
+        const f64 high = SavingOrder(max_balance, m_interest_period) + SAVING_ORDER_SLACK;
+        for (size_t i = m_saving.Rank({low, 0}), end = m_saving.Rank({high, LAST_ACCOUNT}); i < end; i++)
+        {
+            BankAccount *account = m_saving.Select(i).second;
+            const f64 balance = account->GetBalance();
+            if (balance >= min_balance && balance <= max_balance)
+                out.push_back(account);
+        }
+
+        std::sort(out.begin() + static_cast<std::ptrdiff_t>(first), out.end(), [](const BankAccount *a, const BankAccount *b)
+                  { return a->GetBalance() < b->GetBalance(); });
+    }
+
+    /**
+     * @brief Adds the index's nodes to a memory breakdown.
+     * @param usage The category to add to.
+     */
+    void BalanceIndex::MeasureMemory(MemoryUsage &usage) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        usage.Add(0, m_checking.GetUsedBytes(), m_checking.GetReservedBytes());
+        usage.Add(0, m_saving.GetUsedBytes(), m_saving.GetReservedBytes());
+    }
+
+    /**
+     * @brief Returns the accounts with the largest balances across every bank, largest first.
+     * @param banks The banks to search.
+     * @param count The most accounts to return.
+     */
+    std::vector<BankAccount *> TopBalances(const std::vector<std::unique_ptr<Bank>> &banks, size_t count)
+    {
+        // The overall top count are among each bank's top count
+        std::vector<BankAccount *> accounts;
+        for (const auto &bank : banks)
+            bank->GetBalanceIndex().Top(count, accounts);
+
+        count = std::min(count, accounts.size());
+        std::partial_sort(accounts.begin(), accounts.begin() + static_cast<std::ptrdiff_t>(count), accounts.end(), ByBalanceDescending);
+        accounts.resize(count);
+        return accounts;
+    }
+
+    /**
+     * @brief Returns the accounts across every bank whose balance is within a range, smallest first.
+     * @param banks The banks to search.
+     * @param min_balance The smallest balance to include.
+     * @param max_balance The largest balance to include.
+     */
+    std::vector<BankAccount *> BalancesInRange(const std::vector<std::unique_ptr<Bank>> &banks, f64 min_balance, f64 max_balance)
+    {
+        std::vector<BankAccount *> accounts;
+        for (const auto &bank : banks)
+            bank->GetBalanceIndex().Range(min_balance, max_balance, accounts);
+
+        std::stable_sort(accounts.begin(), accounts.end(), [](const BankAccount *a, const BankAccount *b)
+                         { return a->GetBalance() < b->GetBalance(); });
+        return accounts;
+    }
+
+    /**
+     * @brief Counts the accounts across every bank ranked above the given one.
+     * @param banks The banks to search.
+     * @param account The account to compare against.
+     */
+    size_t CountBalancesAbove(const std::vector<std::unique_ptr<Bank>> &banks, const BankAccount &account)
+    {
+        const f64 balance = account.GetBalance();
+        size_t count = 0;
+        for (const auto &bank : banks)
+        {
+            const BalanceIndex &index = bank->GetBalanceIndex();
+            count += &account.GetBank() == bank.get() ? index.CountAbove(account) : index.CountAbove(balance);
+        }
+        return count;
+    }
+}
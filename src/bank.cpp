@@ -4,11 +4,16 @@
  */
 
 #include "../include/bank.hpp"
+#include "../include/activity_log.hpp"
 #include "../include/bank_account.hpp"
 #include "../include/global.hpp"
+#include "../include/snapshot.hpp"
+#include "../include/replication.hpp"
+#include "../include/string_pool.hpp"
+#include "../include/memory_report.hpp"
+#include "../include/trace.hpp"
 #include <random>
 #include <exception>
-#include <algorithm>
 #include <iostream>
 
 namespace Bank
@@ -22,10 +27,21 @@ namespace Bank
      * @brief Constructs a Bank with a given name and generates a random ID.
      * @param bank_name The name of the Bank.
      */
-    Bank::Bank(const std::string &bank_name) : m_bank_name(bank_name)
+    Bank::Bank(const std::string &bank_name) : m_bank_name(StringPool::Shared().Intern(bank_name))
     {
         GenerateID();
-        std::cout << "Bank created: " << m_bank_name << " (Bank ID: " << m_bank_id << ")" << std::endl;
+        ActivityLog() << "Bank created: " << m_bank_name << " (Bank ID: " << m_bank_id << ")" << std::endl;
+    }
+
+    /**
+     * @brief Constructs a Bank with a given name and an ID chosen by the caller (e.g. a shard coordinator).
+     * @param bank_name The name of the Bank.
+     * @param bank_id The ID to assign, in the range [MIN_BANK_ID, MAX_BANK_ID].
+     */
+    Bank::Bank(const std::string &bank_name, i32 bank_id)
+        : m_bank_id(bank_id), m_bank_name(StringPool::Shared().Intern(bank_name))
+    {
+        ActivityLog() << "Bank created: " << m_bank_name << " (Bank ID: " << m_bank_id << ")" << std::endl;
     }
 
     /**
@@ -34,7 +50,7 @@ namespace Bank
     Bank::~Bank()
     {
         // Let the user know when a Bank object is being destroyed
-        std::cout << "\nDeleting bank" << std::endl;
+        ActivityLog() << "\nDeleting bank" << std::endl;
     }
 
     /**
@@ -47,31 +63,155 @@ namespace Bank
     }
 
     /**
-     * @brief Creates and adds a new Customer to this Bank in sorted order by ID.
+     * @brief Creates and adds a new Customer to this Bank, indexed by ID.
      * @param fname Customer's first name.
      * @param lname Customer's last name.
      * @param age Customer's age.
+     * @param customer_id The ID to assign, or 0 to generate a random one.
+     * @return A reference to the newly created Customer.
+     */
+    Customer &Bank::AddCustomer(const std::string &fname, const std::string &lname, i32 age, i32 customer_id)
+    {
+        // Construct the Customer in a free slot; nothing already stored moves
+        auto [handle, customer] = m_customers.Emplace(*this, fname, lname, age, customer_id);
+        customer.m_handle = handle;
+        m_customer_index.emplace(customer.GetID(), handle);
+
+        SnapshotManager::Shared().MarkDirty(*this);
+        ReplicationLog::Shared().LogCustomerAdded(customer);
+        return customer;
+    }
+
+    /**
+     * @brief Presizes storage and ID indexes so that adding this many more customers and accounts does not reallocate.
+     * @param customers The number of customers about to be added.
+     * @param accounts The number of accounts about to be opened.
+     */
+    void Bank::Reserve(size_t customers, size_t accounts)
+    {
+        m_customers.Reserve(m_customers.size() + customers);
+        m_accounts.Reserve(m_accounts.size() + accounts);
+        m_customer_index.reserve(m_customer_index.size() + customers);
+        m_account_index.reserve(m_account_index.size() + accounts);
+    }
+
+    /**
+     * @brief Creates a Checking or Saving account for a Customer of this Bank, indexed by ID.
+     * @param owner The Customer who will own the account.
+     * @param account_type The type of the account (CHECKING or SAVING).
+     * @param balance The initial balance of the account.
+     * @param account_id The ID to assign, or an invalid ID to generate a random one.
+     * @return A reference to the newly created BankAccount.
      */
-    void Bank::AddCustomer(const std::string &fname, const std::string &lname, i32 age)
+    BankAccount &Bank::OpenAccount(Customer &owner, AccountType account_type, f64 balance, AccountID account_id)
     {
-        // Ensure we have space in the customers vector
-        if (m_customers.capacity() == 0)
+        AccountHandle handle;
+        BankAccount *account;
+        if (account_type == AccountType::SAVING)
         {
-            m_customers.reserve(50);
+            auto [saving_handle, saving] = m_accounts.Emplace<SavingAccount>(owner, balance, account_id);
+            handle = saving_handle;
+            account = &saving;
+            m_saving_accounts++;
+        }
+        else
+        {
+            auto [checking_handle, checking] = m_accounts.Emplace<CheckingAccount>(owner, balance, account_id);
+            handle = checking_handle;
+            account = &checking;
         }
 
-        // Create a new Customer object on the heap
-        std::unique_ptr<Customer> new_customer = std::make_unique<Customer>(fname, lname, age);
+        account->m_handle = handle;
+        m_account_index.emplace(account->GetID(), handle);
+        m_balance_index.Insert(*account);
+        return *account;
+    }
 
-        // Insert the new Customer in sorted order by their ID
-        auto it = std::lower_bound(
-            m_customers.begin(), m_customers.end(), new_customer,
-            [](const std::unique_ptr<Customer> &a, const std::unique_ptr<Customer> &b)
+    /**
+     * @brief Looks up one of this Bank's customers by ID.
+     * @param customer_id The ID of the Customer to find.
+     * @return A pointer to the Customer if found, otherwise nullptr.
+     */
+    Customer *Bank::FindCustomer(i32 customer_id) const
+    {
+        auto it = m_customer_index.find(customer_id);
+        return it != m_customer_index.end() ? m_customers.Get(it->second) : nullptr;
+    }
+
+    /**
+     * @brief Looks up an account held at this Bank by ID, whichever Customer owns it.
+     * @param account_id The ID of the BankAccount to find.
+     * @return A pointer to the BankAccount if found, otherwise nullptr.
+     */
+    BankAccount *Bank::FindAccount(AccountID account_id) const
+    {
+        auto it = m_account_index.find(account_id);
+        return it != m_account_index.end() ? m_accounts.Get(it->second) : nullptr;
+    }
+
+    /**
+     * @brief Adds up the memory this Bank holds: its slot maps and indexes, then what each customer and account allocates.
+     *
+     * Each account's slot and allocations are also credited to it and to its owner, for the per-customer
+     * and per-account figures.
+     *
+     * @param memory The breakdown to fill in.
+     */
+    void Bank::MeasureMemory(BankMemory &memory) const
+    {
+        memory.bank_id = m_bank_id;
+        memory.bank_name = m_bank_name;
+        memory[MemoryCategory::CUSTOMERS].Add(m_customers.size(), m_customers.GetUsedBytes(), m_customers.GetReservedBytes());
+        memory[MemoryCategory::ACCOUNTS].Add(m_accounts.size(), m_accounts.GetUsedBytes(), m_accounts.GetReservedBytes());
+        MeasureIndex(m_customer_index, memory[MemoryCategory::INDEXES]);
+        MeasureIndex(m_account_index, memory[MemoryCategory::INDEXES]);
+        m_balance_index.MeasureMemory(memory[MemoryCategory::INDEXES]);
+
+        for (const Customer &customer : m_customers)
+        {
+            size_t customer_bytes = m_customers.GetSlotBytes() + customer.MeasureMemory(memory);
+            for (const BankAccount &account : customer.GetAccounts())
             {
-                return a->GetID() < b->GetID();
-            });
+                const size_t account_bytes = m_accounts.GetSlotBytes() + account.MeasureMemory(memory);
+                memory.AddAccount(account.GetID(), account_bytes);
+                customer_bytes += account_bytes;
+            }
+            memory.AddCustomer(customer.GetID(), customer_bytes);
+        }
+    }
 
-        m_customers.insert(it, std::move(new_customer));
+    /**
+     * @brief Prepares a newly created bank to receive the accounts of a checkpoint.
+     * @param checkpoint The checkpoint, opened for reading; kept open while any account's history is still in it.
+     * @param interest_period The bank's interest period when the checkpoint was saved.
+     */
+    void Bank::Restore(std::shared_ptr<const TransactionArchive> checkpoint, u64 interest_period)
+    {
+        m_checkpoint = std::move(checkpoint);
+        m_interest_period = interest_period;
+    }
+
+    /**
+     * @brief Moves every transaction executed at or before a point in time out of memory and into this bank's archive.
+     *
+     * Each account keeps only its newer transactions resident, plus a checkpoint of the archived ones
+     * (see BankAccount::ArchiveTransactions). Per-transaction deletion messages are discarded for the duration.
+     *
+     * @param cutoff The simulated time; transactions with a timestamp at or before it are archived.
+     * @return The number of transactions archived.
+     */
+    size_t Bank::ArchiveTransactions(i64 cutoff)
+    {
+        if (!m_archive)
+            m_archive = std::make_unique<TransactionArchive>(m_bank_id);
+        if (!m_archive->IsOpen())
+            return 0;
+
+        size_t archived = 0;
+        QuietScope quiet;
+        for (BankAccount &account : m_accounts)
+            archived += account.ArchiveTransactions(cutoff, *m_archive);
+        return archived;
     }
 
     /**
@@ -80,30 +220,27 @@ namespace Bank
     void Bank::ViewAllCustomers() const
     {
         // Print each customer's info, preceded by a header line
-        for (size_t i = 0; i < m_customers.size(); i++)
+        size_t i = 0;
+        for (const Customer &customer : m_customers)
         {
             std::cout << "---------------------------------" << std::endl;
-            std::cout << "Customer #" << i + 1 << std::endl;
-            m_customers[i]->DisplayCustomerInfo();
+            std::cout << "Customer #" << ++i << std::endl;
+            customer.DisplayCustomerInfo();
         }
         std::cout << "---------------------------------" << std::endl;
     }
 
     /**
      * @brief Applies interest to all SavingAccount objects in this Bank.
+     *
+     * This only starts a new interest period. Each SavingAccount compounds the periods it has missed
+     * the next time it is read or written, so the rollover itself is O(1) and idle accounts are never touched.
      */
     void Bank::ApplyInterestToAllAccounts()
     {
-        // For each customer, for each account, if it's a SavingAccount, apply interest
-        for (const auto &customer : m_customers)
-        {
-            for (const auto &account : customer->GetAccounts())
-            {
-                if (auto *saving_acc = dynamic_cast<SavingAccount *>(account.get()))
-                {
-                    saving_acc->ApplyInterest();
-                }
-            }
-        }
+        TraceSpan span("ApplyInterestToAllAccounts");
+        m_interest_period++;
+        SnapshotManager::Shared().MarkDirty(*this);
+        ReplicationLog::Shared().LogInterestRollover(*this);
     }
 }
@@ -1,26 +1,78 @@
 /**
  * @file bank_account.cpp
- * @brief Implements the BankAccount class hierarchy (CheckingAccount, SavingAccount),
+ * @brief Implements BankAccount and its two kinds (CheckingAccount, SavingAccount),
  *        including core functionality and transaction management.
  */
 
 #include "../include/bank_account.hpp"
+#include "../include/activity_log.hpp"
 #include "../include/transaction_type.hpp"
 #include "../include/utilities.hpp"
 #include "../include/transaction.hpp"
 #include "../include/global.hpp"
+#include "../include/bank.hpp"
+#include "../include/snapshot.hpp"
+#include "../include/replication.hpp"
+#include "../include/idempotency.hpp"
+#include "../include/memory_report.hpp"
+#include "../include/checkpoint.hpp"
+#include "../include/trace.hpp"
 #include <iostream>
 #include <cassert>
 #include <random>
 #include <iomanip>
 #include <memory>
 #include <algorithm>
+#include <array>
 
 namespace Bank
 {
+    namespace
+    {
+        constexpr u32 ID_DIGIT_BITS = 12; // Two digits cover every transaction ID
+        static_assert(MAX_TRANSACTION_ID < (1 << (2 * ID_DIGIT_BITS)));
+
+        /**
+         * @brief Sorts transactions by ID in linear time.
+         *
+         * IDs are random, so a history in the order it executed is nowhere near ID order, but they are
+         * bounded: two counting passes over ID_DIGIT_BITS digits sort it without comparing. The passes move
+         * (ID, position) keys rather than the transactions, which are then copied once, into place.
+         *
+         * @param transactions The transactions to sort.
+         */
+        void SortByID(std::vector<TransactionImage> &transactions)
+        {
+            constexpr u32 DIGITS = 1u << ID_DIGIT_BITS;
+            const size_t count = transactions.size();
+            std::vector<u64> keys(count), scratch(count);
+            u64 *from = keys.data(), *to = scratch.data();
+            for (size_t i = 0; i < count; i++)
+                from[i] = static_cast<u64>(transactions[i].transaction_id) << 32 | i;
+
+            for (u32 shift = 32; shift < 32 + 2 * ID_DIGIT_BITS; shift += ID_DIGIT_BITS)
+            {
+                std::array<size_t, DIGITS + 1> offsets{};
+                for (size_t i = 0; i < count; i++)
+                    offsets[(from[i] >> shift & (DIGITS - 1)) + 1]++;
+                for (u32 digit = 0; digit < DIGITS; digit++)
+                    offsets[digit + 1] += offsets[digit];
+                for (size_t i = 0; i < count; i++)
+                    to[offsets[from[i] >> shift & (DIGITS - 1)]++] = from[i];
+                std::swap(from, to);
+            }
+
+            std::vector<TransactionImage> sorted;
+            sorted.reserve(transactions.capacity());
+            for (size_t i = 0; i < count; i++)
+                sorted.push_back(transactions[static_cast<u32>(from[i])]);
+            transactions.swap(sorted);
+        }
+    }
+
     /**
      * @class BankAccount
-     * @brief Abstract base class for different types of bank accounts.
+     * @brief Base class for the kinds of bank accounts.
      */
 
     /**
@@ -28,56 +80,110 @@ namespace Bank
      * @param account_type The type of this bank account (CHECKING or SAVING).
      * @param customer A reference to the Customer who owns this account.
      * @param balance The initial balance of this account.
+     * @param account_id The ID to assign, or an invalid ID to generate a random one.
      */
-    BankAccount::BankAccount(AccountType account_type, Customer &customer, f64 balance)
-        : m_account_type(account_type), m_associated_customer(customer), m_balance(balance)
+    BankAccount::BankAccount(AccountType account_type, Customer &customer, f64 balance, AccountID account_id)
+        : m_account_type(account_type), m_balance(balance), m_opening_balance(balance), m_bank(customer.GetBank()),
+          m_owner(customer.GetHandle())
     {
-        GenerateAccountID(); // Automatically assign a unique ID upon construction
+        // Automatically assign a unique ID upon construction, unless one is given (e.g. by a replica)
+        if (account_id.IsValid())
+            m_account_id = account_id;
+        else
+            GenerateAccountID();
     }
 
     /**
-     * @brief Virtual destructor for BankAccount.
+     * @brief Destructor for BankAccount, which also destroys every kind of account.
      */
     BankAccount::~BankAccount()
     {
         // Log a message when deleting a BankAccount
-        std::cout << "Deleting bank account" << std::endl;
+        ActivityLog() << "Deleting bank account" << std::endl;
     }
 
     /**
-     * @class CheckingAccount
-     * @brief Derived class representing a checking account with overdraft protection.
+     * @brief Returns the Customer who owns this account.
+     * @return A reference to the owner, resolved through the Bank's customer map.
      */
+    const Customer &BankAccount::GetAccountOwner() const
+    {
+        const Customer *owner = m_bank.GetCustomers().Get(m_owner);
+        assert(owner);
+        return *owner;
+    }
 
     /**
-     * @brief Constructs a CheckingAccount object.
-     * @param account_type The type of this account (should be CHECKING).
-     * @param customer A reference to the Customer who owns this account.
-     * @param balance The initial balance of this checking account.
+     * @brief Returns the Customer who owns this account.
+     * @return A reference to the owner, resolved through the Bank's customer map.
      */
-    CheckingAccount::CheckingAccount(AccountType account_type, Customer &customer, f64 balance)
-        : BankAccount(account_type, customer, balance)
+    Customer &BankAccount::GetAccountOwner()
     {
-        std::cout << "Checking account created for " << m_associated_customer.GetName()
-                  << " (Account ID: " << m_account_id << ")" << std::endl;
+        Customer *owner = m_bank.GetCustomers().Get(m_owner);
+        assert(owner);
+        return *owner;
+    }
+
+    /**
+     * @brief Adds what this account allocates beyond its slot: its transactions, the list holding them and any velocity tracker.
+     * @param memory The breakdown to add to.
+     * @return The bytes added.
+     */
+    size_t BankAccount::MeasureMemory(BankMemory &memory) const
+    {
+        const size_t before = memory.Total().bytes;
+
+        // The list's inline part is already counted in this account's slot; only a spilled buffer is extra
+        constexpr size_t pointer_bytes = sizeof(std::unique_ptr<Transaction>);
+        const size_t transaction_bytes = m_transactions.size() * sizeof(Transaction);
+        const bool spilled = !m_transactions.IsInline();
+        memory[MemoryCategory::TRANSACTIONS].Add(m_transactions.size(),
+                                                 transaction_bytes + (spilled ? m_transactions.size() * pointer_bytes : 0),
+                                                 transaction_bytes + (spilled ? m_transactions.capacity() * pointer_bytes : 0));
+        if (m_velocity)
+            memory[MemoryCategory::ACCOUNTS].Add(0, sizeof(VelocityTracker), sizeof(VelocityTracker));
+
+        // Sealed transactions take only their encoded bytes
+        for (const TransactionBlock &block : m_sealed)
+            memory[MemoryCategory::TRANSACTIONS].Add(block.size(), block.GetBytes(), block.GetBytes());
+        memory[MemoryCategory::TRANSACTIONS].Add(0, m_sealed.size() * sizeof(TransactionBlock),
+                                                 m_sealed.capacity() * sizeof(TransactionBlock));
+
+        // Archived transactions are on disk; only their checkpoint and extent list stay in memory
+        if (m_archived)
+        {
+            constexpr size_t extent_bytes = sizeof(ArchiveExtent);
+            memory[MemoryCategory::TRANSACTIONS].Add(0, sizeof(ArchivedHistory) + m_archived->extents.size() * extent_bytes,
+                                                     sizeof(ArchivedHistory) + m_archived->extents.capacity() * extent_bytes);
+        }
+        return memory.Total().bytes - before;
     }
 
     /**
-     * @class SavingAccount
-     * @brief Derived class representing a savings account with interest accrual.
+     * @class Account
+     * @brief One kind of account: a checking account, which may be overdrawn for a fee, or a savings
+     *        account, which earns interest.
      */
 
     /**
-     * @brief Constructs a SavingAccount object.
-     * @param account_type The type of this account (should be SAVING).
+     * @brief Constructs an account of this kind.
      * @param customer A reference to the Customer who owns this account.
-     * @param balance The initial balance of this savings account.
+     * @param balance The initial balance of this account.
+     * @param account_id The ID to assign, or an invalid ID to generate a random one.
      */
-    SavingAccount::SavingAccount(AccountType account_type, Customer &customer, f64 balance)
-        : BankAccount(account_type, customer, balance)
+    template <AccountType Type>
+    Account<Type>::Account(Customer &customer, f64 balance, AccountID account_id)
+        : BankAccount(Type, customer, balance, account_id)
     {
-        std::cout << "Saving account created for " << m_associated_customer.GetName()
-                  << " (Account ID: " << m_account_id << ")" << std::endl;
+        if constexpr (Policy::EARNS_INTEREST)
+        {
+            // Start earning from the Bank's current period; earlier periods do not apply to a new account
+            m_interest_clock = &customer.GetBank().GetInterestPeriod();
+            m_interest_period = *m_interest_clock;
+        }
+
+        ActivityLog() << Policy::NAME << " account created for " << GetAccountOwner().GetName()
+                      << " (Account ID: " << m_account_id << ")" << std::endl;
     }
 
     /**
@@ -86,32 +192,52 @@ namespace Bank
      */
     void BankAccount::Deposit(f64 amount)
     {
+        TraceSpan span("Deposit");
+
         // Simply add to the current balance
+        SettleInterest();
         m_balance += amount;
-        std::cout << m_associated_customer.GetName() << " deposited $" << amount
-                  << " into their account (Account ID: " << m_account_id << ")" << std::endl;
+        Reindex();
+        ActivityLog() << GetAccountOwner().GetName() << " deposited $" << amount
+                      << " into their account (Account ID: " << m_account_id << ")" << std::endl;
     }
 
     /**
      * @brief Transfers a specified amount from this BankAccount to another of the same Customer, by destination account ID.
      * @param destination_account_id The ID of the account to which the amount should be transferred.
      * @param amount The amount to transfer.
+     * @return True if the transfer succeeds, false if the destination account does not exist or funds are insufficient.
      */
-    void BankAccount::Transfer(const std::string &destination_account_id, f64 amount)
+    bool BankAccount::Transfer(AccountID destination_account_id, f64 amount)
     {
-        // Deduct from the source account
-        m_balance -= amount;
+        TraceSpan span("Transfer");
 
-        // Locate the destination account via the same Customer
+        // Locate the destination account via the same Customer before touching any balance
         BankAccount *const destAccount = FindAccount(&this->GetAccountOwner(), destination_account_id);
-        if (!destAccount)
+        if (!destAccount || destAccount == this)
         {
             std::cerr << "Error: Destination account not found. Transfer aborted.\n";
-            return;
+            return false;
+        }
+
+        // Scheduled transfers bypass the menu's balance check, so enforce it here as well
+        SettleInterest();
+        if (amount > m_balance)
+        {
+            std::cerr << "Error: Insufficient funds to transfer $" << amount
+                      << " from account " << m_account_id << ". Transfer aborted.\n";
+            return false;
         }
 
-        // Credit the destination account
+        // Move the money from the source account to the destination account
+        destAccount->SettleInterest();
+        m_balance -= amount;
         destAccount->m_balance += amount;
+        destAccount->m_transfers_received += amount;
+        Reindex();
+        destAccount->Reindex();
+        SnapshotManager::Shared().MarkDirty(*destAccount);
+        return true;
     }
 
     /**
@@ -120,38 +246,35 @@ namespace Bank
      */
     void BankAccount::GenerateAccountID()
     {
-        // Generate a random integer, then attach 'C' or 'S' depending on account type
+        // Generate a random integer, then pack it with the account type ('C' or 'S' in text form),
+        // drawing again on the rare collision with another account at this Bank
         i32 temp_id;
         std::random_device rd;
-        temp_id = rd() % (MAX_ACCOUNT_ID - MIN_ACCOUNT_ID + 1) + MIN_ACCOUNT_ID;
-
-        if (m_account_type == AccountType::CHECKING)
+        do
         {
-            m_account_id = std::to_string(temp_id) + 'C';
-        }
-        else if (m_account_type == AccountType::SAVING)
-        {
-            m_account_id = std::to_string(temp_id) + 'S';
-        }
+            temp_id = rd() % (MAX_ACCOUNT_ID - MIN_ACCOUNT_ID + 1) + MIN_ACCOUNT_ID;
+            m_account_id = AccountID(static_cast<u32>(temp_id), m_account_type);
+        } while (m_bank.FindAccount(m_account_id));
     }
 
     /**
      * @brief Creates a new Transaction object associated with this account and inserts it in sorted order by transaction ID.
      * @param transaction_type The type of transaction (DEPOSIT, WITHDRAW, or TRANSFER).
      * @param amount The transaction amount.
-     * @param destination_account_id The ID of the destination account if this is a TRANSFER; otherwise, an empty string.
+     * @param destination_account_id The ID of the destination account if this is a TRANSFER; otherwise, an invalid ID.
+     * @param transaction_id The ID to assign, or 0 to generate a random one.
+     * @return A reference to the executed Transaction (check WasInvalid() to see whether it succeeded).
      */
-    void BankAccount::CreateTransaction(TransactionType transaction_type, f64 amount, const std::string &destination_account_id)
+    const Transaction &BankAccount::CreateTransaction(TransactionType transaction_type, f64 amount, AccountID destination_account_id,
+                                                      i32 transaction_id)
     {
-        // Ensure there's enough capacity for new transactions
-        if (m_transactions.capacity() == 0)
-        {
-            m_transactions.reserve(100);
-        }
+        TraceSpan span("CreateTransaction");
 
         // Create the new Transaction
         std::unique_ptr<Transaction> new_transaction =
-            std::make_unique<Transaction>(*this, amount, transaction_type, destination_account_id);
+            std::make_unique<Transaction>(*this, amount, transaction_type, destination_account_id, transaction_id);
+
+        SnapshotManager::Shared().MarkDirty(*this, new_transaction.get());
 
         // Insert transaction in sorted order by transaction ID
         auto it = std::lower_bound(
@@ -161,51 +284,369 @@ namespace Bank
                 return a->GetTransactionID() < b->GetTransactionID();
             });
 
-        m_transactions.insert(it, std::move(new_transaction));
+        const Transaction &transaction = **m_transactions.insert(it, std::move(new_transaction));
+        ReplicationLog::Shared().LogTransaction(*this, transaction);
+
+        // Once the live list doubles past a block, compress its older half; the new transaction stays live
+        if (m_transactions.size() >= 2 * TRANSACTION_BLOCK_SIZE)
+            SealOldestTransactions();
+        return transaction;
     }
 
     /**
-     * @brief Displays all transactions associated with this bank account.
+     * @brief Creates a Transaction unless a request with the same idempotency key was already submitted for this account.
+     *
+     * A client that retries after a timeout sends the same key again and the retry is rejected, so the
+     * operation is applied at most once. Keys are remembered for IDEMPOTENCY_TTL_SECONDS of simulated time.
+     *
+     * @param idempotency_key The client's request key; empty to always create the Transaction.
+     * @param transaction_type The type of transaction (DEPOSIT, WITHDRAW, or TRANSFER).
+     * @param amount The transaction amount.
+     * @param destination_account_id The ID of the destination account if this is a TRANSFER; otherwise, an invalid ID.
+     * @return The executed Transaction, or nullptr if the key was a repeat and nothing was done.
      */
-    void BankAccount::ViewAccountTransactions() const
+    const Transaction *BankAccount::SubmitTransaction(const std::string &idempotency_key, TransactionType transaction_type, f64 amount,
+                                                      AccountID destination_account_id)
     {
+        // Keys are scoped to the account, so two clients cannot collide on each other's accounts
+        if (!idempotency_key.empty() && !IdempotencyFilter::Shared().CheckAndRecord(m_account_id.ToString() + ':' + idempotency_key))
+        {
+            std::cerr << "Error: Request '" << idempotency_key << "' was already submitted for account "
+                      << m_account_id << ". Transaction ignored.\n";
+            return nullptr;
+        }
+
+        return &CreateTransaction(transaction_type, amount, destination_account_id);
+    }
+
+    /**
+     * @brief Sets limits on withdrawals from this account, replacing any previous ones.
+     *
+     * Activity is counted from the moment limits are first set. Unlimited limits release the tracker.
+     *
+     * @param limits The new limits.
+     */
+    void BankAccount::SetVelocityLimits(const VelocityLimits &limits)
+    {
+        if (limits.IsUnlimited())
+            m_velocity.reset();
+        else if (m_velocity)
+            m_velocity->SetLimits(limits);
+        else
+            m_velocity = std::make_unique<VelocityTracker>(limits);
+
+        ReplicationLog::Shared().LogVelocityLimits(GetAccountOwner(), this, limits);
+    }
+
+    /**
+     * @brief Displays all transactions associated with this bank account, including archived ones.
+     */
+    void BankAccount::ViewAccountTransactions()
+    {
+        LoadHistory();
+        std::vector<TransactionImage> transactions = GetHistoryByID();
+
         // Loop through each transaction and display its details
         std::cout << "Transactions for account #" << m_account_id << ":\n";
         std::cout << "--------------------------------\n";
-        for (size_t i = 0; i < m_transactions.size(); i++)
+        for (size_t i = 0; i < transactions.size(); i++)
         {
+            const TransactionImage &t = transactions[i];
             std::cout << "Transaction #" << (i + 1) << std::endl;
-            m_transactions[i]->DisplayTransaction();
+            DisplayTransactionDetails(t.transaction_id, t.transaction_type, t.timestamp,
+                                      t.amount, t.balance_before, t.balance_after);
             std::cout << "--------------------------------\n";
         }
     }
 
     /**
-     * @brief Withdraws a specified amount from this checking account, respecting the overdraft limit.
+     * @brief Returns this account's whole history ordered by transaction ID, reading archived transactions back from disk.
+     * @return Copies of the transactions.
+     */
+    std::vector<TransactionImage> BankAccount::GetHistoryByID() const
+    {
+        std::vector<TransactionImage> transactions;
+        if (!m_archived && m_sealed.empty())
+        {
+            // Already in ID order
+            transactions.reserve(m_transactions.size());
+            for (const auto &transaction : m_transactions)
+                transactions.push_back(CaptureTransaction(*transaction));
+            return transactions;
+        }
+
+        transactions.reserve(GetNumberOfTransactions());
+        if (m_archived)
+            m_archived->Load(transactions);
+        for (const TransactionBlock &block : m_sealed)
+            block.Decode(transactions);
+        SortByID(transactions);
+
+        // The live transactions are kept in ID order, so they only need merging in
+        const size_t older = transactions.size();
+        for (const auto &transaction : m_transactions)
+            transactions.push_back(CaptureTransaction(*transaction));
+        std::inplace_merge(transactions.begin(), transactions.begin() + older, transactions.end(),
+                           [](const TransactionImage &a, const TransactionImage &b)
+                           { return a.transaction_id < b.transaction_id; });
+        return transactions;
+    }
+
+    /**
+     * @brief Returns how many transactions this account has executed, whether live, sealed or archived.
+     */
+    i32 BankAccount::GetNumberOfTransactions() const
+    {
+        size_t count = m_transactions.size() + (m_archived ? m_archived->transaction_count : 0);
+        for (const TransactionBlock &block : m_sealed)
+            count += block.size();
+        return static_cast<i32>(count);
+    }
+
+    /**
+     * @brief Appends the transactions this account still holds in memory, sealed or live, in chronological order.
+     * @param out The vector to append to.
+     */
+    void BankAccount::GetResidentHistory(std::vector<TransactionImage> &out) const
+    {
+        // Sealed blocks are always older than the live transactions
+        for (const TransactionBlock &block : m_sealed)
+            block.Decode(out);
+
+        const size_t live = out.size();
+        for (const auto &transaction : m_transactions)
+            out.push_back(CaptureTransaction(*transaction));
+        std::sort(out.begin() + live, out.end(), [](const TransactionImage &a, const TransactionImage &b)
+                  { return a.sequence < b.sequence; });
+    }
+
+    /**
+     * @brief Looks up one of this account's transactions in memory, live or sealed (but not archived).
+     * @param transaction_id The ID of the transaction to find.
+     * @param out Receives a copy of the transaction if found.
+     * @return True if the transaction was found.
+     */
+    bool BankAccount::FindTransaction(i32 transaction_id, TransactionImage &out) const
+    {
+        auto it = std::lower_bound(m_transactions.begin(), m_transactions.end(), transaction_id,
+                                   [](const std::unique_ptr<Transaction> &t, i32 id)
+                                   { return t->GetTransactionID() < id; });
+        if (it != m_transactions.end() && (*it)->GetTransactionID() == transaction_id)
+        {
+            out = CaptureTransaction(**it);
+            return true;
+        }
+
+        return std::any_of(m_sealed.begin(), m_sealed.end(), [&](const TransactionBlock &block)
+                           { return block.Find(transaction_id, out); });
+    }
+
+    /**
+     * @brief Compresses the oldest TRANSACTION_BLOCK_SIZE live transactions into a sealed block and frees them.
+     */
+    void BankAccount::SealOldestTransactions()
+    {
+        std::vector<TransactionImage> oldest;
+        oldest.reserve(m_transactions.size());
+        for (const auto &transaction : m_transactions)
+            oldest.push_back(CaptureTransaction(*transaction));
+        std::partial_sort(oldest.begin(), oldest.begin() + TRANSACTION_BLOCK_SIZE, oldest.end(),
+                          [](const TransactionImage &a, const TransactionImage &b)
+                          { return a.sequence < b.sequence; });
+
+        m_sealed.emplace_back(oldest.data(), TRANSACTION_BLOCK_SIZE);
+        const u64 last_sealed = oldest[TRANSACTION_BLOCK_SIZE - 1].sequence;
+
+        // The transactions live on in the block, so their deletion is not reported
+        QuietScope quiet;
+        m_transactions.erase(std::remove_if(m_transactions.begin(), m_transactions.end(),
+                                            [last_sealed](const std::unique_ptr<Transaction> &t)
+                                            { return t->GetSequence() <= last_sealed; }),
+                             m_transactions.end());
+    }
+
+    /**
+     * @brief Moves this account's transactions executed at or before a point in time to its bank's archive.
+     *
+     * Transactions are timestamped in the order they execute, so the archived ones are always the oldest,
+     * starting with those in sealed blocks.
+     * They are summarised in a new ArchivedHistory (count, closing balance and totals) so the ledger audit
+     * can carry on from there, written to the archive, and only then released from memory.
+     *
+     * @param cutoff The simulated time; transactions with a timestamp at or before it are archived.
+     * @param archive The archive of this account's bank.
+     * @return The number of transactions archived.
+     */
+    size_t BankAccount::ArchiveTransactions(i64 cutoff, TransactionArchive &archive)
+    {
+        // A history still in a checkpoint has to come into memory before part of it can move to this archive
+        LoadHistory();
+        if (m_history_unloaded)
+            return 0;
+
+        std::vector<TransactionImage> resident;
+        GetResidentHistory(resident);
+        const size_t archived = static_cast<size_t>(
+            std::find_if(resident.begin(), resident.end(), [cutoff](const TransactionImage &t)
+                         { return t.timestamp > cutoff; }) -
+            resident.begin());
+        if (archived == 0)
+            return 0;
+
+        ArchiveExtent extent;
+        if (!archive.Append(resident.data(), archived, extent))
+            return 0;
+
+        auto history = m_archived ? std::make_shared<ArchivedHistory>(*m_archived) : std::make_shared<ArchivedHistory>();
+        history->Summarise(resident.data(), archived, m_opening_balance);
+        history->archive = &archive;
+        history->extents.push_back(extent);
+        m_archived = std::move(history);
+        SnapshotManager::Shared().MarkArchived(*this);
+
+        // The sealed blocks hold the oldest resident transactions; reseal whatever of them was not archived
+        size_t sealed = 0;
+        for (const TransactionBlock &block : m_sealed)
+            sealed += block.size();
+        m_sealed.clear();
+        for (size_t i = archived; i < sealed; i += TRANSACTION_BLOCK_SIZE)
+            m_sealed.emplace_back(resident.data() + i, std::min(TRANSACTION_BLOCK_SIZE, sealed - i));
+        m_sealed.shrink_to_fit();
+
+        m_transactions.erase(std::remove_if(m_transactions.begin(), m_transactions.end(),
+                                            [cutoff](const std::unique_ptr<Transaction> &t)
+                                            { return t->GetTimestamp() <= cutoff; }),
+                             m_transactions.end());
+        m_transactions.shrink_to_fit();
+        return archived;
+    }
+
+    /**
+     * @brief Reopens this account as it was saved in a checkpoint, leaving its history in the checkpoint file.
+     *
+     * The history is held as if archived in the checkpoint, with the checkpoint's summary of it, so that
+     * audits, snapshots and exports work without reading it. LoadHistory brings it into memory.
+     *
+     * @param checkpoint The account's record in the checkpoint.
+     * @param checkpoint_file The checkpoint, opened for reading; it must outlive this account's use of it.
+     */
+    void BankAccount::Restore(const AccountCheckpoint &checkpoint, const TransactionArchive &checkpoint_file)
+    {
+        m_balance = checkpoint.balance;
+        m_opening_balance = checkpoint.opening_balance;
+        m_interest_posted = checkpoint.interest_posted;
+        m_transfers_received = checkpoint.transfers_received;
+        m_fees_assessed = checkpoint.fees_assessed;
+        m_next_sequence = checkpoint.next_sequence;
+        if (!checkpoint.limits.IsUnlimited())
+            SetVelocityLimits(checkpoint.limits);
+
+        if (checkpoint.history.count > 0)
+        {
+            auto history = std::make_shared<ArchivedHistory>();
+            history->archive = &checkpoint_file;
+            history->extents.push_back(checkpoint.history);
+            history->transaction_count = checkpoint.history.count;
+            history->balance_after = checkpoint.balance_after;
+            history->net_change = checkpoint.net_change;
+            history->transferred_out = checkpoint.transferred_out;
+            history->balance_drops = checkpoint.balance_drops;
+            m_archived = std::move(history);
+            m_history_unloaded = true;
+        }
+
+        Reindex();
+        SnapshotManager::Shared().MarkArchived(*this);
+    }
+
+    /**
+     * @brief Brings a history restored from a checkpoint into memory, the first time it is needed.
+     *
+     * The history is laid out as if the account had executed it in this run: older transactions in
+     * sealed blocks and the newest live. Transactions executed since the restore are newer still, and
+     * keep their place. Does nothing if the history is already in memory.
+     */
+    void BankAccount::LoadHistory()
+    {
+        if (!m_history_unloaded)
+            return;
+
+        std::vector<TransactionImage> history;
+        m_archived->Load(history);
+        if (history.size() != m_archived->transaction_count)
+            return; // Left in the checkpoint, to be retried on the next access
+
+        for (const TransactionBlock &block : m_sealed)
+            block.Decode(history);
+        m_sealed.clear();
+        m_archived.reset();
+        m_history_unloaded = false;
+
+        size_t next = 0;
+        while (history.size() - next >= TRANSACTION_BLOCK_SIZE &&
+               history.size() - next + m_transactions.size() >= 2 * TRANSACTION_BLOCK_SIZE)
+        {
+            m_sealed.emplace_back(history.data() + next, TRANSACTION_BLOCK_SIZE);
+            next += TRANSACTION_BLOCK_SIZE;
+        }
+        for (; next < history.size(); next++)
+            m_transactions.push_back(std::make_unique<Transaction>(*this, history[next]));
+        std::sort(m_transactions.begin(), m_transactions.end(), [](const std::unique_ptr<Transaction> &a, const std::unique_ptr<Transaction> &b)
+                  { return a->GetTransactionID() < b->GetTransactionID(); });
+        if (m_transactions.size() >= 2 * TRANSACTION_BLOCK_SIZE)
+            SealOldestTransactions();
+
+        SnapshotManager::Shared().MarkArchived(*this);
+    }
+
+    /**
+     * @brief Withdraws a specified amount from this account, as its kind allows.
      * @param amount The amount to withdraw.
-     * @return True if the withdrawal succeeds, false if it fails due to overdraft limit.
+     * @return True if the withdrawal succeeds, false if it would take the balance below what this kind of account allows.
      */
-    bool CheckingAccount::Withdraw(f64 amount)
+    bool BankAccount::Withdraw(f64 amount)
     {
-        // Check if this withdrawal would exceed the overdraft limit
-        if ((m_balance - amount) < -OVERDRAFT_LIMIT)
+        TraceSpan span("Withdraw");
+        return VisitAccount(*this, [amount](auto &account)
+                            { return account.Withdraw(amount); });
+    }
+
+    /**
+     * @brief Withdraws a specified amount from this account: a checking account may be overdrawn down to the
+     *        overdraft limit, for a fee, and a savings account not at all.
+     * @param amount The amount to withdraw.
+     * @return True if the withdrawal succeeds, false if it would take the balance below Policy::MIN_BALANCE.
+     */
+    template <AccountType Type>
+    bool Account<Type>::Withdraw(f64 amount)
+    {
+        if constexpr (Policy::EARNS_INTEREST)
+            SettleInterest();
+        if ((m_balance - amount) < Policy::MIN_BALANCE)
         {
-            std::cerr << "Error: Overdraft limit exceeded. Transaction denied.\n";
+            if constexpr (Policy::CHARGES_OVERDRAFT_FEE)
+                std::cerr << "Error: Overdraft limit exceeded. Transaction denied.\n";
+            else
+                std::cerr << "Error: Insufficient funds to withdraw $"
+                          << amount << " from " << GetAccountOwner().GetName()
+                          << "'s account (Account ID: " << m_account_id << ")\n";
             return false;
         }
 
         m_balance -= amount;
 
         // If the new balance is below zero, apply an overdraft fee
-        if (m_balance < 0)
+        if constexpr (Policy::CHARGES_OVERDRAFT_FEE)
         {
-            ApplyOverdraftFee();
+            if (m_balance < 0)
+                ApplyOverdraftFee();
         }
+        Reindex();
 
-        std::cout << m_associated_customer.GetName()
-                  << " withdrew $" << amount
-                  << " from their Checking Account (ID: " << m_account_id
-                  << ")." << std::endl;
+        ActivityLog() << GetAccountOwner().GetName()
+                      << " withdrew $" << amount
+                      << " from their " << Policy::NAME << " Account (ID: " << m_account_id
+                      << ")." << std::endl;
 
         return true;
     }
@@ -213,43 +654,70 @@ namespace Bank
     /**
      * @brief Applies an overdraft fee to this checking account if the balance is negative.
      */
-    void CheckingAccount::ApplyOverdraftFee()
+    template <AccountType Type>
+    void Account<Type>::ApplyOverdraftFee()
+        requires Policy::CHARGES_OVERDRAFT_FEE
     {
         // Deduct a fixed overdraft fee
         m_balance -= OVERDRAFT_FEE;
-        std::cout << "Overdraft fee of $" << OVERDRAFT_FEE
-                  << " applied to " << m_associated_customer.GetName()
-                  << "'s Checking Account (ID: " << m_account_id
-                  << ")." << std::endl;
+        Reindex();
+        ActivityLog() << "Overdraft fee of $" << OVERDRAFT_FEE
+                      << " applied to " << GetAccountOwner().GetName()
+                      << "'s " << Policy::NAME << " Account (ID: " << m_account_id
+                      << ")." << std::endl;
     }
 
     /**
-     * @brief Withdraws a specified amount from this savings account if sufficient funds are available.
-     * @param amount The amount to withdraw.
-     * @return True if the withdrawal succeeds, false if insufficient funds.
+     * @brief Charges the overdraft fee again if this checking account is still overdrawn (end-of-day assessment).
+     * @return True if a fee was charged.
      */
-    bool SavingAccount::Withdraw(f64 amount)
+    template <AccountType Type>
+    bool Account<Type>::AssessOverdraftFee()
+        requires Policy::CHARGES_OVERDRAFT_FEE
     {
-        // Cannot go negative for a savings account
-        if (m_balance < amount)
-        {
-            std::cerr << "Error: Insufficient funds to withdraw $"
-                      << amount << " from " << m_associated_customer.GetName()
-                      << "'s account (Account ID: " << m_account_id << ")\n";
+        if (m_balance >= 0)
             return false;
-        }
 
-        m_balance -= amount;
-        std::cout << m_associated_customer.GetName()
-                  << " withdrew $" << amount
-                  << " from their Saving Account (ID: " << m_account_id << ")\n";
+        ApplyOverdraftFee();
+        m_fees_assessed += OVERDRAFT_FEE;
+        SnapshotManager::Shared().MarkDirty(*this);
+        ReplicationLog::Shared().LogOverdraftFee(*this);
         return true;
     }
 
+    template class Account<AccountType::CHECKING>;
+    template class Account<AccountType::SAVING>;
+
+    /**
+     * @brief Moves this account to its place in its Bank's BalanceIndex after its balance changed.
+     *
+     * Lazy interest accrual does not call this: it moves every saving account alike, which the index already allows for.
+     */
+    void BankAccount::Reindex()
+    {
+        m_bank.GetBalanceIndex().Update(*this);
+    }
+
+    /**
+     * @brief Catches this account up with its Bank's interest period, one compounding step per missed period.
+     *
+     * Each step is the same CompoundInterest an eager sweep applied, so the balance is bit-for-bit
+     * what a sweep at every rollover would have produced. The cost is paid only by accounts that are
+     * actually read or written, and only for the periods they missed.
+     */
+    void BankAccount::AccrueInterest() const
+    {
+        while (m_interest_period < *m_interest_clock)
+        {
+            CompoundInterest();
+            m_interest_period++;
+        }
+    }
+
     /**
-     * @brief Applies interest to this savings account based on the global INTEREST_RATE.
+     * @brief Applies one period of interest based on the global INTEREST_RATE.
      */
-    void SavingAccount::ApplyInterest()
+    void BankAccount::CompoundInterest() const
     {
         // Ensure that the global interest rate is valid
         if (INTEREST_RATE < 0)
@@ -261,5 +729,6 @@ namespace Bank
         // Calculate interest and update the balance
         f64 interest = m_balance * INTEREST_RATE;
         m_balance += interest;
+        m_interest_posted += interest;
     }
 }
@@ -0,0 +1,245 @@
+/**
+ * @file bulk_loader.cpp
+ * @brief This file implements bulk loading of customers and their accounts into a Bank, including a CSV importer
+ *        that parses its input in parallel.
+ */
+
+#include "../include/bulk_loader.hpp"
+#include "../include/activity_log.hpp"
+#include "../include/bank_account.hpp"
+#include "../include/customer.hpp"
+#include "../include/global.hpp"
+#include "../include/thread_pool.hpp"
+#include <charconv>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <utility>
+
+namespace Bank
+{
+    namespace
+    {
+        /**
+         * @brief Returns a field without surrounding spaces, tabs or a trailing carriage return.
+         */
+        std::string_view Trim(std::string_view text)
+        {
+            const size_t first = text.find_first_not_of(" \t\r");
+            if (first == std::string_view::npos)
+                return {};
+            return text.substr(first, text.find_last_not_of(" \t\r") - first + 1);
+        }
+
+        /**
+         * @brief Parses a whole field as a number, without allocating or consulting the locale.
+         * @return False unless the entire field is a valid number.
+         */
+        template <typename T>
+        bool ParseNumber(std::string_view text, T &value)
+        {
+            const char *end = text.data() + text.size();
+            auto [ptr, ec] = std::from_chars(text.data(), end, value);
+            return ec == std::errc() && ptr == end;
+        }
+
+        /**
+         * @brief Parses one row: 'customer_id,first_name,last_name,age[,C:balance|S:balance]...'.
+         *
+         * A customer_id of 0 asks for a random ID. Each trailing field opens a checking (C) or saving (S)
+         * account with the given starting balance. The names in the record are views into the row.
+         *
+         * @param line The row, without its newline.
+         * @param record The record to fill in.
+         * @return False if the row is malformed or any value is out of range.
+         */
+        bool ParseCustomerRow(std::string_view line, CustomerRecord &record)
+        {
+            size_t field_number = 0;
+            while (true)
+            {
+                const size_t comma = line.find(',');
+                const std::string_view field = Trim(line.substr(0, comma));
+
+                switch (field_number)
+                {
+                case 0:
+                    if (!ParseNumber(field, record.customer_id) ||
+                        (record.customer_id != 0 && (record.customer_id < MIN_CUSTOMER_ID || record.customer_id > MAX_CUSTOMER_ID)))
+                        return false;
+                    break;
+                case 1:
+                    record.first_name = field;
+                    break;
+                case 2:
+                    record.last_name = field;
+                    break;
+                case 3:
+                    if (!ParseNumber(field, record.age) || record.age < MIN_AGE || record.age > MAX_AGE)
+                        return false;
+                    break;
+                default:
+                {
+                    AccountRecord account;
+                    if (field.size() < 3 || field[1] != ':' || (field[0] != 'C' && field[0] != 'S') ||
+                        !ParseNumber(field.substr(2), account.balance) ||
+                        account.balance < MIN_STARTING_BALANCE || account.balance > MAX_BALANCE ||
+                        record.accounts.size() == MAX_BULK_ACCOUNTS_PER_CUSTOMER)
+                        return false;
+                    account.account_type = field[0] == 'C' ? AccountType::CHECKING : AccountType::SAVING;
+                    record.accounts.push_back(account);
+                    break;
+                }
+                }
+
+                field_number++;
+                if (comma == std::string_view::npos)
+                    break;
+                line.remove_prefix(comma + 1);
+            }
+
+            return field_number >= 4 && !record.first_name.empty() && !record.last_name.empty();
+        }
+    }
+
+    /**
+     * @brief Adds many customers, and their accounts, to a Bank in one pass.
+     *
+     * Storage and the ID indexes are sized for the whole load before anything is created, so nothing is
+     * reallocated or rehashed along the way, and each customer is indexed as it is inserted. Per-object
+     * creation messages are discarded for the duration. A record whose customer ID is already taken is
+     * skipped, as is every record without an ID once the bank has used up the customer ID range.
+     *
+     * @param bank The Bank to load into.
+     * @param records The customers to add, in order.
+     * @param report The report to add the counts and elapsed time to.
+     */
+    void LoadCustomers(Bank &bank, const std::vector<CustomerRecord> &records, BulkLoadReport &report)
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        size_t accounts = 0;
+        for (const CustomerRecord &record : records)
+            accounts += record.accounts.size();
+        bank.Reserve(records.size(), accounts);
+
+        constexpr size_t customer_id_range = MAX_CUSTOMER_ID - MIN_CUSTOMER_ID + 1;
+        QuietScope quiet;
+        for (const CustomerRecord &record : records)
+        {
+            if (record.customer_id != 0 ? bank.FindCustomer(record.customer_id) != nullptr
+                                        : bank.GetCustomers().size() >= customer_id_range)
+            {
+                report.rejected++;
+                continue;
+            }
+
+            Customer &customer = bank.AddCustomer(std::string(record.first_name), std::string(record.last_name),
+                                                  record.age, record.customer_id);
+            for (const AccountRecord &account : record.accounts)
+                customer.CreateBankAccount(account.account_type, account.balance);
+
+            report.customers++;
+            report.accounts += record.accounts.size();
+        }
+
+        report.load_seconds += std::chrono::duration<f64>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    /**
+     * @brief Imports a CSV file of customers into a Bank.
+     *
+     * The file is read in one go and split into rows, which are then parsed in parallel on the shared
+     * ThreadPool; only the insertion itself (LoadCustomers) is sequential. Blank lines and lines starting
+     * with '#' are ignored, and invalid rows are reported by line number and skipped.
+     *
+     * @param bank The Bank to load into.
+     * @param path The CSV file; see ParseCustomerRow for the row format.
+     * @return The counts and timings of the import.
+     */
+    BulkLoadReport ImportCustomers(Bank &bank, const std::string &path)
+    {
+        BulkLoadReport report;
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file.is_open())
+        {
+            std::cerr << "Error: " << path << " could not be opened.\n";
+            return report;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        std::string text(static_cast<size_t>(file.tellg()), '\0');
+        file.seekg(0);
+        file.read(text.data(), static_cast<std::streamsize>(text.size()));
+
+        // Finding the rows is a cheap sequential scan; parsing them is the part worth spreading out
+        std::vector<std::pair<size_t, std::string_view>> rows; // (line number, row)
+        const std::string_view contents(text);
+        size_t line_number = 0;
+        for (size_t begin = 0; begin < contents.size();)
+        {
+            size_t end = contents.find('\n', begin);
+            if (end == std::string_view::npos)
+                end = contents.size();
+            line_number++;
+
+            const std::string_view row = Trim(contents.substr(begin, end - begin));
+            if (!row.empty() && row[0] != '#')
+                rows.emplace_back(line_number, row);
+            begin = end + 1;
+        }
+
+        std::vector<CustomerRecord> records(rows.size());
+        std::vector<char> valid(rows.size(), 0);
+        ThreadPool::Shared().ParallelFor(rows.size(), [&](size_t begin, size_t end)
+                                         {
+            for (size_t i = begin; i < end; i++)
+                valid[i] = ParseCustomerRow(rows[i].second, records[i]); }, 1024);
+
+        // Keep the valid records in file order
+        size_t kept = 0;
+        for (size_t i = 0; i < rows.size(); i++)
+        {
+            if (valid[i])
+            {
+                if (kept != i)
+                    records[kept] = std::move(records[i]);
+                kept++;
+            }
+            else
+            {
+                std::cerr << "Error: Line " << rows[i].first << " is not a valid customer. Skipped.\n";
+                report.rejected++;
+            }
+        }
+        records.resize(kept);
+
+        report.rows = rows.size();
+        report.parse_seconds = std::chrono::duration<f64>(std::chrono::steady_clock::now() - start).count();
+
+        LoadCustomers(bank, records, report);
+        return report;
+    }
+
+    /**
+     * @brief Prints a summary of a bulk load, including its throughput.
+     * @param report The report to print.
+     * @param os The stream to print to.
+     */
+    void PrintBulkLoadReport(const BulkLoadReport &report, std::ostream &os)
+    {
+        const f64 elapsed = report.parse_seconds + report.load_seconds;
+        const std::ios::fmtflags flags = os.flags();
+        const std::streamsize precision = os.precision();
+        os << "Rows read: " << report.rows << "\n";
+        os << "Customers added: " << report.customers << "\n";
+        os << "Accounts opened: " << report.accounts << "\n";
+        os << "Rows skipped: " << report.rejected << "\n";
+        os << std::fixed << std::setprecision(3) << "Parsed in " << report.parse_seconds << "s on "
+           << ThreadPool::Shared().GetThreadCount() << " thread(s), loaded in " << report.load_seconds << "s ("
+           << std::setprecision(0) << (elapsed > 0.0 ? report.rows / elapsed : 0.0) << " rows/sec)\n";
+        os.flags(flags);
+        os.precision(precision);
+    }
+}
@@ -0,0 +1,458 @@
+/**
+ * @file checkpoint.cpp
+ * @brief This file implements checkpoints: saving every bank, customer, account and transaction to one
+ *        file, and restoring from it at startup without reading any transaction history.
+ *
+ * A checkpoint holds a header, then every account's history, then a directory of the banks, customers
+ * and accounts. Restoring reads the header and the directory only; each account keeps its history in
+ * the file, as if archived there, until something first reads it.
+ */
+
+#include "../include/checkpoint.hpp"
+#include "../include/activity_log.hpp"
+#include "../include/bank.hpp"
+#include "../include/bank_account.hpp"
+#include "../include/customer.hpp"
+#include "../include/sim_clock.hpp"
+#include "../include/trace.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+#ifndef _WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace Bank
+{
+    namespace
+    {
+        constexpr char CHECKPOINT_MAGIC[8] = {'B', 'A', 'N', 'K', 'C', 'K', 'P', 'T'};
+        constexpr u32 CHECKPOINT_VERSION = 1;
+
+        struct CheckpointHeader
+        {
+            char magic[8];
+            u32 version;
+            u32 bank_count;
+            i64 clock;            // The simulated time
+            u64 directory_offset; // Where the banks, customers and accounts start, after every history
+        };
+
+        // Each entry is followed by its names, then by its customers or accounts
+        struct BankEntry
+        {
+            i32 bank_id;
+            u32 name_length;
+            u64 interest_period;
+            u32 customer_count;
+            u32 account_count;
+        };
+
+        struct CustomerEntry
+        {
+            i32 customer_id;
+            i32 age;
+            u32 first_name_length;
+            u32 last_name_length;
+            u32 account_count;
+            VelocityLimits limits;
+        };
+
+        template <typename T>
+        void WriteRecord(std::ostream &os, const T &record)
+        {
+            os.write(reinterpret_cast<const char *>(&record), sizeof(T));
+        }
+
+        template <typename T>
+        bool ReadRecord(std::istream &is, T &record)
+        {
+            return static_cast<bool>(is.read(reinterpret_cast<char *>(&record), sizeof(T)));
+        }
+
+        bool ReadString(std::istream &is, u32 length, std::string &out)
+        {
+            out.resize(length);
+            return static_cast<bool>(is.read(out.data(), length));
+        }
+
+        // What a background writer sends back when it is done
+        struct WriterResult
+        {
+            bool succeeded;
+            CheckpointReport report;
+        };
+
+        VelocityLimits GetLimits(const VelocityTracker *tracker)
+        {
+            return tracker ? tracker->GetLimits() : VelocityLimits();
+        }
+
+        /**
+         * @brief Writes one account's whole history to the checkpoint and returns its record.
+         * @param os The checkpoint, positioned where the history goes.
+         * @param offset The current size of the checkpoint; advanced past the history.
+         * @return False if part of the history could not be read back from an archive.
+         */
+        bool WriteAccount(std::ostream &os, const BankAccount &account, u64 &offset, AccountCheckpoint &record)
+        {
+            // Archived transactions are the oldest, and the resident ones follow in order
+            std::vector<TransactionImage> history;
+            if (account.GetArchivedHistory())
+                account.GetArchivedHistory()->Load(history);
+            account.GetResidentHistory(history);
+            if (history.size() != static_cast<size_t>(account.GetNumberOfTransactions()))
+            {
+                std::cerr << "Error: The history of account " << account.GetID() << " could not be read.\n";
+                return false;
+            }
+
+            ArchivedHistory summary;
+            summary.Summarise(history.data(), history.size(), account.GetOpeningBalance());
+            os.write(reinterpret_cast<const char *>(history.data()),
+                     static_cast<std::streamsize>(history.size() * sizeof(TransactionImage)));
+
+            record = {};
+            record.account_id = account.GetID();
+            record.account_type = account.GetAccountType();
+            record.balance = account.GetBalance(); // Settles interest up to the bank's period, which is saved with it
+            record.opening_balance = account.GetOpeningBalance();
+            record.interest_posted = account.GetInterestPosted();
+            record.transfers_received = account.GetTransfersReceived();
+            record.fees_assessed = account.GetFeesAssessed();
+            record.next_sequence = account.GetNextSequence();
+            record.limits = GetLimits(account.GetVelocityTracker());
+            record.history = {offset, static_cast<u32>(history.size())};
+            record.balance_after = summary.balance_after;
+            record.net_change = summary.net_change;
+            record.transferred_out = summary.transferred_out;
+            record.balance_drops = summary.balance_drops;
+            offset += history.size() * sizeof(TransactionImage);
+            return true;
+        }
+    }
+
+    /**
+     * @brief Saves every bank, customer, account and transaction to a checkpoint file.
+     *
+     * The checkpoint is written next to the target and renamed over it once complete, so an interrupted
+     * save never leaves a partial checkpoint behind.
+     *
+     * @param banks The banks to save.
+     * @param path The file to write.
+     * @param report Receives what was saved.
+     * @return False if the checkpoint could not be written.
+     */
+    bool SaveCheckpoint(const std::vector<std::unique_ptr<Bank>> &banks, const std::string &path, CheckpointReport &report)
+    {
+        TraceSpan span("SaveCheckpoint");
+        auto start = std::chrono::steady_clock::now();
+        report = {};
+        const std::string temp_path = path + ".tmp";
+        std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+        {
+            std::cerr << "Error: " << temp_path << " could not be opened.\n";
+            return false;
+        }
+
+        CheckpointHeader header{};
+        std::memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic));
+        header.version = CHECKPOINT_VERSION;
+        header.bank_count = static_cast<u32>(banks.size());
+        header.clock = SimClock::Shared().Now();
+        WriteRecord(file, header);
+
+        // Histories first, so that the directory can say where each one is
+        u64 offset = sizeof(CheckpointHeader);
+        std::vector<AccountCheckpoint> records;
+        bool ok = true;
+        for (const auto &bank : banks)
+        {
+            for (const Customer &customer : bank->GetCustomers())
+            {
+                for (const BankAccount &account : customer.GetAccounts())
+                {
+                    records.emplace_back();
+                    ok = ok && WriteAccount(file, account, offset, records.back());
+                    report.transactions += records.back().history.count;
+                }
+            }
+        }
+        header.directory_offset = offset;
+
+        // Then the directory, in the same order
+        auto record = records.begin();
+        for (const auto &bank : banks)
+        {
+            const std::string_view name = bank->GetName();
+            WriteRecord(file, BankEntry{bank->GetID(), static_cast<u32>(name.size()), bank->GetInterestPeriod(),
+                                        static_cast<u32>(bank->GetNumberOfCustomers()),
+                                        static_cast<u32>(bank->GetAccounts().size())});
+            file.write(name.data(), static_cast<std::streamsize>(name.size()));
+
+            for (const Customer &customer : bank->GetCustomers())
+            {
+                const std::string_view first_name = customer.GetFirstName();
+                const std::string_view last_name = customer.GetLastName();
+                WriteRecord(file, CustomerEntry{customer.GetID(), customer.GetAge(), static_cast<u32>(first_name.size()),
+                                                static_cast<u32>(last_name.size()), static_cast<u32>(customer.GetNumberOfAccounts()),
+                                                GetLimits(customer.GetVelocityTracker())});
+                file.write(first_name.data(), static_cast<std::streamsize>(first_name.size()));
+                file.write(last_name.data(), static_cast<std::streamsize>(last_name.size()));
+                for (i32 i = 0; i < customer.GetNumberOfAccounts(); i++)
+                    WriteRecord(file, *record++);
+                report.customers++;
+            }
+            report.banks++;
+        }
+        report.accounts = records.size();
+
+        file.seekp(0);
+        WriteRecord(file, header);
+        file.flush();
+        ok = ok && static_cast<bool>(file);
+        file.close();
+
+        std::error_code error;
+        if (ok)
+        {
+            report.bytes = std::filesystem::file_size(temp_path, error);
+            std::filesystem::rename(temp_path, path, error);
+        }
+        if (!ok || error)
+        {
+            std::cerr << "Error: Could not write checkpoint " << path << ".\n";
+            std::remove(temp_path.c_str());
+            return false;
+        }
+
+        report.seconds = std::chrono::duration<f64>(std::chrono::steady_clock::now() - start).count();
+        return true;
+    }
+
+    /**
+     * @brief Restores the banks saved in a checkpoint, leaving every account's history in the file.
+     *
+     * Only the directory is read, so restoring takes time in proportion to the number of accounts, not
+     * transactions. Each account's history is treated as archived in the checkpoint until it is first
+     * read (see BankAccount::LoadHistory); the audit, snapshots and queries read it from there as needed.
+     * The checkpoint is kept open for that, so saving a newer one over it is safe.
+     *
+     * @param path The checkpoint to restore.
+     * @param banks Receives the banks; must be empty.
+     * @param report Receives what was restored.
+     * @return False if the file is not a readable checkpoint, in which case no bank is restored.
+     */
+    bool RestoreCheckpoint(const std::string &path, std::vector<std::unique_ptr<Bank>> &banks, CheckpointReport &report)
+    {
+        auto start = std::chrono::steady_clock::now();
+        report = {};
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open())
+        {
+            std::cerr << "Error: " << path << " could not be opened.\n";
+            return false;
+        }
+
+        CheckpointHeader header;
+        if (!ReadRecord(file, header) || std::memcmp(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic)) != 0 ||
+            header.version != CHECKPOINT_VERSION)
+        {
+            std::cerr << "Error: " << path << " is not a checkpoint.\n";
+            return false;
+        }
+        auto histories = std::make_shared<const TransactionArchive>(path);
+        file.seekg(static_cast<std::streamoff>(header.directory_offset));
+
+        // Opening every customer and account would otherwise print a line each
+        QuietScope quiet;
+        bool ok = true;
+        std::string name, first_name, last_name;
+        for (u32 b = 0; ok && b < header.bank_count; b++)
+        {
+            BankEntry bank_entry;
+            ok = ReadRecord(file, bank_entry) && ReadString(file, bank_entry.name_length, name);
+            if (!ok)
+                break;
+
+            auto bank = std::make_unique<Bank>(name, bank_entry.bank_id);
+            bank->Restore(histories, bank_entry.interest_period);
+            bank->Reserve(bank_entry.customer_count, bank_entry.account_count);
+            for (u32 c = 0; ok && c < bank_entry.customer_count; c++)
+            {
+                CustomerEntry customer_entry;
+                ok = ReadRecord(file, customer_entry) && ReadString(file, customer_entry.first_name_length, first_name) &&
+                     ReadString(file, customer_entry.last_name_length, last_name);
+                if (!ok)
+                    break;
+
+                Customer &customer = bank->AddCustomer(first_name, last_name, customer_entry.age, customer_entry.customer_id);
+                if (!customer_entry.limits.IsUnlimited())
+                    customer.SetVelocityLimits(customer_entry.limits);
+                for (u32 a = 0; ok && a < customer_entry.account_count; a++)
+                {
+                    AccountCheckpoint record;
+                    ok = ReadRecord(file, record);
+                    if (!ok)
+                        break;
+
+                    BankAccount &account = customer.CreateBankAccount(record.account_type, record.balance, record.account_id);
+                    account.Restore(record, *histories);
+                    report.transactions += record.history.count;
+                    report.accounts++;
+                }
+                report.customers++;
+            }
+            banks.push_back(std::move(bank));
+            report.banks++;
+        }
+
+        if (!ok)
+        {
+            std::cerr << "Error: Checkpoint " << path << " is truncated or corrupt.\n";
+            banks.clear();
+            return false;
+        }
+
+        SimClock::Shared().AdvanceTo(header.clock);
+        report.bytes = std::filesystem::file_size(path);
+        report.seconds = std::chrono::duration<f64>(std::chrono::steady_clock::now() - start).count();
+        return true;
+    }
+
+    /**
+     * @brief Prints a summary of a saved or restored checkpoint.
+     * @param report The report to print.
+     * @param os The stream to print to.
+     */
+    void PrintCheckpointReport(const CheckpointReport &report, std::ostream &os)
+    {
+        const std::ios::fmtflags flags = os.flags();
+        const std::streamsize precision = os.precision();
+        os << "Banks: " << report.banks << "\n";
+        os << "Customers: " << report.customers << "\n";
+        os << "Accounts: " << report.accounts << "\n";
+        os << "Transactions: " << report.transactions << "\n";
+        os << std::fixed << std::setprecision(3) << "Checkpoint size: " << report.bytes / 1024.0 << " KiB, in "
+           << report.seconds << "s\n";
+        if (report.pause_seconds > 0.0)
+            os << "Menu paused for " << report.pause_seconds * 1000.0 << " ms\n";
+        os.flags(flags);
+        os.precision(precision);
+    }
+
+    /**
+     * @brief Returns the process-wide checkpoint writer.
+     */
+    CheckpointWriter &CheckpointWriter::Shared()
+    {
+        static CheckpointWriter writer;
+        return writer;
+    }
+
+    /**
+     * @brief Starts saving a checkpoint of every bank as it is now.
+     *
+     * Must be called between operations, from the thread that changes the banks, so that the image is consistent.
+     *
+     * @param banks The banks to save.
+     * @param path The file to write.
+     * @return False if a checkpoint is already being saved or the writer could not be started.
+     */
+    bool CheckpointWriter::Start(const std::vector<std::unique_ptr<Bank>> &banks, const std::string &path)
+    {
+        TraceSpan span("StartCheckpoint");
+        if (IsRunning())
+        {
+            std::cerr << "Error: A checkpoint to " << m_path << " is still being saved.\n";
+            return false;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        m_path = path;
+#ifdef _WIN32
+        m_succeeded = SaveCheckpoint(banks, path, m_report);
+        m_finished = true;
+#else
+        i32 result_pipe[2];
+        if (pipe(result_pipe) != 0)
+        {
+            std::cerr << "Error: Could not start the checkpoint writer.\n";
+            return false;
+        }
+
+        // Anything still buffered would otherwise be written by both processes
+        std::cout.flush();
+        std::cerr.flush();
+        const pid_t child = fork();
+        if (child < 0)
+        {
+            std::cerr << "Error: Could not start the checkpoint writer.\n";
+            close(result_pipe[0]);
+            close(result_pipe[1]);
+            return false;
+        }
+        if (child == 0)
+        {
+            // Only this thread exists in the child, and it never goes back to the menu; nor may it take the
+            // trace writer's locks, which another thread may have held at the fork
+            Tracer::Shared().Disable();
+            close(result_pipe[0]);
+            WriterResult result{};
+            result.succeeded = SaveCheckpoint(banks, path, result.report);
+            const bool sent = write(result_pipe[1], &result, sizeof(result)) == static_cast<ssize_t>(sizeof(result));
+            _exit(result.succeeded && sent ? 0 : 1); // Without running the parent's destructors
+        }
+
+        close(result_pipe[1]);
+        m_child = child;
+        m_result = result_pipe[0];
+#endif
+        m_pause_seconds = std::chrono::duration<f64>(std::chrono::steady_clock::now() - start).count();
+        return true;
+    }
+
+    /**
+     * @brief Collects the outcome of the checkpoint being saved, once it has finished.
+     * @param wait True to wait for it to finish.
+     * @param succeeded Receives whether the checkpoint was saved.
+     * @param report Receives what was saved, and how long the menu was paused.
+     * @return False if no checkpoint was started, or it is still being saved and wait is false.
+     */
+    bool CheckpointWriter::Collect(bool wait, bool &succeeded, CheckpointReport &report)
+    {
+#ifndef _WIN32
+        if (m_child >= 0)
+        {
+            i32 status = 0;
+            const pid_t done = waitpid(static_cast<pid_t>(m_child), &status, wait ? 0 : WNOHANG);
+            if (done == 0)
+                return false;
+
+            WriterResult result{};
+            const bool received = read(m_result, &result, sizeof(result)) == static_cast<ssize_t>(sizeof(result));
+            close(m_result);
+            m_child = -1;
+            m_result = -1;
+            m_succeeded = received && result.succeeded && done > 0 && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+            m_report = result.report;
+            m_finished = true;
+        }
+#endif
+        if (!m_finished)
+            return false;
+
+        m_finished = false;
+        succeeded = m_succeeded;
+        report = m_report;
+        report.pause_seconds = m_pause_seconds;
+        return true;
+    }
+}
@@ -5,17 +5,22 @@
  */
 
 #include "../include/bank_account.hpp"
+#include "../include/activity_log.hpp"
 #include "../include/account_type.hpp"
 #include "../include/transaction.hpp"
 #include "../include/customer.hpp"
+#include "../include/bank.hpp"
 #include "../include/types.hpp"
 #include "../include/global.hpp"
+#include "../include/snapshot.hpp"
+#include "../include/replication.hpp"
+#include "../include/string_pool.hpp"
+#include "../include/memory_report.hpp"
 #include <iostream>
 #include <string>
 #include <cassert>
 #include <vector>
 #include <random>
-#include <algorithm>
 
 namespace Bank
 {
@@ -26,17 +31,23 @@ namespace Bank
 
     /**
      * @brief Constructs a Customer with given first name, last name, and age. Also generates a random Customer ID.
+     * @param bank The Bank this Customer belongs to.
      * @param fName Customer's first name.
      * @param lName Customer's last name.
      * @param age Customer's age.
+     * @param customer_id The ID to assign, or 0 to generate a random one.
      */
-    Customer::Customer(const std::string &fName, const std::string &lName, i32 age)
-        : m_fName(fName), m_lName(lName), m_age(age)
+    Customer::Customer(Bank &bank, const std::string &fName, const std::string &lName, i32 age, i32 customer_id)
+        : m_bank(bank), m_fName(StringPool::Shared().Intern(fName)), m_lName(StringPool::Shared().Intern(lName)),
+          m_name(StringPool::Shared().Intern(fName + " " + lName)), m_age(age)
     {
-        // Immediately generate a unique ID for this customer
-        GenerateCustomerID();
-        std::cout << "Customer created: " << this->GetName()
-                  << " (Customer ID: " << m_customer_id << ")" << std::endl;
+        // Immediately generate a unique ID for this customer, unless one is given (e.g. by a replica)
+        if (customer_id != 0)
+            m_customer_id = customer_id;
+        else
+            GenerateCustomerID();
+        ActivityLog() << "Customer created: " << this->GetName()
+                      << " (Customer ID: " << m_customer_id << ")" << std::endl;
     }
 
     /**
@@ -45,7 +56,7 @@ namespace Bank
     Customer::~Customer()
     {
         // Notify that this customer is being deleted
-        std::cout << "Deleting customer" << std::endl;
+        ActivityLog() << "Deleting customer" << std::endl;
     }
 
     /**
@@ -53,8 +64,12 @@ namespace Bank
      */
     void Customer::GenerateCustomerID()
     {
+        // Draw again on the rare collision, which the Bank's index makes cheap to detect
         std::random_device rd; // For random seeding
-        m_customer_id = rd() % (MAX_CUSTOMER_ID - MIN_CUSTOMER_ID + 1) + MIN_CUSTOMER_ID;
+        do
+        {
+            m_customer_id = rd() % (MAX_CUSTOMER_ID - MIN_CUSTOMER_ID + 1) + MIN_CUSTOMER_ID;
+        } while (m_bank.FindCustomer(m_customer_id));
     }
 
     /**
@@ -70,35 +85,64 @@ namespace Bank
     }
 
     /**
-     * @brief Creates a new BankAccount (Checking or Saving) for this Customer and inserts it in sorted order by ID.
+     * @brief Creates a new BankAccount (Checking or Saving) for this Customer, held by the Customer's Bank.
      * @param account_type The type of the account (CHECKING or SAVING).
      * @param account_initial_balance The initial balance of the account.
+     * @param account_id The ID to assign, or an invalid ID to generate a random one.
+     * @return A reference to the newly created BankAccount.
      */
-    void Customer::CreateBankAccount(AccountType account_type, f64 account_initial_balance)
+    BankAccount &Customer::CreateBankAccount(AccountType account_type, f64 account_initial_balance, AccountID account_id)
     {
-        // If our vector wasn't preallocated, reserve space for up to 5 accounts
-        if (m_accounts.capacity() == 0)
-        {
-            m_accounts.reserve(5);
-        }
+        BankAccount &account = m_bank.OpenAccount(*this, account_type, account_initial_balance, account_id);
+        m_accounts.push_back(account.GetHandle());
+        SnapshotManager::Shared().MarkDirty(*this);
+        ReplicationLog::Shared().LogAccountCreated(account);
+        return account;
+    }
 
-        // Use a unique_ptr to store new Checking/Saving account
-        std::unique_ptr<BankAccount> new_account;
+    /**
+     * @brief Returns this Customer's accounts, in the order they were opened.
+     * @return A view that resolves the account handles in the Bank's account map.
+     */
+    SlotRange<BankAccount> Customer::GetAccounts() const
+    {
+        return SlotRange<BankAccount>(m_bank.GetAccounts(), m_accounts.begin(), m_accounts.end());
+    }
 
-        if (account_type == AccountType::CHECKING)
-            new_account = std::make_unique<CheckingAccount>(account_type, *this, account_initial_balance);
-        else if (account_type == AccountType::SAVING)
-            new_account = std::make_unique<SavingAccount>(account_type, *this, account_initial_balance);
+    /**
+     * @brief Sets limits on withdrawals across all of this Customer's accounts, replacing any previous ones.
+     *
+     * Activity is counted from the moment limits are first set. Unlimited limits release the tracker.
+     *
+     * @param limits The new limits.
+     */
+    void Customer::SetVelocityLimits(const VelocityLimits &limits)
+    {
+        if (limits.IsUnlimited())
+            m_velocity.reset();
+        else if (m_velocity)
+            m_velocity->SetLimits(limits);
+        else
+            m_velocity = std::make_unique<VelocityTracker>(limits);
 
-        // Insert the account in the correct sorted position
-        auto it = std::lower_bound(
-            m_accounts.begin(), m_accounts.end(), new_account,
-            [](const std::unique_ptr<BankAccount> &a, const std::unique_ptr<BankAccount> &b)
-            {
-                return a->GetID() < b->GetID();
-            });
+        ReplicationLog::Shared().LogVelocityLimits(*this, nullptr, limits);
+    }
 
-        m_accounts.insert(it, std::move(new_account));
+    /**
+     * @brief Adds what this Customer allocates beyond its slot: the list of account handles and any velocity tracker.
+     * @param memory The breakdown to add to.
+     * @return The bytes added.
+     */
+    size_t Customer::MeasureMemory(BankMemory &memory) const
+    {
+        // The first few handles are stored inline, so they are already counted in this Customer's slot
+        MemoryUsage &usage = memory[MemoryCategory::CUSTOMERS];
+        const size_t before = usage.bytes;
+        if (!m_accounts.IsInline())
+            usage.Add(0, m_accounts.size() * sizeof(AccountHandle), m_accounts.capacity() * sizeof(AccountHandle));
+        if (m_velocity)
+            usage.Add(0, sizeof(VelocityTracker), sizeof(VelocityTracker));
+        return usage.bytes - before;
     }
 
     /**
@@ -109,13 +153,14 @@ namespace Bank
         // Print basic info for each account (ID and balance)
         std::cout << this->GetName() << "'s accounts:" << std::endl;
         std::cout << "----------------------------" << std::endl;
-        for (size_t i = 0; i < m_accounts.size(); i++)
+        size_t i = 0;
+        for (const BankAccount &account : GetAccounts())
         {
-            std::cout << "Account #" << (i + 1) << std::endl;
-            std::cout << "Account ID: " << m_accounts[i]->GetID() << std::endl;
+            std::cout << "Account #" << ++i << std::endl;
+            std::cout << "Account ID: " << account.GetID() << std::endl;
             std::cout << "Account balance: $"
                       << std::fixed << std::setprecision(2)
-                      << m_accounts[i]->GetBalance() << std::endl;
+                      << account.GetBalance() << std::endl;
             std::cout << "----------------------------" << std::endl;
         }
     }
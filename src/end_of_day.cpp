@@ -0,0 +1,392 @@
+/**
+ * @file end_of_day.cpp
+ * @brief This file implements the pipelined end-of-day batch (interest, overdraft fees, reconciliation
+ *        and export) over every bank, customer and account.
+ */
+
+#include "../include/end_of_day.hpp"
+#include "../include/bank_account.hpp"
+#include "../include/customer.hpp"
+#include "../include/global.hpp"
+#include "../include/sim_clock.hpp"
+#include "../include/trace.hpp"
+#include "../include/utilities.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <unordered_set>
+
+namespace Bank
+{
+    namespace
+    {
+        std::atomic<bool> g_stop_requested{false};
+
+        // Trace span names, by stage
+        constexpr const char *STAGE_SPANS[END_OF_DAY_STAGES] = {"EndOfDay Interest", "EndOfDay Overdraft Fees",
+                                                                "EndOfDay Reconciliation", "EndOfDay Export"};
+
+        /**
+         * @brief SIGINT handler installed for the duration of a run; stages stop at the next batch boundary.
+         */
+        void RequestStop(int)
+        {
+            g_stop_requested.store(true);
+        }
+    }
+
+    /**
+     * @class EndOfDay
+     * @brief Runs and, if interrupted, resumes the end-of-day pipeline.
+     */
+
+    /**
+     * @brief Returns the process-wide end-of-day state, which survives between runs so they can resume.
+     * @return A reference to the shared EndOfDay.
+     */
+    EndOfDay &EndOfDay::Shared()
+    {
+        static EndOfDay end_of_day;
+        return end_of_day;
+    }
+
+    /**
+     * @brief Starts a fresh run: rolls every bank's interest period and lays out the work in batches.
+     * @param banks A const reference to a vector of unique_ptr to Bank objects.
+     */
+    void EndOfDay::Begin(const std::vector<std::unique_ptr<Bank>> &banks)
+    {
+        m_work.clear();
+        for (const auto &bank : banks)
+        {
+            // Each bank contributes its header line, then one item per customer
+            m_work.push_back({bank.get(), nullptr});
+            for (Customer &customer : bank->GetCustomers())
+                m_work.push_back({bank.get(), &customer});
+
+            // O(1) per bank; accounts compound as the interest stage touches them
+            bank->ApplyInterestToAllAccounts();
+        }
+
+        m_batch_count = (m_work.size() + END_OF_DAY_BATCH_SIZE - 1) / END_OF_DAY_BATCH_SIZE;
+        m_business_date = SimClock::Shared().Now();
+        m_export_path = "eod_" + SimClock::FormatDate(m_business_date) + ".txt";
+        m_export_offset = 0;
+        m_completed_batches.fill(0);
+        m_items.fill(0);
+        m_busy_seconds.fill(0.0);
+        m_elapsed_seconds = 0.0;
+        m_fees_charged = 0;
+        m_discrepancies.clear();
+        m_in_progress = true;
+    }
+
+    /**
+     * @brief Adds to an interrupted run the banks and customers created since it began, so no stage skips them.
+     *
+     * They are appended after the existing work, starting a batch of their own so that batches some stage
+     * already completed are left as they were. Each group is exported under its bank's line, which is
+     * therefore repeated for a bank that gained customers. Interest is not rolled over for a bank created
+     * after the run began.
+     *
+     * @param banks A const reference to a vector of unique_ptr to Bank objects.
+     * @return The number of customers added.
+     */
+    size_t EndOfDay::ExtendWork(const std::vector<std::unique_ptr<Bank>> &banks)
+    {
+        std::unordered_set<const Bank *> known_banks;
+        std::unordered_set<const Customer *> known_customers;
+        known_customers.reserve(m_work.size());
+        for (const WorkItem &item : m_work)
+        {
+            if (item.customer)
+                known_customers.insert(item.customer);
+            else if (item.bank)
+                known_banks.insert(item.bank);
+        }
+
+        std::vector<WorkItem> added;
+        size_t customers = 0;
+        for (const auto &bank : banks)
+        {
+            bool has_header = false;
+            if (!known_banks.count(bank.get()))
+            {
+                added.push_back({bank.get(), nullptr});
+                has_header = true;
+            }
+            for (Customer &customer : bank->GetCustomers())
+            {
+                if (known_customers.count(&customer))
+                    continue;
+                if (!has_header)
+                {
+                    added.push_back({bank.get(), nullptr});
+                    has_header = true;
+                }
+                added.push_back({bank.get(), &customer});
+                customers++;
+            }
+        }
+        if (added.empty())
+            return 0;
+
+        m_work.resize(m_batch_count * END_OF_DAY_BATCH_SIZE, WorkItem{nullptr, nullptr});
+        m_work.insert(m_work.end(), added.begin(), added.end());
+        m_batch_count = (m_work.size() + END_OF_DAY_BATCH_SIZE - 1) / END_OF_DAY_BATCH_SIZE;
+        return customers;
+    }
+
+    /**
+     * @brief Runs one stage over one batch of work items.
+     * @param stage The stage to run.
+     * @param batch The index of the batch to process.
+     * @param export_stream The export file, used by the EXPORT stage only.
+     * @return The number of accounts processed.
+     */
+    size_t EndOfDay::ProcessBatch(EndOfDayStage stage, size_t batch, std::ostream &export_stream)
+    {
+        size_t begin = batch * END_OF_DAY_BATCH_SIZE;
+        size_t end = std::min(m_work.size(), begin + END_OF_DAY_BATCH_SIZE);
+        size_t accounts = 0;
+
+        for (size_t i = begin; i < end; i++)
+        {
+            const WorkItem &item = m_work[i];
+            if (!item.bank)
+                continue; // Padding before work added on resume
+            if (!item.customer)
+            {
+                if (stage == EndOfDayStage::EXPORT)
+                    WriteBankRecord(export_stream, *item.bank);
+                continue;
+            }
+
+            switch (stage)
+            {
+            case EndOfDayStage::INTEREST:
+                for (const BankAccount &account : item.customer->GetAccounts())
+                    account.GetBalance(); // Settles any interest periods the account has missed
+                break;
+            case EndOfDayStage::OVERDRAFT_FEES:
+                for (BankAccount &account : item.customer->GetAccounts())
+                {
+                    // Specialised per kind of account, so only the kinds that charge fees check for one
+                    VisitAccount(
+                        account, [this](auto &kind)
+                        {
+                            if constexpr (std::decay_t<decltype(kind)>::Policy::CHARGES_OVERDRAFT_FEE)
+                            {
+                                if (kind.AssessOverdraftFee())
+                                    m_fees_charged++;
+                            }
+                        });
+                }
+                break;
+            case EndOfDayStage::RECONCILIATION:
+                AuditCustomer(item.bank->GetID(), *item.customer, m_discrepancies);
+                break;
+            case EndOfDayStage::EXPORT:
+                WriteCustomerRecord(export_stream, *item.customer);
+                break;
+            }
+            accounts += item.customer->GetNumberOfAccounts();
+        }
+        return accounts;
+    }
+
+    /**
+     * @brief Runs the pipeline to completion, or until interrupted with Ctrl+C.
+     *
+     * Stage s may process batch b only once stage s - 1 has finished it. The first stage is also held
+     * at most END_OF_DAY_PIPELINE_DEPTH batches ahead of the export, so the working set stays small.
+     *
+     * @param banks A const reference to a vector of unique_ptr to Bank objects.
+     * @return True if every stage completed, false if the run was interrupted and can be resumed.
+     */
+    bool EndOfDay::Run(const std::vector<std::unique_ptr<Bank>> &banks)
+    {
+        if (m_in_progress)
+        {
+            if (size_t added = ExtendWork(banks))
+                std::cout << "Added " << added << " customer(s) created since the run began.\n";
+            std::cout << "Resuming end of day for " << SimClock::FormatDate(m_business_date) << " from batch ";
+            for (size_t s = 0; s < END_OF_DAY_STAGES; s++)
+                std::cout << (s ? "/" : "") << m_completed_batches[s];
+            std::cout << " of " << m_batch_count << ".\n";
+        }
+        else
+        {
+            Begin(banks);
+        }
+
+        // Drop any export output written after the last completed batch, then append to it
+        if (std::filesystem::exists(m_export_path))
+            std::filesystem::resize_file(m_export_path, m_export_offset);
+        std::ofstream export_stream(m_export_path, std::ios::app);
+        if (!export_stream.is_open())
+        {
+            std::cerr << m_export_path << " could not be opened!" << std::endl;
+            return false;
+        }
+
+        g_stop_requested.store(false);
+        auto previous_handler = std::signal(SIGINT, RequestStop);
+
+        std::mutex mutex;
+        std::condition_variable progressed;
+        std::exception_ptr failure;
+        auto start = std::chrono::steady_clock::now();
+
+        auto stage_loop = [&](size_t s)
+        {
+            const EndOfDayStage stage = static_cast<EndOfDayStage>(s);
+            try
+            {
+                for (size_t batch = m_completed_batches[s]; batch < m_batch_count; batch++)
+                {
+                    {
+                        std::unique_lock<std::mutex> lock(mutex);
+                        progressed.wait(lock, [&]()
+                                        { return g_stop_requested.load() ||
+                                                 ((s == 0 || batch < m_completed_batches[s - 1]) &&
+                                                  (s != 0 || batch < m_completed_batches[END_OF_DAY_STAGES - 1] + END_OF_DAY_PIPELINE_DEPTH)); });
+                        if (g_stop_requested.load())
+                            return;
+                    }
+
+                    auto batch_start = std::chrono::steady_clock::now();
+                    TraceSpan span(STAGE_SPANS[s]);
+                    size_t accounts = ProcessBatch(stage, batch, export_stream);
+                    if (stage == EndOfDayStage::EXPORT)
+                        export_stream.flush();
+                    f64 busy = std::chrono::duration<f64>(std::chrono::steady_clock::now() - batch_start).count();
+                    span.End();
+
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        m_items[s] += accounts;
+                        m_busy_seconds[s] += busy;
+                        m_completed_batches[s] = batch + 1;
+                        if (stage == EndOfDayStage::EXPORT)
+                            m_export_offset = static_cast<u64>(export_stream.tellp());
+                    }
+                    progressed.notify_all();
+                }
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!failure)
+                    failure = std::current_exception();
+                g_stop_requested.store(true);
+            }
+            progressed.notify_all();
+        };
+
+        std::vector<std::thread> stages;
+        for (size_t s = 0; s < END_OF_DAY_STAGES; s++)
+            stages.emplace_back(stage_loop, s);
+        for (auto &thread : stages)
+            thread.join();
+
+        std::signal(SIGINT, previous_handler);
+        m_elapsed_seconds += std::chrono::duration<f64>(std::chrono::steady_clock::now() - start).count();
+
+        if (failure)
+        {
+            try
+            {
+                std::rethrow_exception(failure);
+            }
+            catch (const std::exception &e)
+            {
+                std::cerr << "Error: End of day failed: " << e.what() << "\n";
+            }
+        }
+
+        bool finished = m_completed_batches[END_OF_DAY_STAGES - 1] == m_batch_count;
+        m_in_progress = !finished;
+        SaveProgress();
+        return finished;
+    }
+
+    /**
+     * @brief Records the per-stage progress in 'eod_progress.txt' so operators can see where a run stopped.
+     */
+    void EndOfDay::SaveProgress() const
+    {
+        std::ofstream ofs("eod_progress.txt");
+        if (!ofs.is_open())
+        {
+            std::cerr << "eod_progress.txt could not be opened!" << std::endl;
+            return;
+        }
+
+        ofs << "Business date: " << SimClock::FormatDate(m_business_date) << "\n";
+        ofs << "Status: " << (m_in_progress ? "INTERRUPTED" : "COMPLETE") << "\n";
+        ofs << "Export: " << m_export_path << " (" << m_export_offset << " bytes)\n";
+        for (size_t s = 0; s < END_OF_DAY_STAGES; s++)
+        {
+            ofs << EndOfDayStageToString(static_cast<EndOfDayStage>(s)) << ": "
+                << m_completed_batches[s] << "/" << m_batch_count << " batches\n";
+        }
+    }
+
+    /**
+     * @brief Prints per-stage timings, fees charged and reconciliation findings for the latest run.
+     * @param os The stream to print to.
+     */
+    void EndOfDay::PrintReport(std::ostream &os) const
+    {
+        const std::ios::fmtflags flags = os.flags();
+        const std::streamsize precision = os.precision();
+        os << std::left << std::setw(16) << "Stage" << std::right << std::setw(10) << "Batches"
+           << std::setw(12) << "Accounts" << std::setw(12) << "Busy (s)" << "\n";
+        for (size_t s = 0; s < END_OF_DAY_STAGES; s++)
+        {
+            os << std::left << std::setw(16) << EndOfDayStageToString(static_cast<EndOfDayStage>(s))
+               << std::right << std::setw(10) << m_completed_batches[s]
+               << std::setw(12) << m_items[s]
+               << std::setw(12) << std::fixed << std::setprecision(4) << m_busy_seconds[s] << "\n";
+        }
+        os << "Wall time: " << std::fixed << std::setprecision(4) << m_elapsed_seconds << "s\n";
+        os << "Overdraft fees charged: " << m_fees_charged << "\n";
+
+        for (const auto &discrepancy : m_discrepancies)
+            PrintAuditDiscrepancy(discrepancy, os);
+        os << "Reconciliation: " << m_discrepancies.size() << " discrepancy(ies) found.\n";
+        os << "Exported to " << m_export_path << "\n";
+        os.flags(flags);
+        os.precision(precision);
+    }
+
+    /**
+     * @brief Returns a string representation of an EndOfDayStage.
+     * @param stage The stage to convert.
+     * @return "Interest", "Overdraft fees", "Reconciliation" or "Export".
+     */
+    std::string EndOfDayStageToString(EndOfDayStage stage)
+    {
+        switch (stage)
+        {
+        case EndOfDayStage::INTEREST:
+            return "Interest";
+        case EndOfDayStage::OVERDRAFT_FEES:
+            return "Overdraft fees";
+        case EndOfDayStage::RECONCILIATION:
+            return "Reconciliation";
+        default:
+            return "Export";
+        }
+    }
+}
@@ -0,0 +1,158 @@
+/**
+ * @file idempotency.cpp
+ * @brief This file implements the IdempotencyFilter, which rejects transaction submissions whose request
+ *        key has already been used.
+ */
+
+#include "../include/idempotency.hpp"
+#include "../include/global.hpp"
+#include "../include/sim_clock.hpp"
+#include <algorithm>
+
+namespace Bank
+{
+    /**
+     * @class IdempotencyFilter
+     * @brief A Bloom filter in front of a bounded, expiring set of request-key fingerprints.
+     */
+
+    /**
+     * @brief Constructs an empty filter.
+     */
+    IdempotencyFilter::IdempotencyFilter() : m_bloom(IDEMPOTENCY_BLOOM_BITS / 64, 0)
+    {
+        m_keys.reserve(IDEMPOTENCY_CAPACITY);
+    }
+
+    /**
+     * @brief Returns the process-wide filter used by BankAccount::SubmitTransaction.
+     */
+    IdempotencyFilter &IdempotencyFilter::Shared()
+    {
+        static IdempotencyFilter filter;
+        return filter;
+    }
+
+    /**
+     * @brief Hashes a key to 64 bits with FNV-1a followed by a final mix, so both halves are well spread.
+     */
+    u64 IdempotencyFilter::Fingerprint(const std::string &key)
+    {
+        u64 hash = 14'695'981'039'346'656'037ULL;
+        for (unsigned char c : key)
+        {
+            hash ^= c;
+            hash *= 1'099'511'628'211ULL;
+        }
+
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdULL;
+        hash ^= hash >> 33;
+        return hash;
+    }
+
+    /**
+     * @brief Returns false if the fingerprint was certainly never inserted.
+     */
+    bool IdempotencyFilter::BloomMayContain(u64 fingerprint) const
+    {
+        // Double hashing: probe i is h1 + i * h2
+        u64 h1 = fingerprint, h2 = (fingerprint >> 32) | 1;
+        for (size_t i = 0; i < IDEMPOTENCY_BLOOM_HASHES; i++)
+        {
+            u64 bit = (h1 + i * h2) % IDEMPOTENCY_BLOOM_BITS;
+            if (!(m_bloom[bit / 64] & (1ULL << (bit % 64))))
+                return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Sets the fingerprint's bits in the Bloom filter.
+     */
+    void IdempotencyFilter::BloomInsert(u64 fingerprint)
+    {
+        u64 h1 = fingerprint, h2 = (fingerprint >> 32) | 1;
+        for (size_t i = 0; i < IDEMPOTENCY_BLOOM_HASHES; i++)
+        {
+            u64 bit = (h1 + i * h2) % IDEMPOTENCY_BLOOM_BITS;
+            m_bloom[bit / 64] |= 1ULL << (bit % 64);
+        }
+        m_bloom_insertions++;
+    }
+
+    /**
+     * @brief Forgets fingerprints whose time is up, then the oldest ones while the set is full.
+     * @param now The current simulated time.
+     */
+    void IdempotencyFilter::Expire(i64 now)
+    {
+        while (!m_expiry.empty() && (m_expiry.front().second <= now || m_keys.size() >= IDEMPOTENCY_CAPACITY))
+        {
+            m_keys.erase(m_expiry.front().first);
+            m_expiry.pop_front();
+        }
+
+        // Bits of forgotten keys stay set; start over from the live set before they crowd the filter
+        if (m_bloom_insertions >= 2 * IDEMPOTENCY_CAPACITY)
+        {
+            std::fill(m_bloom.begin(), m_bloom.end(), 0);
+            m_bloom_insertions = 0;
+            for (u64 fingerprint : m_keys)
+                BloomInsert(fingerprint);
+        }
+    }
+
+    /**
+     * @brief Records a request key, unless it is already remembered.
+     * @param key The client's request key.
+     * @return True if the key is new (the request should be applied), false if it is a repeat.
+     */
+    bool IdempotencyFilter::CheckAndRecord(const std::string &key)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const i64 now = SimClock::Shared().Now();
+        Expire(now);
+
+        const u64 fingerprint = Fingerprint(key);
+        if (!BloomMayContain(fingerprint))
+            m_bloom_negatives++;
+        else if (m_keys.count(fingerprint))
+        {
+            m_duplicates++;
+            return false;
+        }
+
+        m_keys.insert(fingerprint);
+        m_expiry.emplace_back(fingerprint, now + IDEMPOTENCY_TTL_SECONDS);
+        BloomInsert(fingerprint);
+        return true;
+    }
+
+    /**
+     * @brief Returns how many keys are currently remembered.
+     */
+    size_t IdempotencyFilter::GetRememberedKeys()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_keys.size();
+    }
+
+    /**
+     * @brief Returns how many lookups the Bloom filter answered without consulting the set.
+     */
+    u64 IdempotencyFilter::GetBloomNegatives()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_bloom_negatives;
+    }
+
+    /**
+     * @brief Returns how many repeated keys have been rejected.
+     */
+    u64 IdempotencyFilter::GetDuplicatesRejected()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_duplicates;
+    }
+}
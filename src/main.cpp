@@ -1,15 +1,86 @@
 #include "../include/utilities.hpp"
 #include "../include/global.hpp"
+#include "../include/shard.hpp"
+#include "../include/replication.hpp"
+#include "../include/checkpoint.hpp"
+#include "../include/trace.hpp"
 #include <iostream>
 #include <vector>
 #include <memory>
 #include <string>
+#include <cstring>
+#include <cstdlib>
 
-i32 main()
+i32 main(i32 argc, char *argv[])
 {
+    // "--shards N" runs the sharded coordinator console instead of the menu
+    if (argc == 3 && std::strcmp(argv[1], "--shards") == 0)
+    {
+        i32 shard_count = std::atoi(argv[2]);
+        if (shard_count < MIN_SHARDS || shard_count > MAX_SHARDS)
+        {
+            std::cerr << "Error: Shard count must be between " << MIN_SHARDS << " and " << MAX_SHARDS << ".\n";
+            return 1;
+        }
+        return Bank::RunShardedMode(static_cast<size_t>(shard_count));
+    }
+
+    // "--standby <log>" runs a read-only replica of a primary started with "--replicate <log>"
+    if (argc == 3 && std::strcmp(argv[1], "--standby") == 0)
+        return Bank::RunStandbyMode(argv[2]);
+
+    // The menu's options combine: "--replicate <log>", "--trace <file>" and "--restore <checkpoint>", in any order
+    const char *replication_path = nullptr;
+    const char *trace_path = nullptr;
+    const char *checkpoint_path = nullptr;
+    for (i32 i = 1; i < argc; i += 2)
+    {
+        const char **path = std::strcmp(argv[i], "--replicate") == 0 ? &replication_path
+                            : std::strcmp(argv[i], "--trace") == 0   ? &trace_path
+                            : std::strcmp(argv[i], "--restore") == 0 ? &checkpoint_path
+                                                                     : nullptr;
+        if (!path || i + 1 == argc)
+        {
+            std::cerr << "Error: Usage: " << argv[0] << " [--replicate <log>] [--trace <file>] [--restore <checkpoint>]"
+                      << ", or " << argv[0] << " --shards N, or " << argv[0] << " --standby <log>.\n";
+            return 1;
+        }
+        *path = argv[i + 1];
+    }
+
+    // A standby replays every record from the start, and a checkpoint cannot be sent to it as records
+    if (replication_path && checkpoint_path)
+    {
+        std::cerr << "Error: --replicate cannot be combined with --restore.\n";
+        return 1;
+    }
+
+    // "--trace <file>" writes a Chrome trace-event timeline of every operation to <file>
+    if (trace_path && !Bank::Tracer::Shared().Open(trace_path))
+    {
+        std::cerr << "Error: Could not open trace file " << trace_path << ".\n";
+        return 1;
+    }
+
+    if (replication_path && !Bank::ReplicationLog::Shared().Open(replication_path))
+    {
+        std::cerr << "Error: Could not open replication log " << replication_path << ".\n";
+        return 1;
+    }
+
     // A container to hold all the banks in the system
     std::vector<std::unique_ptr<Bank::Bank>> banks;
 
+    // "--restore <checkpoint>" starts from a saved checkpoint; account histories stay on disk until read
+    if (checkpoint_path)
+    {
+        Bank::CheckpointReport report;
+        if (!Bank::RestoreCheckpoint(checkpoint_path, banks, report))
+            return 1;
+        std::cout << "Restored from " << checkpoint_path << "\n";
+        Bank::PrintCheckpointReport(report, std::cout);
+    }
+
     bool is_running = true;
     int choice = 0;
 
@@ -42,6 +113,12 @@ ______                _          ___  ___
         DisplayMenu(choice, is_running, banks);
     } while (is_running);
 
+    if (Bank::Tracer::Shared().IsEnabled())
+    {
+        const u64 spans = Bank::Tracer::Shared().Close();
+        std::cout << "Wrote " << spans << " trace span(s) to " << Bank::Tracer::Shared().GetPath() << "\n";
+    }
+
     std::cout << "Goodbye!" << std::endl;
 
     return 0;
@@ -0,0 +1,202 @@
+/**
+ * @file memory_report.cpp
+ * @brief This file implements memory accounting: how many bytes each bank holds per kind of entity,
+ *        and how much of that is reserved capacity that nothing uses.
+ */
+
+#include "../include/memory_report.hpp"
+#include "../include/bank.hpp"
+#include "../include/global.hpp"
+#include "../include/string_pool.hpp"
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+namespace Bank
+{
+    namespace
+    {
+        constexpr std::array<std::string_view, static_cast<size_t>(MemoryCategory::COUNT)> CATEGORY_NAMES = {
+            "Customers", "Accounts", "Transactions", "Indexes"};
+
+        /**
+         * @brief Formats a byte count with a binary unit, e.g. "1.50 MiB".
+         */
+        std::string FormatBytes(size_t bytes)
+        {
+            constexpr std::array<const char *, 4> units = {"B", "KiB", "MiB", "GiB"};
+            f64 value = static_cast<f64>(bytes);
+            size_t unit = 0;
+            while (value >= 1024.0 && unit + 1 < units.size())
+            {
+                value /= 1024.0;
+                unit++;
+            }
+
+            std::ostringstream oss;
+            oss << std::fixed << std::setprecision(unit == 0 ? 0 : 2) << value << ' ' << units[unit];
+            return oss.str();
+        }
+
+        /**
+         * @brief Prints one row of the table: a label, an object count, bytes held and bytes wasted.
+         */
+        void PrintRow(std::ostream &os, std::string_view label, const MemoryUsage &usage)
+        {
+            os << "    " << std::left << std::setw(16) << label << std::right
+               << std::setw(12) << usage.objects
+               << std::setw(14) << FormatBytes(usage.bytes)
+               << std::setw(14) << FormatBytes(usage.wasted_bytes) << "\n";
+        }
+
+        /**
+         * @brief Keeps the MEMORY_REPORT_LARGEST entries with the most bytes, as a min-heap so the smallest is replaced first.
+         */
+        template <typename T>
+        void KeepLargest(std::vector<T> &largest, T entry)
+        {
+            auto larger = [](const T &a, const T &b)
+            { return a.bytes > b.bytes; };
+            if (largest.size() < MEMORY_REPORT_LARGEST)
+            {
+                largest.push_back(entry);
+                std::push_heap(largest.begin(), largest.end(), larger);
+            }
+            else if (entry.bytes > largest.front().bytes)
+            {
+                std::pop_heap(largest.begin(), largest.end(), larger);
+                largest.back() = entry;
+                std::push_heap(largest.begin(), largest.end(), larger);
+            }
+        }
+
+        /**
+         * @brief Turns a heap kept by KeepLargest into a list, largest first.
+         */
+        template <typename T>
+        void SortLargest(std::vector<T> &largest)
+        {
+            std::sort(largest.begin(), largest.end(), [](const T &a, const T &b)
+                      { return a.bytes > b.bytes; });
+        }
+    }
+
+    /**
+     * @brief Returns the bank's memory across all categories.
+     */
+    MemoryUsage BankMemory::Total() const
+    {
+        MemoryUsage total;
+        for (const MemoryUsage &usage : categories)
+            total += usage;
+        return total;
+    }
+
+    /**
+     * @brief Counts one customer's bytes towards the average, and keeps it if it is among the largest.
+     * @param customer_id The customer's ID.
+     * @param bytes What the customer holds, its accounts included.
+     */
+    void BankMemory::AddCustomer(i32 customer_id, size_t bytes)
+    {
+        customer_bytes += bytes;
+        KeepLargest(largest_customers, CustomerMemory{customer_id, bytes});
+    }
+
+    /**
+     * @brief Counts one account's bytes towards the average, and keeps it if it is among the largest.
+     * @param account_id The account's ID.
+     * @param bytes What the account holds.
+     */
+    void BankMemory::AddAccount(AccountID account_id, size_t bytes)
+    {
+        account_bytes += bytes;
+        KeepLargest(largest_accounts, AccountMemory{account_id, bytes});
+    }
+
+    /**
+     * @brief Measures the memory held by every bank, and by the shared name pool.
+     *
+     * Each class reports what it owns (see Bank::MeasureMemory), so the figures follow the data structures
+     * actually in use rather than what was requested from the allocator. Allocator overhead is not included.
+     *
+     * @param banks A const reference to a vector of unique_ptr to Bank objects.
+     * @return The breakdown per bank, in bank order, with each bank's largest customers and accounts.
+     */
+    MemoryReport MeasureMemory(const std::vector<std::unique_ptr<Bank>> &banks)
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        MemoryReport report;
+        report.banks.resize(banks.size());
+        for (size_t i = 0; i < banks.size(); i++)
+        {
+            banks[i]->MeasureMemory(report.banks[i]);
+            SortLargest(report.banks[i].largest_customers);
+            SortLargest(report.banks[i].largest_accounts);
+        }
+
+        StringPool &pool = StringPool::Shared();
+        report.interned_names.Add(pool.GetStringCount(), pool.GetBytes(), pool.GetReservedBytes());
+
+        report.elapsed_seconds = std::chrono::duration<f64>(std::chrono::steady_clock::now() - start).count();
+        return report;
+    }
+
+    /**
+     * @brief Prints a table per bank of objects, bytes held and bytes wasted for each category, then the
+     *        average and largest customers and accounts, then the totals.
+     * @param report The report to print.
+     * @param os The stream to print to.
+     */
+    void PrintMemoryReport(const MemoryReport &report, std::ostream &os)
+    {
+        const std::ios::fmtflags flags = os.flags();
+        const std::streamsize precision = os.precision();
+        MemoryUsage overall;
+        for (const BankMemory &bank : report.banks)
+        {
+            os << "Bank " << bank.bank_id << " (" << bank.bank_name << ")\n";
+            os << "    " << std::left << std::setw(16) << "Category" << std::right << std::setw(12) << "Objects"
+               << std::setw(14) << "Bytes" << std::setw(14) << "Wasted" << "\n";
+            for (size_t i = 0; i < CATEGORY_NAMES.size(); i++)
+                PrintRow(os, CATEGORY_NAMES[i], bank.categories[i]);
+
+            MemoryUsage total = bank.Total();
+            total.objects = bank[MemoryCategory::CUSTOMERS].objects + bank[MemoryCategory::ACCOUNTS].objects +
+                            bank[MemoryCategory::TRANSACTIONS].objects;
+            PrintRow(os, "Total", total);
+
+            const size_t customers = bank[MemoryCategory::CUSTOMERS].objects;
+            const size_t accounts = bank[MemoryCategory::ACCOUNTS].objects;
+            if (customers > 0)
+            {
+                os << "    Per customer (accounts included): " << FormatBytes(bank.customer_bytes / customers) << " on average; largest:\n";
+                for (const CustomerMemory &customer : bank.largest_customers)
+                    os << "        " << std::left << std::setw(12) << customer.customer_id << std::right
+                       << std::setw(14) << FormatBytes(customer.bytes) << "\n";
+            }
+            if (accounts > 0)
+            {
+                os << "    Per account: " << FormatBytes(bank.account_bytes / accounts) << " on average; largest:\n";
+                for (const AccountMemory &account : bank.largest_accounts)
+                    os << "        " << std::left << std::setw(12) << account.account_id << std::right
+                       << std::setw(14) << FormatBytes(account.bytes) << "\n";
+            }
+            os << "\n";
+            overall += total;
+        }
+
+        os << "Shared\n";
+        PrintRow(os, "Interned names", report.interned_names);
+        overall += report.interned_names;
+
+        os << "\nTotal held: " << FormatBytes(overall.bytes) << ", of which wasted: " << FormatBytes(overall.wasted_bytes);
+        if (overall.bytes > 0)
+            os << " (" << std::fixed << std::setprecision(1) << 100.0 * overall.wasted_bytes / overall.bytes << "%)";
+        os << "\nMeasured in " << std::fixed << std::setprecision(3) << report.elapsed_seconds << "s.\n";
+        os.flags(flags);
+        os.precision(precision);
+    }
+}
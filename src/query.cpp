@@ -0,0 +1,292 @@
+/**
+ * @file query.cpp
+ * @brief This file implements ad-hoc transaction queries over a snapshot: a parallel scan that uses the
+ *        index of each sealed history block to skip data, with totals by group and rows streamed in pages.
+ */
+
+#include "../include/query.hpp"
+#include "../include/global.hpp"
+#include "../include/thread_pool.hpp"
+#include "../include/trace.hpp"
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <mutex>
+
+namespace Bank
+{
+    namespace
+    {
+        /**
+         * @brief Lists the accounts a query has to scan, in bank, customer and account order.
+         * @param stats Receives the number of accounts ruled out without reading their history.
+         */
+        std::vector<QueryTarget> CollectTargets(const SystemImage &snapshot, const TransactionQuery &query, QueryStats &stats)
+        {
+            std::vector<QueryTarget> targets;
+            for (const auto &bank : snapshot.banks)
+            {
+                for (const auto &customer : bank->customers)
+                {
+                    const bool in_scope = (query.bank_id == 0 || bank->bank_id == query.bank_id) &&
+                                          (query.customer_id == 0 || customer->customer_id == query.customer_id);
+                    for (const auto &account : customer->accounts)
+                    {
+                        if (in_scope && query.MatchesAccount(account->account_type))
+                            targets.push_back({bank->bank_id, customer->customer_id, account.get()});
+                        else
+                            stats.accounts_skipped++;
+                    }
+                }
+            }
+            return targets;
+        }
+
+        /**
+         * @brief Returns the records of a sealed block that the query's type and validity conditions could match.
+         */
+        u64 SelectRecords(const TransactionBlock &block, const TransactionQuery &query)
+        {
+            u64 selection = 0;
+            for (u32 type = 0; type < TRANSACTION_TYPES; type++)
+                if (query.MatchesType(static_cast<TransactionType>(type)))
+                    selection |= block.GetTypeBits(static_cast<TransactionType>(type));
+
+            if (query.validity == QueryValidity::VALID_ONLY)
+                selection &= ~block.GetInvalidBits();
+            else if (query.validity == QueryValidity::INVALID_ONLY)
+                selection &= block.GetInvalidBits();
+            return selection;
+        }
+
+        /**
+         * @brief Calls visit on every matching transaction of one account, in chronological order.
+         *
+         * Archived history has no index, so it is read back and filtered. Sealed blocks are skipped when
+         * their amount range or their bitmaps rule out every record, and otherwise decoded only as far as
+         * their last candidate. The unsealed tail is filtered directly.
+         */
+        template <typename Visit>
+        void ScanAccount(const AccountImage &account, const TransactionQuery &query, QueryStats &stats, Visit &&visit)
+        {
+            stats.accounts_scanned++;
+            std::vector<TransactionImage> transactions;
+            if (account.archived)
+            {
+                account.archived->Load(transactions);
+                stats.records_decoded += transactions.size();
+                for (const TransactionImage &t : transactions)
+                    if (query.Matches(t))
+                        visit(t);
+            }
+
+            for (const auto &block : account.blocks)
+            {
+                const u64 selection = SelectRecords(*block, query);
+                if (selection == 0 || block->GetMaxAmount() < query.min_amount || block->GetMinAmount() > query.max_amount)
+                {
+                    stats.blocks_skipped++;
+                    continue;
+                }
+
+                stats.blocks_scanned++;
+                stats.records_decoded += std::bit_width(selection);
+                transactions.clear();
+                block->DecodeSelected(selection, transactions);
+                for (const TransactionImage &t : transactions)
+                    if (t.amount >= query.min_amount && t.amount <= query.max_amount)
+                        visit(t);
+            }
+
+            if (account.tail)
+            {
+                stats.records_decoded += account.tail->size();
+                for (const TransactionImage &t : *account.tail)
+                    if (query.Matches(t))
+                        visit(t);
+            }
+        }
+
+        /**
+         * @brief Returns the group a matching transaction is totalled under.
+         */
+        std::pair<i32, i32> GroupKey(const TransactionQuery &query, const QueryTarget &target, const TransactionImage &t)
+        {
+            switch (query.group_by)
+            {
+            case QueryGroup::BANK:
+                return {target.bank_id, 0};
+            case QueryGroup::CUSTOMER:
+                return {target.bank_id, target.customer_id};
+            case QueryGroup::ACCOUNT_TYPE:
+                return {0, static_cast<i32>(target.account->account_type)};
+            case QueryGroup::TRANSACTION_TYPE:
+                return {0, static_cast<i32>(t.transaction_type)};
+            default:
+                return {0, 0};
+            }
+        }
+
+        void AddTotal(QueryTotal &total, const QueryTotal &other)
+        {
+            total.count += other.count;
+            total.sum += other.sum;
+        }
+    }
+
+    /**
+     * @brief Checks one transaction against every condition that does not depend on its account.
+     * @return True if the transaction matches.
+     */
+    bool TransactionQuery::Matches(const TransactionImage &transaction) const
+    {
+        return MatchesType(transaction.transaction_type) && transaction.amount >= min_amount &&
+               transaction.amount <= max_amount &&
+               (validity == QueryValidity::ANY || transaction.was_invalid == (validity == QueryValidity::INVALID_ONLY));
+    }
+
+    /**
+     * @brief Adds another scan's counts to these.
+     * @param other The counts to add.
+     */
+    void QueryStats::Add(const QueryStats &other)
+    {
+        accounts_scanned += other.accounts_scanned;
+        accounts_skipped += other.accounts_skipped;
+        blocks_scanned += other.blocks_scanned;
+        blocks_skipped += other.blocks_skipped;
+        records_decoded += other.records_decoded;
+    }
+
+    /**
+     * @brief Totals every transaction in a snapshot that matches a query, scanning accounts in parallel.
+     *
+     * Accounts are split across the shared ThreadPool, each chunk totalling into its own summary. The
+     * chunks are merged in account order, so the counts are exact and a run is repeatable on the same
+     * pool. The sums are floating point, though, and may differ in their last digits between pools of
+     * different sizes, since a different split groups the additions differently.
+     *
+     * @param snapshot The version to query.
+     * @param query The conditions and grouping.
+     * @return The overall and per-group totals, and how much of the data was skipped.
+     */
+    QuerySummary RunQuery(const SystemImage &snapshot, const TransactionQuery &query)
+    {
+        auto start = std::chrono::steady_clock::now();
+        QuerySummary summary;
+        const std::vector<QueryTarget> targets = CollectTargets(snapshot, query, summary.stats);
+
+        std::mutex mutex;
+        std::map<size_t, QuerySummary> partials; // Keyed by the chunk's first account
+        ThreadPool::Shared().ParallelFor(targets.size(), [&](size_t begin, size_t end)
+                                         {
+            TraceSpan span("ScanAccounts");
+            QuerySummary partial;
+            for (size_t i = begin; i < end; i++)
+            {
+                const QueryTarget &target = targets[i];
+                ScanAccount(*target.account, query, partial.stats, [&](const TransactionImage &t)
+                            {
+                    QueryTotal &group = partial.groups[GroupKey(query, target, t)];
+                    group.count++;
+                    group.sum += t.amount; });
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            partials.emplace(begin, std::move(partial)); }, QUERY_ACCOUNTS_PER_TASK);
+
+        for (const auto &[begin, partial] : partials)
+        {
+            summary.stats.Add(partial.stats);
+            for (const auto &[key, total] : partial.groups)
+            {
+                AddTotal(summary.groups[key], total);
+                AddTotal(summary.total, total);
+            }
+        }
+
+        summary.seconds = std::chrono::duration<f64>(std::chrono::steady_clock::now() - start).count();
+        return summary;
+    }
+
+    /**
+     * @brief Opens a cursor over the rows of a query.
+     * @param snapshot The version to query; the cursor keeps it alive.
+     * @param query The conditions (its grouping is ignored).
+     */
+    QueryCursor::QueryCursor(std::shared_ptr<const SystemImage> snapshot, const TransactionQuery &query)
+        : m_snapshot(std::move(snapshot)), m_query(query)
+    {
+        m_targets = CollectTargets(*m_snapshot, m_query, m_stats);
+    }
+
+    /**
+     * @brief Returns the next page of rows.
+     *
+     * Accounts are scanned in parallel batches, and only until the page can be filled; rows beyond it
+     * are kept for the next page.
+     *
+     * @param page_size The most rows to return.
+     * @param page Receives the rows, replacing its contents.
+     * @return False once every row has been returned.
+     */
+    bool QueryCursor::NextPage(size_t page_size, std::vector<QueryRow> &page)
+    {
+        page.clear();
+        while (m_buffer.size() - m_buffer_position < page_size && m_next_target < m_targets.size())
+        {
+            const size_t begin = m_next_target;
+            const size_t count = std::min(m_targets.size() - begin, QUERY_ACCOUNTS_PER_TASK * ThreadPool::Shared().GetThreadCount());
+            m_next_target += count;
+
+            std::vector<std::vector<QueryRow>> rows(count);
+            std::vector<QueryStats> stats(count);
+            ThreadPool::Shared().ParallelFor(count, [&](size_t first, size_t last)
+                                             {
+                TraceSpan span("ScanAccounts");
+                for (size_t i = first; i < last; i++)
+                {
+                    const QueryTarget &target = m_targets[begin + i];
+                    ScanAccount(*target.account, m_query, stats[i], [&](const TransactionImage &t)
+                                { rows[i].push_back({target.bank_id, target.customer_id, target.account->account_id,
+                                                     target.account->account_type, t}); });
+                } }, 1);
+
+            // Drop rows already returned before appending, so the buffer never holds more than a batch and a page
+            m_buffer.erase(m_buffer.begin(), m_buffer.begin() + static_cast<std::ptrdiff_t>(m_buffer_position));
+            m_buffer_position = 0;
+            for (size_t i = 0; i < count; i++)
+            {
+                m_stats.Add(stats[i]);
+                m_buffer.insert(m_buffer.end(), rows[i].begin(), rows[i].end());
+            }
+        }
+
+        const size_t available = std::min(page_size, m_buffer.size() - m_buffer_position);
+        page.assign(m_buffer.begin() + static_cast<std::ptrdiff_t>(m_buffer_position),
+                    m_buffer.begin() + static_cast<std::ptrdiff_t>(m_buffer_position + available));
+        m_buffer_position += available;
+        return !page.empty();
+    }
+
+    /**
+     * @brief Returns a readable name for a group of query results.
+     * @param group How the results were grouped.
+     * @param key The group's key, as in QuerySummary::groups.
+     */
+    std::string QueryGroupLabel(QueryGroup group, const std::pair<i32, i32> &key)
+    {
+        switch (group)
+        {
+        case QueryGroup::BANK:
+            return "Bank " + std::to_string(key.first);
+        case QueryGroup::CUSTOMER:
+            return "Bank " + std::to_string(key.first) + ", Customer " + std::to_string(key.second);
+        case QueryGroup::ACCOUNT_TYPE:
+            return static_cast<AccountType>(key.second) == AccountType::CHECKING ? "Checking" : "Saving";
+        case QueryGroup::TRANSACTION_TYPE:
+            return std::string(TransactionTypeToString(static_cast<TransactionType>(key.second)));
+        default:
+            return "All";
+        }
+    }
+}
@@ -0,0 +1,622 @@
+/**
+ * @file replication.cpp
+ * @brief This file implements log shipping: the primary's replication log and the standby replica
+ *        that replays it into its own bank graph for read-only reporting.
+ */
+
+#include "../include/replication.hpp"
+#include "../include/bank.hpp"
+#include "../include/bank_account.hpp"
+#include "../include/customer.hpp"
+#include "../include/global.hpp"
+#include "../include/sim_clock.hpp"
+#include "../include/snapshot.hpp"
+#include "../include/transaction.hpp"
+#include "../include/utilities.hpp"
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace Bank
+{
+    namespace
+    {
+        /**
+         * @brief Returns the wall-clock time in milliseconds, used to measure replication lag.
+         */
+        i64 NowMilliseconds()
+        {
+            return std::chrono::duration_cast<std::chrono::milliseconds>(
+                       std::chrono::system_clock::now().time_since_epoch())
+                .count();
+        }
+
+        /**
+         * @brief Formats a monetary amount with enough digits to round-trip exactly.
+         */
+        std::string Exact(f64 amount)
+        {
+            std::ostringstream oss;
+            oss << std::setprecision(std::numeric_limits<f64>::max_digits10) << amount;
+            return oss.str();
+        }
+
+        /**
+         * @brief Replaces the record separators in a user-entered name with spaces.
+         */
+        std::string Clean(std::string_view name)
+        {
+            std::string text(name);
+            std::replace(text.begin(), text.end(), '\t', ' ');
+            std::replace(text.begin(), text.end(), '\n', ' ');
+            return text;
+        }
+
+        /**
+         * @brief Splits a record into its tab-separated fields.
+         */
+        std::vector<std::string> SplitRecord(const std::string &record)
+        {
+            std::vector<std::string> fields;
+            std::istringstream iss(record);
+            std::string field;
+            while (std::getline(iss, field, '\t'))
+                fields.push_back(field);
+            if (!record.empty() && record.back() == '\t')
+                fields.emplace_back(); // A trailing empty field (e.g. no transfer destination)
+            return fields;
+        }
+    }
+
+    /**
+     * @class ReplicationLog
+     * @brief Appends every change to the bank graph to a file or pipe for a standby to replay.
+     */
+
+    /**
+     * @brief Returns the process-wide replication log.
+     */
+    ReplicationLog &ReplicationLog::Shared()
+    {
+        static ReplicationLog log;
+        return log;
+    }
+
+    /**
+     * @brief Starts logging to the given path, truncating it. Opening a named pipe waits for the standby.
+     * @param path The log file or named pipe to write.
+     * @return True if the log could be opened.
+     */
+    bool ReplicationLog::Open(const std::string &path)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stream.open(path, std::ios::out | std::ios::trunc);
+        m_enabled = m_stream.is_open();
+        return m_enabled;
+    }
+
+    /**
+     * @brief Writes one record and flushes it, so the standby sees it as soon as it is applied here.
+     *
+     * Inside a batch the flush is left to EndBatch, so the standby receives the batch's records together.
+     *
+     * @param kind The record kind (BANK, CUSTOMER, ACCOUNT, TRANSACTION, INTEREST, FEE or LIMITS).
+     * @param fields The tab-separated fields of the record.
+     */
+    void ReplicationLog::Append(const std::string &kind, const std::string &fields)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stream << m_next_lsn++ << '\t' << NowMilliseconds() << '\t' << kind << '\t' << fields << '\n';
+        if (m_batch_depth == 0)
+            m_stream.flush();
+    }
+
+    /**
+     * @brief Starts a batch of records that are flushed together. Batches may nest.
+     */
+    void ReplicationLog::BeginBatch()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_batch_depth++;
+    }
+
+    /**
+     * @brief Ends a batch, flushing its records once the outermost batch ends.
+     */
+    void ReplicationLog::EndBatch()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (--m_batch_depth == 0 && m_enabled)
+            m_stream.flush();
+    }
+
+    /**
+     * @brief Records the creation of a Bank.
+     */
+    void ReplicationLog::LogBankCreated(const Bank &bank)
+    {
+        if (!m_enabled)
+            return;
+        Append("BANK", std::to_string(bank.GetID()) + '\t' + Clean(bank.GetName()));
+    }
+
+    /**
+     * @brief Records a Customer being added to its Bank.
+     */
+    void ReplicationLog::LogCustomerAdded(const Customer &customer)
+    {
+        if (!m_enabled)
+            return;
+        Append("CUSTOMER", std::to_string(customer.GetBank().GetID()) + '\t' + std::to_string(customer.GetID()) + '\t' +
+                               std::to_string(customer.GetAge()) + '\t' + Clean(customer.GetFirstName()) + '\t' +
+                               Clean(customer.GetLastName()));
+    }
+
+    /**
+     * @brief Records a BankAccount being opened for its Customer.
+     */
+    void ReplicationLog::LogAccountCreated(const BankAccount &account)
+    {
+        if (!m_enabled)
+            return;
+        const Customer &customer = account.GetAccountOwner();
+        Append("ACCOUNT", std::to_string(customer.GetBank().GetID()) + '\t' + std::to_string(customer.GetID()) + '\t' +
+                              account.GetID().ToString() + '\t' + std::to_string(static_cast<i32>(account.GetAccountType())) + '\t' +
+                              Exact(account.GetOpeningBalance()));
+    }
+
+    /**
+     * @brief Records an executed Transaction, including the balance it left so the standby can verify its replay.
+     */
+    void ReplicationLog::LogTransaction(const BankAccount &account, const Transaction &transaction)
+    {
+        if (!m_enabled)
+            return;
+        const Customer &customer = account.GetAccountOwner();
+        Append("TRANSACTION", std::to_string(customer.GetBank().GetID()) + '\t' + std::to_string(customer.GetID()) + '\t' +
+                                  account.GetID().ToString() + '\t' + std::to_string(transaction.GetTransactionID()) + '\t' +
+                                  std::to_string(transaction.GetTimestamp()) + '\t' +
+                                  std::to_string(static_cast<i32>(transaction.GetType())) + '\t' +
+                                  Exact(transaction.GetTransactionAmount()) + '\t' +
+                                  Exact(transaction.GetBalanceAfterTransaction()) + '\t' +
+                                  transaction.GetDestinationAccountID().ToString());
+    }
+
+    /**
+     * @brief Records a Bank starting a new interest period.
+     */
+    void ReplicationLog::LogInterestRollover(const Bank &bank)
+    {
+        if (!m_enabled)
+            return;
+        Append("INTEREST", std::to_string(bank.GetID()));
+    }
+
+    /**
+     * @brief Records an end-of-day overdraft fee charged to a checking account.
+     */
+    void ReplicationLog::LogOverdraftFee(const BankAccount &account)
+    {
+        if (!m_enabled)
+            return;
+        const Customer &customer = account.GetAccountOwner();
+        Append("FEE", std::to_string(customer.GetBank().GetID()) + '\t' + std::to_string(customer.GetID()) + '\t' +
+                          account.GetID().ToString());
+    }
+
+    /**
+     * @brief Records new velocity limits for a Customer, or for one of its accounts if account is given.
+     */
+    void ReplicationLog::LogVelocityLimits(const Customer &customer, const BankAccount *account, const VelocityLimits &limits)
+    {
+        if (!m_enabled)
+            return;
+        Append("LIMITS", std::to_string(customer.GetBank().GetID()) + '\t' + std::to_string(customer.GetID()) + '\t' +
+                             (account ? account->GetID().ToString() : "") + '\t' + std::to_string(limits.max_withdrawals_per_hour) + '\t' +
+                             Exact(limits.max_amount_per_day));
+    }
+
+    /**
+     * @class StandbyReplica
+     * @brief Tails a replication log and serves read-only queries from snapshots of the replayed graph.
+     */
+
+    /**
+     * @brief Constructs a standby for the given log file or named pipe. Call Start to begin replay.
+     * @param path The path the primary writes its replication log to.
+     */
+    StandbyReplica::StandbyReplica(const std::string &path) : m_path(path)
+    {
+    }
+
+    /**
+     * @brief Stops the applier thread before the replayed graph is destroyed.
+     */
+    StandbyReplica::~StandbyReplica()
+    {
+        Stop();
+    }
+
+    /**
+     * @brief Starts the applier thread.
+     */
+    void StandbyReplica::Start()
+    {
+        m_stop = false;
+        m_applier = std::thread(&StandbyReplica::ApplyLoop, this);
+    }
+
+    /**
+     * @brief Stops the applier thread and waits for it to finish the record it is applying.
+     */
+    void StandbyReplica::Stop()
+    {
+        if (!m_applier.joinable())
+            return;
+
+        m_stop = true;
+        m_applier.join();
+    }
+
+    /**
+     * @brief Tails the log, applying each complete record and publishing a snapshot after every batch.
+     *
+     * At the end of the file the applier waits briefly and reads again, so records appended by the
+     * primary are picked up as they arrive. A partial last line is kept until its newline is written.
+     */
+    void StandbyReplica::ApplyLoop()
+    {
+#ifdef _WIN32
+        std::ifstream in;
+        while (!m_stop)
+        {
+            in.open(m_path, std::ios::binary);
+            if (in.is_open())
+                break;
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+        auto read_chunk = [&](char *data, size_t size) -> size_t
+        {
+            in.read(data, static_cast<std::streamsize>(size));
+            size_t count = static_cast<size_t>(in.gcount());
+            if (in.eof())
+                in.clear();
+            return count;
+        };
+#else
+        // Non-blocking, so neither an idle primary nor a pipe nobody has opened yet can stall Stop
+        i32 fd = -1;
+        while (!m_stop)
+        {
+            fd = open(m_path.c_str(), O_RDONLY | O_NONBLOCK);
+            if (fd >= 0)
+                break;
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+        auto read_chunk = [&](char *data, size_t size) -> size_t
+        {
+            ssize_t count = read(fd, data, size);
+            return count > 0 ? static_cast<size_t>(count) : 0;
+        };
+#endif
+
+        std::string pending;
+        std::vector<char> buffer(64 * 1024);
+        while (!m_stop)
+        {
+            size_t count = read_chunk(buffer.data(), buffer.size());
+            m_caught_up = count == 0 && pending.empty();
+            if (count > 0)
+            {
+                pending.append(buffer.data(), count);
+
+                size_t start = 0, newline;
+                while ((newline = pending.find('\n', start)) != std::string::npos)
+                {
+                    if (!Apply(pending.substr(start, newline - start)))
+                        m_divergences++;
+                    m_bytes_applied += newline - start + 1;
+                    start = newline + 1;
+                }
+                pending.erase(0, start);
+                std::cout.flush();
+                SnapshotManager::Shared().Publish(m_banks);
+            }
+
+            else
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            }
+        }
+
+#ifndef _WIN32
+        if (fd >= 0)
+            close(fd);
+#endif
+    }
+
+    /**
+     * @brief Replays one record against the standby's own graph.
+     * @param record One line of the replication log.
+     * @return False if the record could not be applied or its replay disagreed with the primary.
+     */
+    bool StandbyReplica::Apply(const std::string &record)
+    {
+        std::vector<std::string> fields = SplitRecord(record);
+        if (fields.size() < 4)
+        {
+            std::cerr << "Error: Malformed replication record: " << record << "\n";
+            return false;
+        }
+
+        m_applied_lsn = std::stoull(fields[0]);
+        m_last_record_ms = std::stoll(fields[1]);
+        m_records_applied++;
+
+        const std::string &kind = fields[2];
+        try
+        {
+            Bank *bank = kind == "BANK" ? nullptr : FindBank(m_banks, std::stoi(fields[3]));
+            if (kind == "BANK" && fields.size() >= 5)
+            {
+                i32 bank_id = std::stoi(fields[3]);
+                auto it = std::lower_bound(m_banks.begin(), m_banks.end(), bank_id,
+                                           [](const std::unique_ptr<Bank> &b, i32 id)
+                                           { return b->GetID() < id; });
+                m_banks.insert(it, std::make_unique<Bank>(fields[4], bank_id));
+                SnapshotManager::Shared().MarkBanksDirty();
+                return true;
+            }
+            if (!bank)
+            {
+                std::cerr << "Error: Replication record for an unknown bank: " << record << "\n";
+                return false;
+            }
+
+            if (kind == "INTEREST")
+            {
+                bank->ApplyInterestToAllAccounts();
+                return true;
+            }
+            if (kind == "CUSTOMER" && fields.size() >= 8)
+            {
+                bank->AddCustomer(fields[6], fields[7], std::stoi(fields[5]), std::stoi(fields[4]));
+                return true;
+            }
+
+            Customer *customer = fields.size() >= 5 ? FindCustomer(bank, std::stoi(fields[4])) : nullptr;
+            if (!customer)
+            {
+                std::cerr << "Error: Replication record for an unknown customer: " << record << "\n";
+                return false;
+            }
+
+            if (kind == "LIMITS" && fields.size() >= 8)
+            {
+                VelocityLimits limits;
+                limits.max_withdrawals_per_hour = std::stoi(fields[6]);
+                limits.max_amount_per_day = std::stod(fields[7]);
+                if (fields[5].empty())
+                {
+                    customer->SetVelocityLimits(limits);
+                    return true;
+                }
+                if (BankAccount *account = FindAccount(customer, fields[5]))
+                {
+                    account->SetVelocityLimits(limits);
+                    return true;
+                }
+            }
+            if (kind == "ACCOUNT" && fields.size() >= 8)
+            {
+                customer->CreateBankAccount(static_cast<AccountType>(std::stoi(fields[6])), std::stod(fields[7]),
+                                            AccountID::Parse(fields[5]));
+                return true;
+            }
+
+            BankAccount *account = fields.size() >= 6 ? FindAccount(customer, fields[5]) : nullptr;
+            if (!account)
+            {
+                std::cerr << "Error: Replication record for an unknown account: " << record << "\n";
+                return false;
+            }
+
+            if (kind == "TRANSACTION" && fields.size() >= 12)
+            {
+                // Replay at the primary's simulated time so timestamps match
+                SimClock::Shared().AdvanceTo(std::stoll(fields[7]));
+                const Transaction &transaction = account->CreateTransaction(
+                    static_cast<TransactionType>(std::stoi(fields[8])), std::stod(fields[9]), AccountID::Parse(fields[11]),
+                    std::stoi(fields[6]));
+
+                if (transaction.GetBalanceAfterTransaction() != std::stod(fields[10]))
+                {
+                    std::cerr << "Error: Replayed transaction " << fields[6] << " left " << transaction.GetBalanceAfterTransaction()
+                              << " but the primary recorded " << fields[10] << "\n";
+                    return false;
+                }
+                return true;
+            }
+            if (kind == "FEE" && account->GetAccountType() == AccountType::CHECKING)
+            {
+                static_cast<CheckingAccount *>(account)->AssessOverdraftFee();
+                return true;
+            }
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "Error: Could not parse replication record (" << e.what() << "): " << record << "\n";
+            return false;
+        }
+
+        std::cerr << "Error: Unknown replication record: " << record << "\n";
+        return false;
+    }
+
+    /**
+     * @brief Prints the replay position and the replication lag.
+     *
+     * Lag is zero while the applier has nothing left to read; otherwise it is the age of the last applied
+     * record, i.e. how long ago the primary performed the operation the standby has just reached.
+     *
+     * @param out The stream to print to.
+     */
+    void StandbyReplica::PrintStatus(std::ostream &out) const
+    {
+        std::error_code ec;
+        bool measurable = std::filesystem::is_regular_file(m_path, ec); // A pipe has no size to compare against
+        u64 log_size = measurable ? std::filesystem::file_size(m_path, ec) : 0;
+        u64 bytes_behind = measurable && log_size > m_bytes_applied ? log_size - m_bytes_applied : 0;
+
+        out << "Applied LSN: " << m_applied_lsn << " (" << m_records_applied << " record(s), "
+            << m_divergences << " divergence(s))\n";
+
+        out << "Replication lag: ";
+        if (m_records_applied == 0)
+            out << "no records applied yet";
+        else if (m_caught_up)
+            out << "0 ms (caught up)";
+        else
+            out << std::max<i64>(0, NowMilliseconds() - m_last_record_ms) << " ms";
+        if (measurable)
+            out << ", " << bytes_behind << " byte(s) behind";
+        out << "\n";
+    }
+
+    /**
+     * @brief Serves read-only reporting commands from the latest published snapshot.
+     * @param in The stream commands are read from.
+     * @param out The stream results are written to.
+     */
+    void StandbyReplica::RunConsole(std::istream &in, std::ostream &out)
+    {
+        out << "Standby mode: replaying " << m_path << ". Type 'help' for commands.\n";
+
+        std::string line;
+        while (out << "standby> " << std::flush, std::getline(in, line))
+        {
+            std::istringstream args(line);
+            std::string command;
+            if (!(args >> command))
+                continue;
+
+            if (command == "quit" || command == "exit")
+                break;
+
+            std::shared_ptr<const SystemImage> snapshot = SnapshotManager::Shared().Acquire();
+            if (command == "help")
+            {
+                out << "status\n"
+                    << "banks\n"
+                    << "customers <bank_id>\n"
+                    << "accounts <bank_id> <customer_id>\n"
+                    << "transactions <bank_id> <customer_id> <account_id>\n"
+                    << "export [file]  (default standby_bank_info.txt)\n"
+                    << "quit\n";
+            }
+            else if (command == "status")
+            {
+                PrintStatus(out);
+            }
+            else if (command == "banks")
+            {
+                for (const auto &bank : snapshot->banks)
+                    out << "Bank " << bank->bank_id << ": " << bank->bank_name << " (" << bank->customers.size() << " customer(s))\n";
+            }
+            else if (command == "customers" || command == "accounts" || command == "transactions")
+            {
+                i32 bank_id = 0, customer_id = 0;
+                std::string account_id;
+                args >> bank_id;
+                if (command != "customers")
+                    args >> customer_id;
+                if (command == "transactions")
+                    args >> account_id;
+
+                const BankImage *bank = snapshot->FindBank(bank_id);
+                const CustomerImage *customer = bank ? bank->FindCustomer(customer_id) : nullptr;
+                const AccountImage *account = customer ? customer->FindAccount(AccountID::Parse(account_id)) : nullptr;
+
+                if (!bank)
+                    out << "Error: Bank not found.\n";
+                else if (command == "customers")
+                {
+                    for (const auto &c : bank->customers)
+                        out << "Customer " << c->customer_id << ": " << c->GetName() << ", age " << c->age << ", "
+                            << c->accounts.size() << " account(s)\n";
+                }
+                else if (!customer)
+                    out << "Error: Customer not found.\n";
+                else if (command == "accounts")
+                {
+                    for (const auto &a : customer->accounts)
+                        out << "Account " << a->account_id << ": $" << std::fixed << std::setprecision(2)
+                            << a->GetBalance(bank->interest_period) << " (" << a->transaction_count << " transaction(s))\n";
+                }
+                else if (!account)
+                    out << "Error: Account not found.\n";
+                else
+                {
+                    for (const TransactionImage &t : account->GetTransactionsByID())
+                        out << "Transaction " << t.transaction_id << ": " << TransactionTypeToString(t.transaction_type)
+                            << " $" << std::fixed << std::setprecision(2) << t.amount << " on "
+                            << SimClock::FormatDate(t.timestamp) << (t.was_invalid ? " (declined)" : "") << "\n";
+                }
+            }
+            else if (command == "export")
+            {
+                std::string path = "standby_bank_info.txt";
+                args >> path;
+                std::ofstream ofs(path);
+                if (!ofs.is_open())
+                    out << "Error: " << path << " could not be opened.\n";
+                else
+                {
+                    snapshot->WriteToStream(ofs);
+                    out << "Exported snapshot version " << snapshot->version << " to " << path << "\n";
+                }
+            }
+            else
+            {
+                out << "Error: Unknown command. Type 'help' for commands.\n";
+            }
+        }
+    }
+
+    /**
+     * @brief Runs a standby on the given log until the console exits.
+     *
+     * Object creation messages printed during replay go to 'standby.log', keeping the console readable.
+     *
+     * @param path The log file or named pipe the primary writes.
+     * @return The process exit code.
+     */
+    i32 RunStandbyMode(const std::string &path)
+    {
+        std::ofstream replay_log("standby.log");
+        std::ostream console(std::cout.rdbuf());
+        std::streambuf *cout_buffer = std::cout.rdbuf(replay_log.rdbuf());
+        std::streambuf *cerr_buffer = std::cerr.rdbuf(replay_log.rdbuf());
+
+        {
+            StandbyReplica replica(path);
+            replica.Start();
+            replica.RunConsole(std::cin, console);
+            replica.Stop();
+        }
+
+        std::cout.rdbuf(cout_buffer);
+        std::cerr.rdbuf(cerr_buffer);
+        return 0;
+    }
+}
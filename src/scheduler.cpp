@@ -0,0 +1,183 @@
+/**
+ * @file scheduler.cpp
+ * @brief This file implements the Scheduler class, which runs standing orders (recurring deposits,
+ *        withdrawals and transfers) against bank accounts as simulated time passes.
+ */
+
+#include "../include/scheduler.hpp"
+#include "../include/bank_account.hpp"
+#include "../include/global.hpp"
+#include "../include/sim_clock.hpp"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+namespace Bank
+{
+    /**
+     * @class Scheduler
+     * @brief Owns all standing orders and fires them from a hierarchical timer wheel.
+     */
+
+    /**
+     * @brief Constructs a Scheduler whose wheel starts at the current simulated time.
+     */
+    Scheduler::Scheduler() : m_wheel(ToTick(SimClock::Shared().Now()))
+    {
+    }
+
+    /**
+     * @brief Returns the process-wide scheduler.
+     * @return A reference to the shared Scheduler.
+     */
+    Scheduler &Scheduler::Shared()
+    {
+        static Scheduler scheduler;
+        return scheduler;
+    }
+
+    /**
+     * @brief Converts a time in seconds to the wheel tick that contains it.
+     */
+    u64 Scheduler::ToTick(i64 time)
+    {
+        return static_cast<u64>(time / SCHEDULER_TICK_SECONDS);
+    }
+
+    /**
+     * @brief Computes when an order should next run, one period after its current due time.
+     */
+    i64 Scheduler::NextDueAfter(const StandingOrder &order)
+    {
+        switch (order.frequency)
+        {
+        case Frequency::DAILY:
+            return order.next_due + SECONDS_PER_DAY;
+        case Frequency::WEEKLY:
+            return order.next_due + 7 * SECONDS_PER_DAY;
+        default:
+            return SimClock::AddMonths(order.next_due, 1, order.anchor_day);
+        }
+    }
+
+    /**
+     * @brief Registers a new standing order against an account.
+     * @param account The account the order debits (or credits, for deposits).
+     * @param transaction_type DEPOSIT, WITHDRAW or TRANSFER.
+     * @param amount The amount of each execution.
+     * @param frequency How often the order repeats.
+     * @param first_due The simulated time of the first execution.
+     * @param destination_account_id The destination account for TRANSFER orders; otherwise an invalid ID.
+     * @return The ID assigned to the new order.
+     */
+    u64 Scheduler::AddStandingOrder(BankAccount &account, TransactionType transaction_type, f64 amount,
+                                    Frequency frequency, i64 first_due, AccountID destination_account_id)
+    {
+        u64 order_id = m_next_order_id++;
+        StandingOrder order{order_id, &account, transaction_type, amount, destination_account_id,
+                            frequency, SimClock::DayOfMonth(first_due), first_due};
+
+        m_orders.emplace(order_id, std::move(order));
+        m_wheel.Schedule(ToTick(first_due), order_id);
+
+        std::cout << "Standing order #" << order_id << " scheduled " << FrequencyToString(frequency)
+                  << " from " << SimClock::FormatDate(first_due)
+                  << " on account " << account.GetID() << std::endl;
+        return order_id;
+    }
+
+    /**
+     * @brief Cancels a standing order. Its pending timer is discarded when it next fires.
+     * @param order_id The ID of the order to cancel.
+     * @return True if the order existed.
+     */
+    bool Scheduler::CancelStandingOrder(u64 order_id)
+    {
+        return m_orders.erase(order_id) > 0;
+    }
+
+    /**
+     * @brief Advances the shared SimClock to the given time, executing every order that falls due on the way.
+     * @param time The target simulated time.
+     * @return The number of transactions executed.
+     */
+    size_t Scheduler::AdvanceTo(i64 time)
+    {
+        size_t executed = 0;
+        SimClock &clock = SimClock::Shared();
+
+        m_wheel.Advance(ToTick(time), [&](u64 order_id, u64 tick)
+                        {
+            auto it = m_orders.find(order_id);
+            if (it == m_orders.end())
+                return; // Cancelled since it was scheduled
+
+            StandingOrder &order = it->second;
+
+            // Transactions are stamped with the time the order was due, not the end of the fast-forward
+            clock.AdvanceTo(std::max(order.next_due, static_cast<i64>(tick) * SCHEDULER_TICK_SECONDS));
+            order.account->CreateTransaction(order.transaction_type, order.amount, order.destination_account_id);
+            order.times_executed++;
+            executed++;
+
+            order.next_due = NextDueAfter(order);
+            m_wheel.Schedule(ToTick(order.next_due), order_id); });
+
+        clock.AdvanceTo(time);
+        return executed;
+    }
+
+    /**
+     * @brief Prints every active standing order, ordered by ID.
+     * @param os The stream to print to.
+     */
+    void Scheduler::ViewStandingOrders(std::ostream &os) const
+    {
+        std::vector<const StandingOrder *> orders;
+        orders.reserve(m_orders.size());
+        for (const auto &[id, order] : m_orders)
+            orders.push_back(&order);
+        std::sort(orders.begin(), orders.end(), [](const StandingOrder *a, const StandingOrder *b)
+                  { return a->order_id < b->order_id; });
+
+        for (const StandingOrder *order : orders)
+        {
+            os << "Order #" << order->order_id << " | " << order->account->GetID() << " | "
+               << FrequencyToString(order->frequency) << " | ";
+            switch (order->transaction_type)
+            {
+            case TransactionType::DEPOSIT:
+                os << "Deposit";
+                break;
+            case TransactionType::WITHDRAW:
+                os << "Withdraw";
+                break;
+            default:
+                os << "Transfer to " << order->destination_account_id;
+                break;
+            }
+            os << " | $" << std::fixed << std::setprecision(2) << order->amount
+               << " | next " << SimClock::FormatDate(order->next_due)
+               << " | run " << order->times_executed << " time(s)\n";
+        }
+    }
+
+    /**
+     * @brief Returns a string representation of a Frequency.
+     * @param frequency The frequency to convert.
+     * @return "Daily", "Weekly" or "Monthly".
+     */
+    std::string FrequencyToString(Frequency frequency)
+    {
+        switch (frequency)
+        {
+        case Frequency::DAILY:
+            return "Daily";
+        case Frequency::WEEKLY:
+            return "Weekly";
+        default:
+            return "Monthly";
+        }
+    }
+}
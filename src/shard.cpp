@@ -0,0 +1,710 @@
+/**
+ * @file shard.cpp
+ * @brief This file implements sharded mode: a coordinator process that routes operations by bank ID to
+ *        forked worker processes, with two-phase commit for transfers between accounts.
+ */
+
+#include "../include/shard.hpp"
+#include "../include/audit.hpp"
+#include "../include/bank.hpp"
+#include "../include/bank_account.hpp"
+#include "../include/customer.hpp"
+#include "../include/global.hpp"
+#include "../include/snapshot.hpp"
+#include "../include/utilities.hpp"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#ifdef __linux__
+#include <sched.h>
+#endif
+#endif
+
+namespace Bank
+{
+#ifndef _WIN32
+    namespace
+    {
+        /**
+         * @brief Reads one '\n'-terminated line from a file descriptor, buffering any extra bytes.
+         * @return False if the peer closed the connection.
+         */
+        bool ReadLine(i32 fd, std::string &buffer, std::string &line)
+        {
+            while (true)
+            {
+                size_t newline = buffer.find('\n');
+                if (newline != std::string::npos)
+                {
+                    line = buffer.substr(0, newline);
+                    buffer.erase(0, newline + 1);
+                    return true;
+                }
+
+                char chunk[4096];
+                ssize_t n = read(fd, chunk, sizeof(chunk));
+                if (n < 0 && errno == EINTR)
+                    continue;
+                if (n <= 0)
+                    return false;
+                buffer.append(chunk, static_cast<size_t>(n));
+            }
+        }
+
+        /**
+         * @brief Writes one line (plus '\n') to a file descriptor.
+         * @return False if the write failed.
+         */
+        bool WriteLine(i32 fd, const std::string &line)
+        {
+            std::string data = line + '\n';
+            size_t written = 0;
+            while (written < data.size())
+            {
+                ssize_t n = write(fd, data.data() + written, data.size() - written);
+                if (n < 0 && errno == EINTR)
+                    continue;
+                if (n <= 0)
+                    return false;
+                written += static_cast<size_t>(n);
+            }
+            return true;
+        }
+
+        /**
+         * @brief The server loop run inside each worker process. Owns that shard's banks.
+         */
+        class ShardWorker
+        {
+        private:
+            struct Leg
+            {
+                BankAccount *account;
+                f64 amount;
+                bool is_debit;
+            };
+
+            std::vector<std::unique_ptr<Bank>> m_banks;
+            std::unordered_map<u64, std::vector<Leg>> m_prepared;          // Transfer ID -> legs prepared here
+            std::unordered_map<const BankAccount *, f64> m_held_funds;     // Funds reserved by prepared debits
+
+            /**
+             * @brief Resolves bank, customer and account IDs read from a request.
+             */
+            BankAccount *Resolve(std::istringstream &args)
+            {
+                i32 bank_id = 0, customer_id = 0;
+                std::string account_id;
+                args >> bank_id >> customer_id >> account_id;
+
+                Bank *bank = FindBank(m_banks, bank_id);
+                Customer *customer = bank ? FindCustomer(bank, customer_id) : nullptr;
+                return customer ? FindAccount(customer, account_id) : nullptr;
+            }
+
+            /**
+             * @brief Returns the balance not reserved by a prepared transfer.
+             */
+            f64 Available(const BankAccount &account) const
+            {
+                auto it = m_held_funds.find(&account);
+                return account.GetBalance() - (it != m_held_funds.end() ? it->second : 0.0);
+            }
+
+            /**
+             * @brief Formats an "OK" response carrying a balance.
+             */
+            static std::string Balance(f64 balance)
+            {
+                std::ostringstream oss;
+                oss << "OK " << std::fixed << std::setprecision(2) << balance;
+                return oss.str();
+            }
+
+        public:
+            std::string Handle(const std::string &line);
+            void Serve(i32 fd);
+        };
+
+        /**
+         * @brief Executes one request and returns the single-line response.
+         */
+        std::string ShardWorker::Handle(const std::string &line)
+        {
+            std::istringstream args(line);
+            std::string command;
+            args >> command;
+
+            if (command == "CREATE_BANK")
+            {
+                i32 bank_id = 0;
+                std::string name;
+                args >> bank_id;
+                std::getline(args >> std::ws, name);
+
+                auto new_bank = std::make_unique<Bank>(name, bank_id);
+                auto it = std::lower_bound(m_banks.begin(), m_banks.end(), bank_id,
+                                           [](const std::unique_ptr<Bank> &b, i32 id)
+                                           { return b->GetID() < id; });
+                m_banks.insert(it, std::move(new_bank));
+                SnapshotManager::Shared().MarkBanksDirty();
+                return "OK " + std::to_string(bank_id);
+            }
+            if (command == "ADD_CUSTOMER")
+            {
+                i32 bank_id = 0, age = 0;
+                std::string first_name, last_name;
+                args >> bank_id >> age >> first_name >> last_name;
+
+                Bank *bank = FindBank(m_banks, bank_id);
+                if (!bank)
+                    return "ERR Bank not found";
+                return "OK " + std::to_string(bank->AddCustomer(first_name, last_name, age).GetID());
+            }
+            if (command == "ADD_ACCOUNT")
+            {
+                i32 bank_id = 0, customer_id = 0, account_type = 0;
+                f64 balance = 0.0;
+                args >> bank_id >> customer_id >> account_type >> balance;
+
+                Bank *bank = FindBank(m_banks, bank_id);
+                Customer *customer = bank ? FindCustomer(bank, customer_id) : nullptr;
+                if (!customer)
+                    return "ERR Customer not found";
+                return "OK " + customer->CreateBankAccount(static_cast<AccountType>(account_type), balance).GetID().ToString();
+            }
+            if (command == "DEPOSIT" || command == "WITHDRAW")
+            {
+                BankAccount *account = Resolve(args);
+                f64 amount = 0.0;
+                args >> amount;
+                if (!account)
+                    return "ERR Account not found";
+
+                // Funds held for an in-flight transfer cannot be withdrawn
+                if (command == "WITHDRAW" && m_held_funds.count(account) && Available(*account) - amount < 0)
+                    return "ERR Funds are held by a pending transfer";
+
+                TransactionType type = command == "DEPOSIT" ? TransactionType::DEPOSIT : TransactionType::WITHDRAW;
+                if (account->CreateTransaction(type, amount).WasInvalid())
+                    return "ERR Transaction was declined";
+                return Balance(account->GetBalance());
+            }
+            if (command == "BALANCE")
+            {
+                BankAccount *account = Resolve(args);
+                if (!account)
+                    return "ERR Account not found";
+                return Balance(account->GetBalance());
+            }
+            if (command == "PREPARE_DEBIT" || command == "PREPARE_CREDIT")
+            {
+                u64 transfer_id = 0;
+                args >> transfer_id;
+                BankAccount *account = Resolve(args);
+                f64 amount = 0.0;
+                args >> amount;
+                if (!account)
+                    return "ERR Account not found";
+
+                bool is_debit = command == "PREPARE_DEBIT";
+                if (is_debit)
+                {
+                    // Transfers never overdraw, even from checking accounts
+                    if (amount > Available(*account))
+                        return "ERR Insufficient funds";
+                    m_held_funds[account] += amount;
+                }
+                else if (account->GetBalance() + amount > MAX_BALANCE)
+                {
+                    return "ERR Destination balance would exceed the maximum";
+                }
+
+                m_prepared[transfer_id].push_back({account, amount, is_debit});
+                return "OK";
+            }
+            if (command == "COMMIT" || command == "ABORT")
+            {
+                u64 transfer_id = 0;
+                args >> transfer_id;
+                auto it = m_prepared.find(transfer_id);
+                if (it == m_prepared.end())
+                    return "ERR Unknown transfer";
+
+                // Every leg is applied even if one is declined, so the coordinator learns of all of them
+                std::string declined;
+                for (const Leg &leg : it->second)
+                {
+                    if (leg.is_debit)
+                    {
+                        f64 &held = m_held_funds[leg.account];
+                        held -= leg.amount;
+                        if (held <= 0.0)
+                            m_held_funds.erase(leg.account);
+                    }
+                    if (command == "COMMIT" &&
+                        leg.account->CreateTransaction(leg.is_debit ? TransactionType::WITHDRAW : TransactionType::DEPOSIT, leg.amount).WasInvalid())
+                        declined += (declined.empty() ? "" : ", ") + leg.account->GetID().ToString();
+                }
+                m_prepared.erase(it);
+                if (!declined.empty())
+                    return "ERR Declined on " + declined;
+                return "OK";
+            }
+            if (command == "AUDIT")
+            {
+                AuditReport report = AuditLedger(m_banks);
+                return "OK " + std::to_string(report.accounts_checked) + " " +
+                       std::to_string(report.transactions_checked) + " " +
+                       std::to_string(report.discrepancies.size());
+            }
+            if (command == "STATS")
+            {
+                size_t customers = 0, accounts = 0;
+                for (const auto &bank : m_banks)
+                {
+                    customers += bank->GetCustomers().size();
+                    accounts += bank->GetAccounts().size();
+                }
+                return "OK " + std::to_string(m_banks.size()) + " " + std::to_string(customers) + " " +
+                       std::to_string(accounts) + " " + std::to_string(m_prepared.size());
+            }
+            return "ERR Unknown command";
+        }
+
+        /**
+         * @brief Answers requests from the coordinator until it sends QUIT or closes the socket.
+         */
+        void ShardWorker::Serve(i32 fd)
+        {
+            std::string buffer, line;
+            while (ReadLine(fd, buffer, line))
+            {
+                if (line == "QUIT")
+                    break;
+
+                std::string response = Handle(line);
+                std::cout.flush();
+                SnapshotManager::Shared().Publish(m_banks);
+                if (!WriteLine(fd, response))
+                    break;
+            }
+        }
+    }
+
+    /**
+     * @class ShardCoordinator
+     * @brief Owns the worker processes and the bank-ID routing table.
+     */
+
+    /**
+     * @brief Stops any workers that are still running.
+     */
+    ShardCoordinator::~ShardCoordinator()
+    {
+        Stop();
+    }
+
+    /**
+     * @brief Forks the worker processes, each connected to the coordinator by a Unix socket pair.
+     *
+     * Worker output (object creation messages, etc.) goes to 'shard_<n>.log'. On Linux each worker is
+     * pinned to a CPU spread evenly over the machine, so shards land on different cores and sockets.
+     *
+     * @param shard_count The number of worker processes to start.
+     * @return True if every worker started.
+     */
+    bool ShardCoordinator::Start(size_t shard_count)
+    {
+        m_decision_log.open("shard_2pc.log", std::ios::app);
+        unsigned cpus = std::max(1u, std::thread::hardware_concurrency());
+        std::cout.flush();
+
+        for (size_t index = 0; index < shard_count; index++)
+        {
+            i32 fds[2];
+            if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0)
+            {
+                std::cerr << "Error: Could not create a socket pair for shard " << index << ".\n";
+                return false;
+            }
+
+            pid_t pid = fork();
+            if (pid < 0)
+            {
+                std::cerr << "Error: Could not start shard " << index << ".\n";
+                close(fds[0]);
+                close(fds[1]);
+                return false;
+            }
+
+            if (pid == 0)
+            {
+                // Worker: keep only its own end of its own socket
+                close(fds[0]);
+                for (const Shard &other : m_shards)
+                    close(other.fd);
+
+                std::string log_name = "shard_" + std::to_string(index) + ".log";
+                i32 log_fd = open(log_name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+                if (log_fd >= 0)
+                {
+                    dup2(log_fd, STDOUT_FILENO);
+                    dup2(log_fd, STDERR_FILENO);
+                    close(log_fd);
+                }
+                std::signal(SIGINT, SIG_IGN); // Ctrl+C is for the coordinator console
+
+#ifdef __linux__
+                cpu_set_t cpu_set;
+                CPU_ZERO(&cpu_set);
+                CPU_SET(static_cast<int>((index * cpus / shard_count) % cpus), &cpu_set);
+                sched_setaffinity(0, sizeof(cpu_set), &cpu_set);
+#endif
+                {
+                    ShardWorker worker;
+                    worker.Serve(fds[1]);
+                }
+                std::cout.flush();
+                _exit(0);
+            }
+
+            close(fds[1]);
+            Shard shard;
+            shard.pid = pid;
+            shard.fd = fds[0];
+            m_shards.push_back(std::move(shard));
+        }
+        return true;
+    }
+
+    /**
+     * @brief Asks every worker to exit and waits for it.
+     */
+    void ShardCoordinator::Stop()
+    {
+        for (Shard &shard : m_shards)
+        {
+            WriteLine(shard.fd, "QUIT");
+            close(shard.fd);
+            waitpid(shard.pid, nullptr, 0);
+        }
+        m_shards.clear();
+    }
+
+    /**
+     * @brief Sends one request to a worker and waits for its response.
+     * @param shard The index of the worker.
+     * @param command The request line.
+     * @return The response line, or "ERR ..." if the worker is unreachable.
+     */
+    std::string ShardCoordinator::Request(size_t shard, const std::string &command)
+    {
+        std::string response;
+        if (!WriteLine(m_shards[shard].fd, command) ||
+            !ReadLine(m_shards[shard].fd, m_shards[shard].read_buffer, response))
+            return "ERR Shard " + std::to_string(shard) + " is not responding";
+        return response;
+    }
+
+    /**
+     * @brief Looks up which worker owns a bank.
+     * @return False (after printing an error) if the bank is unknown.
+     */
+    bool ShardCoordinator::Route(i32 bank_id, size_t &shard, std::ostream &out) const
+    {
+        auto it = m_routes.find(bank_id);
+        if (it == m_routes.end())
+        {
+            out << "Error: Bank not found.\n";
+            return false;
+        }
+        shard = it->second;
+        return true;
+    }
+
+    /**
+     * @brief Picks a random bank ID that no shard uses yet.
+     */
+    i32 ShardCoordinator::GenerateBankID() const
+    {
+        std::random_device rd;
+        i32 bank_id;
+        do
+        {
+            bank_id = rd() % (MAX_BANK_ID - MIN_BANK_ID + 1) + MIN_BANK_ID;
+        } while (m_routes.count(bank_id));
+        return bank_id;
+    }
+
+    /**
+     * @brief Creates a bank on the worker that currently owns the fewest banks.
+     */
+    void ShardCoordinator::CreateBank(const std::string &bank_name, std::ostream &out)
+    {
+        if (m_routes.size() >= static_cast<size_t>(MAX_BANK_ID - MIN_BANK_ID + 1))
+        {
+            out << "Error: No bank IDs left.\n";
+            return;
+        }
+
+        auto least_loaded = std::min_element(m_shards.begin(), m_shards.end(), [](const Shard &a, const Shard &b)
+                                             { return a.banks < b.banks; });
+        size_t shard = static_cast<size_t>(least_loaded - m_shards.begin());
+        i32 bank_id = GenerateBankID();
+
+        std::string response = Request(shard, "CREATE_BANK " + std::to_string(bank_id) + " " + bank_name);
+        if (response.rfind("OK", 0) != 0)
+        {
+            out << "Error: " << response.substr(std::min<size_t>(4, response.size())) << "\n";
+            return;
+        }
+
+        m_routes[bank_id] = shard;
+        m_shards[shard].banks++;
+        out << "Bank created: " << bank_name << " (Bank ID: " << bank_id << ", shard " << shard << ")\n";
+    }
+
+    /**
+     * @brief Moves money between two accounts, possibly on different shards, with two-phase commit.
+     *
+     * Phase one prepares the debit and then the credit; each participant validates its account and the
+     * debit side holds the funds. The decision is appended to 'shard_2pc.log' before phase two, which
+     * commits every leg if all of them prepared and aborts the prepared ones otherwise. A participant that
+     * still declines a leg at commit is reported, and logged as PARTIAL, since the other legs stand. The log
+     * records decisions for inspection; it is not fsynced, and nothing reads it back after a crash.
+     */
+    void ShardCoordinator::Transfer(i32 source_bank, i32 source_customer, const std::string &source_account,
+                                    i32 destination_bank, i32 destination_customer, const std::string &destination_account,
+                                    f64 amount, std::ostream &out)
+    {
+        size_t source_shard, destination_shard;
+        if (!Route(source_bank, source_shard, out) || !Route(destination_bank, destination_shard, out))
+            return;
+        if (source_bank == destination_bank && source_customer == destination_customer && source_account == destination_account)
+        {
+            out << "Error: Cannot transfer to the same account.\n";
+            return;
+        }
+
+        u64 transfer_id = m_next_transfer_id++;
+        std::ostringstream amount_text;
+        amount_text << std::fixed << std::setprecision(2) << amount;
+
+        // Phase one: every participant must vote yes
+        std::vector<size_t> prepared;
+        std::string failure;
+        std::string response = Request(source_shard, "PREPARE_DEBIT " + std::to_string(transfer_id) + " " +
+                                                         std::to_string(source_bank) + " " + std::to_string(source_customer) + " " +
+                                                         source_account + " " + amount_text.str());
+        if (response == "OK")
+        {
+            prepared.push_back(source_shard);
+            response = Request(destination_shard, "PREPARE_CREDIT " + std::to_string(transfer_id) + " " +
+                                                      std::to_string(destination_bank) + " " + std::to_string(destination_customer) + " " +
+                                                      destination_account + " " + amount_text.str());
+            if (response == "OK")
+            {
+                if (destination_shard != source_shard)
+                    prepared.push_back(destination_shard);
+            }
+            else
+                failure = response;
+        }
+        else
+            failure = response;
+
+        // The decision is logged (and flushed, though not fsynced) before any participant hears it. The log is
+        // an audit trail only: workers keep their banks in memory and start empty, so nothing is recovered from it
+        bool commit = failure.empty();
+        m_decision_log << (commit ? "COMMIT " : "ABORT ") << transfer_id << " " << source_bank << "/" << source_account
+                       << " -> " << destination_bank << "/" << destination_account << " " << amount_text.str() << std::endl;
+
+        // Phase two. A participant that declines a leg it prepared leaves the transfer partly applied
+        std::string partial;
+        for (size_t shard : prepared)
+        {
+            response = Request(shard, std::string(commit ? "COMMIT " : "ABORT ") + std::to_string(transfer_id));
+            if (commit && response != "OK")
+                partial += "\n  shard " + std::to_string(shard) + ": " + response.substr(std::min<size_t>(4, response.size()));
+        }
+
+        if (!partial.empty())
+        {
+            m_decision_log << "PARTIAL " << transfer_id << std::endl;
+            out << "Error: Transfer #" << transfer_id << " was only partly committed; check the accounts." << partial << "\n";
+        }
+        else if (commit)
+            out << "Transfer #" << transfer_id << " committed ($" << amount_text.str() << " from " << source_account
+                << " on shard " << source_shard << " to " << destination_account << " on shard " << destination_shard << ").\n";
+        else
+            out << "Transfer #" << transfer_id << " aborted: " << failure.substr(std::min<size_t>(4, failure.size())) << "\n";
+    }
+
+    /**
+     * @brief Reads coordinator commands until "quit" or end of input.
+     * @param in The stream commands are read from.
+     * @param out The stream results are written to.
+     */
+    void ShardCoordinator::RunConsole(std::istream &in, std::ostream &out)
+    {
+        out << "Sharded mode: " << m_shards.size() << " shard(s). Type 'help' for commands.\n";
+
+        std::string line;
+        while (out << "shard> " << std::flush, std::getline(in, line))
+        {
+            std::istringstream args(line);
+            std::string command;
+            if (!(args >> command))
+                continue;
+
+            if (command == "quit" || command == "exit")
+                break;
+
+            if (command == "help")
+            {
+                out << "bank <name>\n"
+                    << "customer <bank_id> <first_name> <last_name> <age>\n"
+                    << "account <bank_id> <customer_id> <0: CHECKING, 1: SAVING> <initial_balance>\n"
+                    << "deposit|withdraw <bank_id> <customer_id> <account_id> <amount>\n"
+                    << "balance <bank_id> <customer_id> <account_id>\n"
+                    << "transfer <bank_id> <customer_id> <account_id> <dest_bank_id> <dest_customer_id> <dest_account_id> <amount>\n"
+                    << "banks | stats | audit | quit\n";
+            }
+            else if (command == "bank")
+            {
+                std::string name;
+                std::getline(args >> std::ws, name);
+                if (name.empty())
+                    out << "Error: Bank name required.\n";
+                else
+                    CreateBank(name, out);
+            }
+            else if (command == "customer")
+            {
+                i32 bank_id = 0, age = 0;
+                std::string first_name, last_name;
+                size_t shard;
+                if (!(args >> bank_id >> first_name >> last_name >> age) || age < MIN_AGE || age > MAX_AGE)
+                    out << "Error: Usage: customer <bank_id> <first_name> <last_name> <age>\n";
+                else if (Route(bank_id, shard, out))
+                    out << Request(shard, "ADD_CUSTOMER " + std::to_string(bank_id) + " " + std::to_string(age) + " " +
+                                              first_name + " " + last_name)
+                        << "\n";
+            }
+            else if (command == "account")
+            {
+                i32 bank_id = 0, customer_id = 0, account_type = -1;
+                f64 balance = 0.0;
+                size_t shard;
+                if (!(args >> bank_id >> customer_id >> account_type >> balance) ||
+                    account_type < MIN_ACCOUNT_TYPE || account_type > MAX_ACCOUNT_TYPE ||
+                    balance < MIN_STARTING_BALANCE || balance > MAX_BALANCE)
+                    out << "Error: Usage: account <bank_id> <customer_id> <0|1> <initial_balance>\n";
+                else if (Route(bank_id, shard, out))
+                    out << Request(shard, "ADD_ACCOUNT " + std::to_string(bank_id) + " " + std::to_string(customer_id) + " " +
+                                              std::to_string(account_type) + " " + std::to_string(balance))
+                        << "\n";
+            }
+            else if (command == "deposit" || command == "withdraw" || command == "balance")
+            {
+                i32 bank_id = 0, customer_id = 0;
+                std::string account_id;
+                f64 amount = 0.0;
+                size_t shard;
+                bool has_amount = command != "balance";
+                if (!(args >> bank_id >> customer_id >> account_id) || (has_amount && !(args >> amount)) ||
+                    (has_amount && (amount < MIN_TRANSACTION_AMOUNT || amount > MAX_TRANSACTION_AMOUNT)))
+                    out << "Error: Usage: " << command << " <bank_id> <customer_id> <account_id>" << (has_amount ? " <amount>" : "") << "\n";
+                else if (Route(bank_id, shard, out))
+                {
+                    std::string verb = command == "deposit" ? "DEPOSIT " : command == "withdraw" ? "WITHDRAW " : "BALANCE ";
+                    std::ostringstream request;
+                    request << verb << bank_id << " " << customer_id << " " << account_id;
+                    if (has_amount)
+                        request << " " << std::fixed << std::setprecision(2) << amount;
+                    out << Request(shard, request.str()) << "\n";
+                }
+            }
+            else if (command == "transfer")
+            {
+                i32 source_bank = 0, source_customer = 0, destination_bank = 0, destination_customer = 0;
+                std::string source_account, destination_account;
+                f64 amount = 0.0;
+                if (!(args >> source_bank >> source_customer >> source_account >> destination_bank >> destination_customer >> destination_account >> amount) ||
+                    amount < MIN_TRANSACTION_AMOUNT || amount > MAX_TRANSACTION_AMOUNT)
+                    out << "Error: Usage: transfer <bank_id> <customer_id> <account_id> <dest_bank_id> <dest_customer_id> <dest_account_id> <amount>\n";
+                else
+                    Transfer(source_bank, source_customer, source_account, destination_bank, destination_customer, destination_account, amount, out);
+            }
+            else if (command == "banks")
+            {
+                std::vector<std::pair<i32, size_t>> routes(m_routes.begin(), m_routes.end());
+                std::sort(routes.begin(), routes.end());
+                for (const auto &[bank_id, shard] : routes)
+                    out << "Bank " << bank_id << " -> shard " << shard << " (pid " << m_shards[shard].pid << ")\n";
+            }
+            else if (command == "stats" || command == "audit")
+            {
+                // Broadcast to every shard; the workers do the work in parallel
+                for (size_t shard = 0; shard < m_shards.size(); shard++)
+                    WriteLine(m_shards[shard].fd, command == "stats" ? "STATS" : "AUDIT");
+                for (size_t shard = 0; shard < m_shards.size(); shard++)
+                {
+                    std::string response;
+                    if (!ReadLine(m_shards[shard].fd, m_shards[shard].read_buffer, response))
+                        response = "ERR not responding";
+                    std::istringstream fields(response);
+                    std::string status;
+                    size_t a = 0, b = 0, c = 0, d = 0;
+                    fields >> status >> a >> b >> c >> d;
+                    if (status != "OK")
+                        out << "Shard " << shard << ": " << response << "\n";
+                    else if (command == "stats")
+                        out << "Shard " << shard << ": " << a << " bank(s), " << b << " customer(s), " << c
+                            << " account(s), " << d << " prepared transfer(s)\n";
+                    else
+                        out << "Shard " << shard << ": audited " << a << " account(s), " << b
+                            << " transaction(s), " << c << " discrepancy(ies)\n";
+                }
+            }
+            else
+            {
+                out << "Error: Unknown command. Type 'help' for commands.\n";
+            }
+        }
+    }
+
+    /**
+     * @brief Starts the coordinator and its workers, runs the console on stdin/stdout, then shuts down.
+     * @param shard_count The number of worker processes.
+     * @return The process exit code.
+     */
+    i32 RunShardedMode(size_t shard_count)
+    {
+        ShardCoordinator coordinator;
+        if (!coordinator.Start(shard_count))
+            return 1;
+        coordinator.RunConsole(std::cin, std::cout);
+        coordinator.Stop();
+        return 0;
+    }
+#else
+    i32 RunShardedMode(size_t)
+    {
+        std::cerr << "Error: Sharded mode requires a POSIX system.\n";
+        return 1;
+    }
+#endif
+}
@@ -0,0 +1,115 @@
+/**
+ * @file sim_clock.cpp
+ * @brief This file implements the SimClock class, the simulated time source for the Bank Management System.
+ */
+
+#include "../include/sim_clock.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+namespace Bank
+{
+    namespace
+    {
+        /**
+         * @brief Splits a timestamp into its calendar date.
+         */
+        std::chrono::year_month_day ToDate(i64 time)
+        {
+            using namespace std::chrono;
+            return year_month_day{floor<days>(sys_seconds{seconds{time}})};
+        }
+    }
+
+    /**
+     * @brief Starts the simulated clock at midnight (UTC) of the current real day.
+     */
+    SimClock::SimClock()
+    {
+        using namespace std::chrono;
+        m_now = floor<days>(system_clock::now()).time_since_epoch() / seconds{1};
+    }
+
+    /**
+     * @brief Returns the process-wide simulated clock.
+     * @return A reference to the shared SimClock.
+     */
+    SimClock &SimClock::Shared()
+    {
+        static SimClock clock;
+        return clock;
+    }
+
+    /**
+     * @brief Moves the clock forward by the given number of seconds. Negative values are ignored.
+     * @param seconds The number of seconds to advance.
+     */
+    void SimClock::AdvanceBy(i64 seconds)
+    {
+        if (seconds > 0)
+            m_now += seconds;
+    }
+
+    /**
+     * @brief Moves the clock forward to the given time. The clock never moves backwards.
+     * @param time The target time in seconds since the epoch.
+     */
+    void SimClock::AdvanceTo(i64 time)
+    {
+        if (time > m_now)
+            m_now = time;
+    }
+
+    /**
+     * @brief Adds whole calendar months to a timestamp, keeping the time of day.
+     *
+     * The day of month is taken from anchor_day and clamped to the length of the target month,
+     * so a schedule anchored on the 31st runs on the 30th in April and the 28th/29th in February
+     * without drifting for the rest of the year.
+     *
+     * @param time The starting time in seconds since the epoch.
+     * @param months The number of months to add.
+     * @param anchor_day The preferred day of month (1-31).
+     * @return The resulting time in seconds since the epoch.
+     */
+    i64 SimClock::AddMonths(i64 time, i32 months, i32 anchor_day)
+    {
+        using namespace std::chrono;
+        sys_days day = floor<days>(sys_seconds{seconds{time}});
+        i64 time_of_day = time - day.time_since_epoch() / seconds{1};
+
+        year_month target = year_month{year_month_day{day}.year(), year_month_day{day}.month()} + std::chrono::months{months};
+        year_month_day_last last_day{target.year(), month_day_last{target.month()}};
+        unsigned clamped_day = std::min<unsigned>(static_cast<unsigned>(anchor_day), static_cast<unsigned>(last_day.day()));
+
+        sys_days result{year_month_day{target.year(), target.month(), std::chrono::day{clamped_day}}};
+        return result.time_since_epoch() / seconds{1} + time_of_day;
+    }
+
+    /**
+     * @brief Returns the day of month (1-31) of a timestamp.
+     * @param time The time in seconds since the epoch.
+     * @return The calendar day of the month.
+     */
+    i32 SimClock::DayOfMonth(i64 time)
+    {
+        return static_cast<i32>(static_cast<unsigned>(ToDate(time).day()));
+    }
+
+    /**
+     * @brief Formats a timestamp as "YYYY-MM-DD".
+     * @param time The time in seconds since the epoch.
+     * @return The formatted date.
+     */
+    std::string SimClock::FormatDate(i64 time)
+    {
+        std::chrono::year_month_day date = ToDate(time);
+        char buffer[16];
+        std::snprintf(buffer, sizeof(buffer), "%04d-%02u-%02u",
+                      static_cast<int>(date.year()),
+                      static_cast<unsigned>(date.month()),
+                      static_cast<unsigned>(date.day()));
+        return buffer;
+    }
+}
@@ -0,0 +1,456 @@
+/**
+ * @file snapshot.cpp
+ * @brief This file implements multi-version snapshots of the bank graph, so long reads see a consistent
+ *        point-in-time view while transactions keep committing.
+ */
+
+#include "../include/snapshot.hpp"
+#include "../include/bank.hpp"
+#include "../include/bank_account.hpp"
+#include "../include/customer.hpp"
+#include "../include/global.hpp"
+#include "../include/trace.hpp"
+#include "../include/transaction.hpp"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+
+namespace Bank
+{
+    namespace
+    {
+        std::atomic<size_t> g_live_versions{0};
+    }
+
+    /**
+     * @brief Returns the account's balance as of a (possibly later) interest period of its Bank.
+     *
+     * Savings balances are captured at one period and compounded forward on read, using the same
+     * arithmetic as BankAccount::CompoundInterest, so an interest rollover never forces a republish of
+     * every account.
+     *
+     * @param bank_interest_period The interest period of the BankImage this account was read through.
+     * @return The settled balance.
+     */
+    f64 AccountImage::GetBalance(u64 bank_interest_period) const
+    {
+        f64 settled = balance;
+        if (account_type == AccountType::SAVING && INTEREST_RATE >= 0)
+        {
+            for (u64 period = interest_period; period < bank_interest_period; period++)
+                settled += settled * INTEREST_RATE;
+        }
+        return settled;
+    }
+
+    /**
+     * @brief Returns the account's transactions ordered by transaction ID, as the live account stores them.
+     *
+     * Archived transactions are read back from disk and merged in, so callers see the whole history.
+     *
+     * @return Copies of the transactions.
+     */
+    std::vector<TransactionImage> AccountImage::GetTransactionsByID() const
+    {
+        std::vector<TransactionImage> transactions;
+        transactions.reserve(transaction_count);
+        if (archived)
+            archived->Load(transactions);
+        for (const auto &block : blocks)
+            block->Decode(transactions);
+        if (tail)
+            transactions.insert(transactions.end(), tail->begin(), tail->end());
+        std::sort(transactions.begin(), transactions.end(), [](const TransactionImage &a, const TransactionImage &b)
+                  { return a.transaction_id < b.transaction_id; });
+        return transactions;
+    }
+
+    /**
+     * @brief Displays all transactions captured for this account, in the same format as BankAccount::ViewAccountTransactions.
+     */
+    void AccountImage::ViewAccountTransactions() const
+    {
+        std::vector<TransactionImage> transactions = GetTransactionsByID();
+
+        std::cout << "Transactions for account #" << account_id << ":\n";
+        std::cout << "--------------------------------\n";
+        for (size_t i = 0; i < transactions.size(); i++)
+        {
+            const TransactionImage &t = transactions[i];
+            std::cout << "Transaction #" << (i + 1) << std::endl;
+            DisplayTransactionDetails(t.transaction_id, t.transaction_type, t.timestamp,
+                                      t.amount, t.balance_before, t.balance_after);
+            std::cout << "--------------------------------\n";
+        }
+    }
+
+    /**
+     * @brief Looks up one of this customer's accounts by ID.
+     * @param account_id The ID of the account to find.
+     * @return A pointer to the AccountImage if found, otherwise nullptr.
+     */
+    const AccountImage *CustomerImage::FindAccount(AccountID account_id) const
+    {
+        // Accounts are in the order they were opened, and a customer has only a handful
+        auto it = std::find_if(accounts.begin(), accounts.end(),
+                               [account_id](const std::shared_ptr<const AccountImage> &a)
+                               { return a->account_id == account_id; });
+        return it != accounts.end() ? it->get() : nullptr;
+    }
+
+    /**
+     * @brief Displays the customer's basic information, in the same format as Customer::DisplayCustomerInfo.
+     */
+    void CustomerImage::DisplayCustomerInfo() const
+    {
+        std::cout << "Customer ID: " << customer_id << std::endl;
+        std::cout << "First name: " << first_name << std::endl;
+        std::cout << "Last name: " << last_name << std::endl;
+        std::cout << "Age: " << age << std::endl;
+    }
+
+    /**
+     * @brief Looks up one of this bank's customers by ID.
+     * @param customer_id The ID of the customer to find.
+     * @return A pointer to the CustomerImage if found, otherwise nullptr.
+     */
+    const CustomerImage *BankImage::FindCustomer(i32 customer_id) const
+    {
+        // Customers are in the order they were added, so this is a scan; it only serves interactive lookups
+        auto it = std::find_if(customers.begin(), customers.end(),
+                               [customer_id](const std::shared_ptr<const CustomerImage> &c)
+                               { return c->customer_id == customer_id; });
+        return it != customers.end() ? it->get() : nullptr;
+    }
+
+    /**
+     * @brief Outputs all customers' information, in the same format as Bank::ViewAllCustomers.
+     */
+    void BankImage::ViewAllCustomers() const
+    {
+        for (size_t i = 0; i < customers.size(); i++)
+        {
+            std::cout << "---------------------------------" << std::endl;
+            std::cout << "Customer #" << i + 1 << std::endl;
+            customers[i]->DisplayCustomerInfo();
+        }
+        std::cout << "---------------------------------" << std::endl;
+    }
+
+    /**
+     * @brief Counts a new version as live until its destructor runs.
+     */
+    SystemImage::SystemImage()
+    {
+        g_live_versions++;
+    }
+
+    /**
+     * @brief Releases a version once no reader or newer root references it.
+     */
+    SystemImage::~SystemImage()
+    {
+        g_live_versions--;
+    }
+
+    /**
+     * @brief Looks up a bank by ID.
+     * @param bank_id The ID of the bank to find.
+     * @return A pointer to the BankImage if found, otherwise nullptr.
+     */
+    const BankImage *SystemImage::FindBank(i32 bank_id) const
+    {
+        auto it = std::lower_bound(banks.begin(), banks.end(), bank_id,
+                                   [](const std::shared_ptr<const BankImage> &b, i32 id)
+                                   { return b->bank_id < id; });
+        return (it != banks.end() && (*it)->bank_id == bank_id) ? it->get() : nullptr;
+    }
+
+    /**
+     * @brief Writes this version in the 'bank_info.txt' format.
+     * @param os The stream to write to.
+     */
+    void SystemImage::WriteToStream(std::ostream &os) const
+    {
+        for (const auto &bank : banks)
+        {
+            os << "Bank: " << bank->bank_id << " | " << bank->bank_name << std::endl;
+            for (const auto &customer : bank->customers)
+            {
+                os << "\t"
+                   << "Customer: " << customer->customer_id << " | "
+                   << customer->GetName() << " | " << customer->age << std::endl;
+                for (const auto &account : customer->accounts)
+                {
+                    os << "\t\t"
+                       << "Account: " << account->account_id << " | $"
+                       << std::fixed << std::setprecision(2) << account->GetBalance(bank->interest_period) << std::endl;
+                    for (const TransactionImage &transaction : account->GetTransactionsByID())
+                    {
+                        os << "\t\t\t"
+                           << "Transaction: " << transaction.transaction_id << " | $"
+                           << std::fixed << std::setprecision(2)
+                           << transaction.amount << " | "
+                           << TransactionTypeToString(transaction.transaction_type);
+
+                        // If it was invalid, add an extra marker
+                        if (transaction.was_invalid)
+                        {
+                            os << " [INVALID]";
+                        }
+                        os << '\n';
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+     * @class SnapshotManager
+     * @brief Tracks changes to the live bank graph and publishes immutable versions of it.
+     */
+
+    /**
+     * @brief Starts with an empty published version so readers never see a null snapshot.
+     */
+    SnapshotManager::SnapshotManager()
+    {
+        m_current.store(std::make_shared<const SystemImage>());
+    }
+
+    /**
+     * @brief Returns the process-wide snapshot manager.
+     * @return A reference to the shared SnapshotManager.
+     */
+    SnapshotManager &SnapshotManager::Shared()
+    {
+        static SnapshotManager manager;
+        return manager;
+    }
+
+    /**
+     * @brief Records that the set of banks has changed (a bank was added).
+     */
+    void SnapshotManager::MarkBanksDirty()
+    {
+        std::lock_guard<std::mutex> lock(m_dirty_mutex);
+        m_banks_dirty = true;
+    }
+
+    /**
+     * @brief Records that a bank's own fields or its list of customers have changed.
+     * @param bank The bank that changed.
+     */
+    void SnapshotManager::MarkDirty(const Bank &bank)
+    {
+        std::lock_guard<std::mutex> lock(m_dirty_mutex);
+        m_dirty_banks.insert(&bank);
+    }
+
+    /**
+     * @brief Records that a customer's fields or list of accounts have changed.
+     * @param customer The customer that changed.
+     */
+    void SnapshotManager::MarkDirty(const Customer &customer)
+    {
+        std::lock_guard<std::mutex> lock(m_dirty_mutex);
+        m_dirty_customers.insert(&customer);
+        m_dirty_banks.insert(&customer.GetBank());
+    }
+
+    /**
+     * @brief Records that an account's balance changed, optionally because of a new transaction.
+     * @param account The account that changed.
+     * @param new_transaction The transaction appended to the account, if any.
+     */
+    void SnapshotManager::MarkDirty(const BankAccount &account, const Transaction *new_transaction)
+    {
+        std::lock_guard<std::mutex> lock(m_dirty_mutex);
+        // Keep a copy rather than the pointer, since the account may seal or archive the transaction before Publish
+        std::vector<TransactionImage> &pending = m_dirty_accounts[&account];
+        if (new_transaction)
+            pending.push_back(CaptureTransaction(*new_transaction));
+        m_dirty_customers.insert(&account.GetAccountOwner());
+        m_dirty_banks.insert(&account.GetAccountOwner().GetBank());
+    }
+
+    /**
+     * @brief Records that some of an account's transactions were moved to its bank's archive.
+     *
+     * The account's next image is captured afresh rather than appended to, so it no longer holds the
+     * archived transactions in memory (older versions keep theirs until released).
+     *
+     * @param account The account whose history was archived.
+     */
+    void SnapshotManager::MarkArchived(const BankAccount &account)
+    {
+        std::lock_guard<std::mutex> lock(m_dirty_mutex);
+        m_dirty_accounts[&account].clear(); // Anything pending that was not archived will be captured anyway
+        m_archived_accounts.insert(&account);
+        m_dirty_customers.insert(&account.GetAccountOwner());
+        m_dirty_banks.insert(&account.GetAccountOwner().GetBank());
+    }
+
+    /**
+     * @brief Builds the next image of an account from its previous image plus the transactions appended since.
+     */
+    std::shared_ptr<const AccountImage> SnapshotManager::BuildAccountImage(const BankAccount &account,
+                                                                           std::vector<TransactionImage> new_transactions)
+    {
+        auto image = std::make_shared<AccountImage>();
+        image->account_id = account.GetID();
+        image->account_type = account.GetAccountType();
+        image->balance = account.GetBalance(); // Settles interest, so the balance matches the bank's period
+        image->interest_period = account.GetAccountOwner().GetBank().GetInterestPeriod();
+        image->archived = account.GetArchivedHistory();
+
+        std::vector<TransactionImage> appended;
+        auto previous = m_account_images.find(&account);
+        if (previous != m_account_images.end())
+        {
+            image->blocks = previous->second->blocks;
+            image->tail = previous->second->tail;
+            image->transaction_count = previous->second->transaction_count;
+            appended = std::move(new_transactions);
+            std::sort(appended.begin(), appended.end(), [](const TransactionImage &a, const TransactionImage &b)
+                      { return a.sequence < b.sequence; });
+        }
+        else
+        {
+            // First image of this account (or first since archiving): capture everything still in memory
+            image->transaction_count = image->archived ? image->archived->transaction_count : 0;
+            account.GetResidentHistory(appended);
+        }
+
+        if (!appended.empty())
+        {
+            // Copy the tail instead of extending one an older version may hold, and seal it each time it fills
+            auto tail = image->tail ? std::make_shared<TransactionChunk>(*image->tail) : std::make_shared<TransactionChunk>();
+            for (const TransactionImage &transaction : appended)
+            {
+                tail->push_back(transaction);
+                if (tail->size() == SNAPSHOT_CHUNK_SIZE)
+                {
+                    image->blocks.push_back(std::make_shared<const TransactionBlock>(tail->data(), tail->size()));
+                    tail->clear();
+                }
+            }
+            image->transaction_count += appended.size();
+            image->tail = tail->empty() ? nullptr : std::move(tail);
+        }
+
+        m_account_images[&account] = image;
+        return image;
+    }
+
+    /**
+     * @brief Builds the next image of a customer, reusing the current image of each unchanged account.
+     */
+    std::shared_ptr<const CustomerImage> SnapshotManager::BuildCustomerImage(const Customer &customer)
+    {
+        auto image = std::make_shared<CustomerImage>();
+        image->customer_id = customer.GetID();
+        image->first_name = customer.GetFirstName();
+        image->last_name = customer.GetLastName();
+        image->name = customer.GetName();
+        image->age = customer.GetAge();
+        image->accounts.reserve(customer.GetAccounts().size());
+
+        for (const BankAccount &account : customer.GetAccounts())
+        {
+            auto it = m_account_images.find(&account);
+            image->accounts.push_back(it != m_account_images.end() ? it->second : BuildAccountImage(account, {}));
+        }
+
+        m_customer_images[&customer] = image;
+        return image;
+    }
+
+    /**
+     * @brief Builds the next image of a bank, reusing the current image of each unchanged customer.
+     */
+    std::shared_ptr<const BankImage> SnapshotManager::BuildBankImage(const Bank &bank)
+    {
+        auto image = std::make_shared<BankImage>();
+        image->bank_id = bank.GetID();
+        image->bank_name = bank.GetName();
+        image->interest_period = bank.GetInterestPeriod();
+        image->customers.reserve(bank.GetCustomers().size());
+
+        for (const Customer &customer : bank.GetCustomers())
+        {
+            auto it = m_customer_images.find(&customer);
+            image->customers.push_back(it != m_customer_images.end() ? it->second : BuildCustomerImage(customer));
+        }
+
+        m_bank_images[&bank] = image;
+        return image;
+    }
+
+    /**
+     * @brief Publishes a new version containing every change marked since the last one.
+     *
+     * Only the changed accounts, their customers and their banks get new images; everything else is
+     * shared with the previous version. Must be called from the thread that mutates the bank graph,
+     * at a point where no mutation is half-done.
+     *
+     * @param banks A const reference to a vector of unique_ptr to Bank objects.
+     * @return The newly published version (or the current one if nothing changed).
+     */
+    std::shared_ptr<const SystemImage> SnapshotManager::Publish(const std::vector<std::unique_ptr<Bank>> &banks)
+    {
+        TraceSpan span("Publish");
+        std::lock_guard<std::mutex> publish_lock(m_publish_mutex);
+
+        bool banks_dirty;
+        std::unordered_set<const Bank *> dirty_banks;
+        std::unordered_set<const Customer *> dirty_customers;
+        std::unordered_map<const BankAccount *, std::vector<TransactionImage>> dirty_accounts;
+        std::unordered_set<const BankAccount *> archived_accounts;
+        {
+            std::lock_guard<std::mutex> lock(m_dirty_mutex);
+            banks_dirty = m_banks_dirty;
+            m_banks_dirty = false;
+            dirty_banks.swap(m_dirty_banks);
+            dirty_customers.swap(m_dirty_customers);
+            dirty_accounts.swap(m_dirty_accounts);
+            archived_accounts.swap(m_archived_accounts);
+        }
+
+        if (!banks_dirty && dirty_banks.empty())
+            return m_current.load();
+
+        for (const BankAccount *account : archived_accounts)
+            m_account_images.erase(account);
+
+        // Rebuild bottom-up so each level picks up the fresh images of the level below
+        for (auto &[account, new_transactions] : dirty_accounts)
+            BuildAccountImage(*account, std::move(new_transactions));
+        for (const Customer *customer : dirty_customers)
+            BuildCustomerImage(*customer);
+        for (const Bank *bank : dirty_banks)
+            BuildBankImage(*bank);
+
+        auto root = std::make_shared<SystemImage>();
+        root->version = ++m_version;
+        root->banks.reserve(banks.size());
+        for (const auto &bank : banks)
+        {
+            auto it = m_bank_images.find(bank.get());
+            root->banks.push_back(it != m_bank_images.end() ? it->second : BuildBankImage(*bank));
+        }
+
+        std::shared_ptr<const SystemImage> published = std::move(root);
+        m_current.store(published);
+        return published;
+    }
+
+    /**
+     * @brief Returns how many versions are still alive (the current one plus any held by readers).
+     * @return The number of SystemImage objects not yet reclaimed.
+     */
+    size_t SnapshotManager::GetLiveVersions()
+    {
+        return g_live_versions.load();
+    }
+}
@@ -0,0 +1,88 @@
+/**
+ * @file string_pool.cpp
+ * @brief This file implements the StringPool, which interns names so they are stored once and read without allocating.
+ */
+
+#include "../include/string_pool.hpp"
+#include <cstring>
+
+namespace Bank
+{
+    /**
+     * @class StringPool
+     * @brief An append-only set of strings with stable storage.
+     */
+
+    /**
+     * @brief Returns the process-wide string pool.
+     */
+    StringPool &StringPool::Shared()
+    {
+        static StringPool pool;
+        return pool;
+    }
+
+    /**
+     * @brief Returns the pooled copy of a string, adding it if it is not there yet.
+     * @param text The string to intern.
+     * @return A view of the pooled copy, valid until the program exits.
+     */
+    std::string_view StringPool::Intern(std::string_view text)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        auto it = m_strings.find(text);
+        if (it != m_strings.end())
+            return *it;
+
+        char *storage;
+        if (text.size() > BLOCK_SIZE / 4)
+        {
+            // Unusually long strings get storage of their own instead of wasting the rest of the current block
+            m_large.push_back(std::make_unique<char[]>(text.size()));
+            storage = m_large.back().get();
+            m_large_bytes += text.size();
+        }
+        else
+        {
+            if (m_block_used + text.size() > BLOCK_SIZE)
+            {
+                m_blocks.push_back(std::make_unique<char[]>(BLOCK_SIZE));
+                m_block_used = 0;
+            }
+            storage = m_blocks.back().get() + m_block_used;
+            m_block_used += text.size();
+        }
+
+        std::memcpy(storage, text.data(), text.size());
+        m_bytes += text.size();
+        return *m_strings.insert(std::string_view(storage, text.size())).first;
+    }
+
+    /**
+     * @brief Returns how many distinct strings have been interned.
+     */
+    size_t StringPool::GetStringCount()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_strings.size();
+    }
+
+    /**
+     * @brief Returns how many bytes of string data the pool holds.
+     */
+    size_t StringPool::GetBytes()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_bytes;
+    }
+
+    /**
+     * @brief Returns how many bytes the pool has allocated for string data, including the unused end of each block.
+     */
+    size_t StringPool::GetReservedBytes()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_blocks.size() * BLOCK_SIZE + m_large_bytes;
+    }
+}
@@ -0,0 +1,72 @@
+/**
+ * @file thread_pool.cpp
+ * @brief This file implements the ThreadPool class used to run bulk passes over the bank data in parallel.
+ */
+
+#include "../include/thread_pool.hpp"
+
+/**
+ * @brief Starts the requested number of worker threads (at least one).
+ * @param thread_count The number of worker threads to create.
+ */
+ThreadPool::ThreadPool(size_t thread_count)
+{
+    if (thread_count == 0)
+        thread_count = 1;
+
+    m_workers.reserve(thread_count);
+    for (size_t i = 0; i < thread_count; i++)
+    {
+        m_workers.emplace_back([this]()
+                               { WorkerLoop(); });
+    }
+}
+
+/**
+ * @brief Drains the remaining tasks and joins every worker thread.
+ */
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_condition.notify_all();
+
+    for (auto &worker : m_workers)
+        worker.join();
+}
+
+/**
+ * @brief Returns the process-wide pool, sized to the number of hardware threads.
+ * @return A reference to the shared ThreadPool.
+ */
+ThreadPool &ThreadPool::Shared()
+{
+    static ThreadPool pool;
+    return pool;
+}
+
+/**
+ * @brief Repeatedly takes a task off the queue and runs it until the pool is stopped.
+ */
+void ThreadPool::WorkerLoop()
+{
+    while (true)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this]()
+                             { return m_stopping || !m_tasks.empty(); });
+
+            // Only exit once all queued work has been handed out
+            if (m_stopping && m_tasks.empty())
+                return;
+
+            task = std::move(m_tasks.front());
+            m_tasks.pop();
+        }
+        task();
+    }
+}
@@ -0,0 +1,208 @@
+/**
+ * @file trace.cpp
+ * @brief This file implements the tracer, which writes a timeline of nested spans as Chrome trace-event JSON.
+ */
+
+#include "../include/trace.hpp"
+#include "../include/global.hpp"
+#include <iomanip>
+#include <iostream>
+
+namespace Bank
+{
+    /**
+     * @brief Stops the writer, if a trace is open, so that the file is complete.
+     */
+    Tracer::~Tracer()
+    {
+        Close();
+    }
+
+    /**
+     * @brief Returns the process-wide tracer.
+     */
+    Tracer &Tracer::Shared()
+    {
+        static Tracer tracer;
+        return tracer;
+    }
+
+    /**
+     * @brief Starts tracing to a file, which is overwritten.
+     * @param path The file to write.
+     * @return False if a trace was already started or the file could not be opened.
+     */
+    bool Tracer::Open(const std::string &path)
+    {
+        if (m_writer.joinable())
+        {
+            std::cerr << "Error: A trace is already being written to " << m_path << ".\n";
+            return false;
+        }
+
+        m_stream.open(path, std::ios::trunc);
+        if (!m_stream)
+            return false;
+
+        // Times are written in microseconds, as the format expects, to the nanosecond
+        m_stream << std::fixed << std::setprecision(3) << "{\"traceEvents\":[\n";
+        m_path = path;
+        m_origin = std::chrono::steady_clock::now();
+        m_stopping = false;
+        m_writer = std::thread(&Tracer::WriterLoop, this);
+        m_enabled.store(true, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Stops tracing, writes every span recorded so far and completes the file.
+     * @return The number of spans written, or 0 if no trace was open.
+     */
+    u64 Tracer::Close()
+    {
+        if (!m_writer.joinable())
+            return 0;
+
+        m_enabled.store(false);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_condition.notify_one();
+        m_writer.join();
+
+        // Spans that threads finished while the writer made its last pass
+        std::vector<std::vector<TraceEvent>> batches;
+        CollectBuffers(batches);
+        for (const auto &batch : batches)
+            Write(batch);
+
+        m_stream << "\n],\"displayTimeUnit\":\"ms\"}\n";
+        m_stream.close();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_buffers.clear();
+        }
+        return m_events_written;
+    }
+
+    /**
+     * @brief Returns the calling thread's buffer, registering it with the writer on the thread's first span.
+     */
+    Tracer::ThreadBuffer &Tracer::GetThreadBuffer()
+    {
+        // The writer shares ownership, so a thread may exit without handing over what it recorded
+        thread_local std::shared_ptr<ThreadBuffer> t_buffer;
+        if (!t_buffer)
+        {
+            auto buffer = std::make_shared<ThreadBuffer>();
+            std::lock_guard<std::mutex> lock(m_mutex);
+            buffer->thread = m_next_thread++;
+            m_buffers.push_back(buffer);
+            t_buffer = std::move(buffer);
+        }
+        return *t_buffer;
+    }
+
+    /**
+     * @brief Records a finished span in the calling thread's buffer, handing the buffer to the writer once it is full.
+     * @param name The span's name, which must be a string literal.
+     * @param start_ns When the span started, as returned by Now.
+     * @param duration_ns How long it lasted.
+     */
+    void Tracer::Record(const char *name, i64 start_ns, i64 duration_ns)
+    {
+        if (!IsEnabled())
+            return;
+
+        ThreadBuffer &buffer = GetThreadBuffer();
+        std::vector<TraceEvent> full;
+        {
+            std::lock_guard<std::mutex> lock(buffer.mutex);
+            buffer.events.push_back({name, start_ns, duration_ns, buffer.thread});
+            if (buffer.events.size() < TRACE_BUFFER_EVENTS)
+                return;
+            full.swap(buffer.events);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_pending.push_back(std::move(full));
+        }
+        m_condition.notify_one();
+    }
+
+    /**
+     * @brief Takes over the full buffers handed to the writer and whatever every thread has recorded since,
+     *        and forgets the buffers of threads that have exited.
+     * @param out The vector to append the spans to, one batch per buffer.
+     */
+    void Tracer::CollectBuffers(std::vector<std::vector<TraceEvent>> &out)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto &pending : m_pending)
+            out.push_back(std::move(pending));
+        m_pending.clear();
+
+        for (size_t i = 0; i < m_buffers.size();)
+        {
+            ThreadBuffer &buffer = *m_buffers[i];
+            {
+                std::lock_guard<std::mutex> buffer_lock(buffer.mutex);
+                if (!buffer.events.empty())
+                    out.push_back(std::move(buffer.events));
+                buffer.events.clear();
+            }
+
+            // Only the writer still holds the buffer once its thread has exited
+            if (m_buffers[i].use_count() == 1)
+            {
+                m_buffers[i] = std::move(m_buffers.back());
+                m_buffers.pop_back();
+            }
+            else
+            {
+                i++;
+            }
+        }
+    }
+
+    /**
+     * @brief Writes spans as they are handed over, and every TRACE_FLUSH_INTERVAL_MS, until the trace is closed.
+     */
+    void Tracer::WriterLoop()
+    {
+        bool stopping = false;
+        while (!stopping)
+        {
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_condition.wait_for(lock, std::chrono::milliseconds(TRACE_FLUSH_INTERVAL_MS), [this]()
+                                     { return m_stopping || !m_pending.empty(); });
+                stopping = m_stopping;
+            }
+
+            std::vector<std::vector<TraceEvent>> batches;
+            CollectBuffers(batches);
+            for (const auto &batch : batches)
+                Write(batch);
+            m_stream.flush();
+        }
+    }
+
+    /**
+     * @brief Writes spans as Chrome trace "complete" events.
+     * @param events The spans to write.
+     */
+    void Tracer::Write(const std::vector<TraceEvent> &events)
+    {
+        for (const TraceEvent &event : events)
+        {
+            if (m_events_written++ > 0)
+                m_stream << ",\n";
+            m_stream << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.thread
+                     << ",\"ts\":" << static_cast<f64>(event.start_ns) / 1000.0
+                     << ",\"dur\":" << static_cast<f64>(event.duration_ns) / 1000.0 << "}";
+        }
+    }
+}
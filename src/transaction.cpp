@@ -4,7 +4,10 @@
  */
 
 #include "../include/bank_account.hpp"
+#include "../include/activity_log.hpp"
 #include "../include/global.hpp"
+#include "../include/sim_clock.hpp"
+#include "../include/trace.hpp"
 #include <iostream>
 #include <cassert>
 #include <random>
@@ -21,16 +24,40 @@ namespace Bank
      * @param account A reference to the BankAccount on which the transaction is performed.
      * @param amount The transaction amount.
      * @param transaction_type The type of transaction (DEPOSIT, WITHDRAW, or TRANSFER).
-     * @param transfer_account_index The index of the destination account for transfers (ignored otherwise).
+     * @param destination_account_id The ID of the destination account for transfers (ignored otherwise).
+     * @param transaction_id The ID to assign, or 0 to generate a random one.
      */
-    Transaction::Transaction(BankAccount &account, f64 amount, TransactionType transaction_type, const std::string &destination_account_id)
-        : m_associated_account(account), m_transaction_amount(amount),
-          m_transaction_type(transaction_type), m_destination_account_id(destination_account_id)
+    Transaction::Transaction(BankAccount &account, f64 amount, TransactionType transaction_type, AccountID destination_account_id,
+                             i32 transaction_id)
+        : m_sequence(account.m_next_sequence++), m_associated_account(account.GetHandle()), m_transaction_amount(amount),
+          m_destination_account_id(destination_account_id), m_transaction_type(transaction_type),
+          m_timestamp(SimClock::Shared().Now())
+    {
+        // Assign a unique random transaction ID, unless one is given (e.g. when replaying a replication log)
+        if (transaction_id != 0)
+            m_transaction_id = transaction_id;
+        else
+            GenerateTransactionID();
+        ActivityLog() << "Transaction created for " << account.GetAccountOwner().GetName()
+                      << " (Transaction ID: " << m_transaction_id << ")" << std::endl;
+        ExecuteTransaction(account); // Execute the transaction right upon creation
+    }
+
+    /**
+     * @brief Recreates an executed Transaction from its image, without executing it again.
+     *
+     * Images do not record a transfer's destination, so the recreated transaction has none, as when
+     * the transaction is read back from a sealed block.
+     *
+     * @param account The account the transaction belongs to.
+     * @param image The transaction as it was recorded.
+     */
+    Transaction::Transaction(const BankAccount &account, const TransactionImage &image)
+        : m_transaction_id(image.transaction_id), m_sequence(image.sequence), m_associated_account(account.GetHandle()),
+          m_transaction_amount(image.amount), m_transaction_type(image.transaction_type),
+          m_balance_before_transaction(image.balance_before), m_balance_after_transaction(image.balance_after),
+          m_was_invalid(image.was_invalid), m_timestamp(image.timestamp)
     {
-        GenerateTransactionID(); // Assign a unique random transaction ID
-        std::cout << "Transaction created for " << m_associated_account.GetAccountOwner().GetName()
-                  << " (Transaction ID: " << m_transaction_id << ")" << std::endl;
-        ExecuteTransaction(); // Execute the transaction right upon creation
     }
 
     /**
@@ -39,39 +66,87 @@ namespace Bank
     Transaction::~Transaction()
     {
         // Log message when Transaction is destroyed
-        std::cout << "Deleting transaction" << std::endl;
+        ActivityLog() << "Deleting transaction" << std::endl;
     }
 
     /**
      * @brief Executes the transaction by calling the appropriate method on the associated BankAccount.
+     * @param account The associated BankAccount.
      */
-    void Transaction::ExecuteTransaction()
+    void Transaction::ExecuteTransaction(BankAccount &account)
     {
+        TraceSpan span("ExecuteTransaction");
+
         // Record the balance before
-        m_balance_before_transaction = m_associated_account.GetBalance();
+        m_balance_before_transaction = account.GetBalance();
 
         // Decide which operation to perform based on transaction type
         if (m_transaction_type == TransactionType::DEPOSIT)
         {
-            m_associated_account.Deposit(m_transaction_amount);
+            account.Deposit(m_transaction_amount);
+        }
+        else if (!WithinVelocityLimits(account))
+        {
+            // Too many or too large withdrawals recently; nothing leaves the account
+            m_was_invalid = true;
         }
-        else if (m_transaction_type == TransactionType::WITHDRAW)
+        else
         {
-            bool success = m_associated_account.Withdraw(m_transaction_amount);
+            bool success;
+            if (m_transaction_type == TransactionType::WITHDRAW)
+            {
+                success = account.Withdraw(m_transaction_amount);
+            }
+            else
+            {
+                // Perform a Transfer, which fails if the destination account cannot be found
+                success = account.Transfer(m_destination_account_id, m_transaction_amount);
+            }
+
             if (!success)
             {
-                // Mark this transaction as invalid if withdrawal failed
+                // Mark this transaction as invalid if the withdrawal or transfer failed
                 m_was_invalid = true;
             }
+            else
+            {
+                // Only money that actually left counts towards the limits
+                if (VelocityTracker *account_limits = account.m_velocity.get())
+                    account_limits->Record(m_transaction_amount, m_timestamp);
+                if (VelocityTracker *customer_limits = account.GetAccountOwner().GetVelocityTracker())
+                    customer_limits->Record(m_transaction_amount, m_timestamp);
+            }
         }
-        else
+
+        // Capture the balance after
+        m_balance_after_transaction = account.GetBalance();
+    }
+
+    /**
+     * @brief Checks a withdrawal or transfer against the account's and the customer's velocity limits.
+     * @param account The associated BankAccount.
+     * @return True if neither limit would be exceeded (or none is set).
+     */
+    bool Transaction::WithinVelocityLimits(BankAccount &account) const
+    {
+        std::string reason;
+        VelocityTracker *account_limits = account.m_velocity.get();
+        if (account_limits && !account_limits->Allows(m_transaction_amount, m_timestamp, reason))
         {
-            // Perform a Transfer
-            m_associated_account.Transfer(m_destination_account_id, m_transaction_amount);
+            std::cerr << "Error: Velocity limit exceeded for account " << account.GetID()
+                      << " (" << reason << "). Transaction denied.\n";
+            return false;
         }
 
-        // Capture the balance after
-        m_balance_after_transaction = m_associated_account.GetBalance();
+        Customer &customer = account.GetAccountOwner();
+        VelocityTracker *customer_limits = customer.GetVelocityTracker();
+        if (customer_limits && !customer_limits->Allows(m_transaction_amount, m_timestamp, reason))
+        {
+            std::cerr << "Error: Velocity limit exceeded for " << customer.GetName()
+                      << " (" << reason << "). Transaction denied.\n";
+            return false;
+        }
+        return true;
     }
 
     /**
@@ -89,36 +164,68 @@ namespace Bank
      */
     void Transaction::DisplayTransaction() const
     {
-        std::string transaction_type = GetTransactionType();
+        DisplayTransactionDetails(m_transaction_id, m_transaction_type, m_timestamp, m_transaction_amount,
+                                  m_balance_before_transaction, m_balance_after_transaction);
+    }
 
+    /**
+     * @brief Returns a string representation of the TransactionType.
+     * @return "Deposit", "Withdraw", or "Transfer".
+     */
+    std::string_view Transaction::GetTransactionType() const
+    {
+        return TransactionTypeToString(m_transaction_type);
+    }
+
+    /**
+     * @brief Captures an immutable copy of a live Transaction.
+     * @param transaction The transaction to copy.
+     * @return The copy, which no longer refers to the account.
+     */
+    TransactionImage CaptureTransaction(const Transaction &transaction)
+    {
+        return {transaction.GetTransactionID(), transaction.GetSequence(), transaction.GetType(),
+                transaction.GetTransactionAmount(), transaction.GetBalanceBeforeTransaction(),
+                transaction.GetBalanceAfterTransaction(), transaction.WasInvalid(), transaction.GetTimestamp()};
+    }
+
+    /**
+     * @brief Outputs the details of a transaction, whether live or captured in a snapshot.
+     * @param transaction_id The transaction's ID.
+     * @param transaction_type The transaction's type.
+     * @param timestamp The simulated time at which it executed.
+     * @param amount The transaction amount.
+     * @param balance_before The account balance before the transaction.
+     * @param balance_after The account balance after the transaction.
+     */
+    void DisplayTransactionDetails(i32 transaction_id, TransactionType transaction_type, i64 timestamp,
+                                   f64 amount, f64 balance_before, f64 balance_after)
+    {
         // Show transaction info to the console
-        std::cout << "Transaction ID: " << m_transaction_id << std::endl;
-        std::cout << "Transaction Type: " << transaction_type << std::endl;
-        std::cout << "Transaction Amount: $" << m_transaction_amount << std::endl;
-        std::cout << "Balance before transaction: $" << m_balance_before_transaction << std::endl;
-        std::cout << "Balance after transaction: $" << m_balance_after_transaction << std::endl;
+        std::cout << "Transaction ID: " << transaction_id << std::endl;
+        std::cout << "Transaction Type: " << TransactionTypeToString(transaction_type) << std::endl;
+        std::cout << "Date: " << SimClock::FormatDate(timestamp) << std::endl;
+        std::cout << "Transaction Amount: $" << amount << std::endl;
+        std::cout << "Balance before transaction: $" << balance_before << std::endl;
+        std::cout << "Balance after transaction: $" << balance_after << std::endl;
     }
 
     /**
-     * @brief Returns a string representation of the TransactionType.
+     * @brief Returns a string representation of a TransactionType.
+     * @param type The transaction type to convert.
      * @return "Deposit", "Withdraw", or "Transfer".
      */
-    std::string Transaction::GetTransactionType() const
+    std::string_view TransactionTypeToString(TransactionType type)
     {
-        // Convert the enum to a user-readable string
-        std::string transaction_type;
-        switch (m_transaction_type)
+        // Convert the enum to a user-readable string (a literal, so nothing is allocated)
+        switch (type)
         {
         case TransactionType::DEPOSIT:
-            transaction_type = "Deposit";
-            break;
+            return "Deposit";
         case TransactionType::WITHDRAW:
-            transaction_type = "Withdraw";
-            break;
+            return "Withdraw";
         default:
-            transaction_type = "Transfer";
-            break;
+            return "Transfer";
         }
-        return transaction_type;
     }
 }
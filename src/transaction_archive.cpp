@@ -0,0 +1,191 @@
+/**
+ * @file transaction_archive.cpp
+ * @brief This file implements the cold tier of transaction history: per-bank archive files that old
+ *        transactions are moved to, and the on-demand reads that bring them back.
+ */
+
+#include "../include/transaction_archive.hpp"
+#include <algorithm>
+#include <iostream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace Bank
+{
+    /**
+     * @brief Extends the checkpoint with transactions that follow the ones it already covers.
+     * @param transactions The transactions, in chronological order.
+     * @param count How many there are.
+     * @param opening_balance The account's opening balance, where the chain starts if nothing is covered yet.
+     */
+    void ArchivedHistory::Summarise(const TransactionImage *transactions, size_t count, f64 opening_balance)
+    {
+        f64 previous_after = transaction_count > 0 ? balance_after : opening_balance;
+        for (size_t i = 0; i < count; i++)
+        {
+            const TransactionImage &t = transactions[i];
+            if (t.balance_before < previous_after)
+                balance_drops += previous_after - t.balance_before;
+            if (!t.was_invalid && t.transaction_type == TransactionType::TRANSFER)
+                transferred_out += t.amount;
+            net_change += t.balance_after - t.balance_before;
+            previous_after = t.balance_after;
+        }
+        transaction_count += count;
+        balance_after = previous_after;
+    }
+
+    /**
+     * @brief Reads every archived transaction, oldest first.
+     * @param out The vector to append the transactions to.
+     */
+    void ArchivedHistory::Load(std::vector<TransactionImage> &out) const
+    {
+        out.reserve(out.size() + transaction_count);
+        for (const ArchiveExtent &extent : extents)
+            archive->Read(extent, out);
+    }
+
+    /**
+     * @brief Looks up one archived transaction by ID, reading one extent at a time.
+     * @param transaction_id The ID of the transaction to find.
+     * @param out Receives the transaction if found.
+     * @return True if the transaction is in the archive.
+     */
+    bool ArchivedHistory::Find(i32 transaction_id, TransactionImage &out) const
+    {
+        std::vector<TransactionImage> transactions;
+        for (const ArchiveExtent &extent : extents)
+        {
+            transactions.clear();
+            if (!archive->Read(extent, transactions))
+                continue;
+
+            auto it = std::find_if(transactions.begin(), transactions.end(), [transaction_id](const TransactionImage &t)
+                                   { return t.transaction_id == transaction_id; });
+            if (it != transactions.end())
+            {
+                out = *it;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Creates (or empties) the archive file of a bank, named 'archive_<bank_id>.dat'.
+     * @param bank_id The ID of the bank the archive belongs to.
+     */
+    TransactionArchive::TransactionArchive(i32 bank_id)
+        : m_path("archive_" + std::to_string(bank_id) + ".dat"),
+          m_file(m_path, std::ios::binary | std::ios::trunc)
+    {
+        if (!m_file.is_open())
+            std::cerr << "Error: " << m_path << " could not be opened.\n";
+    }
+
+    /**
+     * @brief Opens an existing file of transactions for reading only; appending to it always fails.
+     * @param path The file, e.g. a checkpoint.
+     */
+    TransactionArchive::TransactionArchive(const std::string &path) : m_path(path)
+    {
+#ifdef _WIN32
+        m_reader.open(path, std::ios::binary);
+        const bool opened = m_reader.is_open();
+#else
+        m_reader = open(path.c_str(), O_RDONLY);
+        const bool opened = m_reader >= 0;
+#endif
+        if (!opened)
+            std::cerr << "Error: " << m_path << " could not be opened.\n";
+    }
+
+    /**
+     * @brief Closes the file of a read-only archive.
+     */
+    TransactionArchive::~TransactionArchive()
+    {
+#ifndef _WIN32
+        if (m_reader >= 0)
+            close(m_reader);
+#endif
+    }
+
+    /**
+     * @brief Appends a run of transactions to the end of the file.
+     * @param transactions The transactions to write, in chronological order.
+     * @param count How many there are.
+     * @param extent Receives where they were written.
+     * @return False if the file could not be written, in which case nothing should be released from memory.
+     */
+    bool TransactionArchive::Append(const TransactionImage *transactions, size_t count, ArchiveExtent &extent)
+    {
+        const std::streamsize bytes = static_cast<std::streamsize>(count * sizeof(TransactionImage));
+        m_file.write(reinterpret_cast<const char *>(transactions), bytes);
+        m_file.flush();
+        if (!m_file)
+        {
+            std::cerr << "Error: Could not write to " << m_path << ".\n";
+            m_file.clear();
+            m_file.seekp(static_cast<std::streamoff>(m_size)); // Later appends overwrite the partial write
+            return false;
+        }
+
+        extent = {m_size, static_cast<u32>(count)};
+        m_size += static_cast<u64>(bytes);
+        return true;
+    }
+
+    /**
+     * @brief Reads one extent back from the file.
+     * @param extent Where the transactions were written.
+     * @param out The vector to append them to.
+     * @return False if the file could not be read.
+     */
+    bool TransactionArchive::Read(const ArchiveExtent &extent, std::vector<TransactionImage> &out) const
+    {
+        const size_t first = out.size();
+        out.resize(first + extent.count);
+        auto read_stream = [&](std::ifstream &file)
+        {
+            file.seekg(static_cast<std::streamoff>(extent.offset));
+            file.read(reinterpret_cast<char *>(out.data() + first),
+                      static_cast<std::streamsize>(extent.count * sizeof(TransactionImage)));
+            const bool ok = static_cast<bool>(file);
+            file.clear();
+            return ok;
+        };
+
+        bool ok;
+#ifdef _WIN32
+        if (m_reader.is_open())
+        {
+            std::lock_guard<std::mutex> lock(m_reader_mutex);
+            ok = read_stream(m_reader);
+        }
+#else
+        if (m_reader >= 0)
+        {
+            const size_t bytes = extent.count * sizeof(TransactionImage);
+            ok = pread(m_reader, out.data() + first, bytes, static_cast<off_t>(extent.offset)) == static_cast<ssize_t>(bytes);
+        }
+#endif
+        else
+        {
+            std::ifstream file(m_path, std::ios::binary);
+            ok = read_stream(file);
+        }
+
+        if (!ok)
+        {
+            std::cerr << "Error: Could not read archived transactions from " << m_path << ".\n";
+            out.resize(first);
+            return false;
+        }
+        return true;
+    }
+}
@@ -0,0 +1,249 @@
+/**
+ * @file transaction_block.cpp
+ * @brief This file implements the compressed encoding of sealed transaction history: delta and varint
+ *        coded fields, with balances predicted from the previous balance and the amount.
+ */
+
+#include "../include/transaction_block.hpp"
+#include "../include/global.hpp"
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+namespace Bank
+{
+    namespace
+    {
+        // How a monetary value is stored
+        enum ValueEncoding : u8
+        {
+            PREDICTED = 0, // Not stored: equal to the predicted value
+            CENTS = 1,     // Zigzag varint of a whole number of cents
+            RAW = 2        // The 8 bytes of the double
+        };
+
+        // Each record starts with a flags byte: bits 0-1 type, bit 2 invalid, bit 3 raw amount (else cents),
+        // bits 4-5 and 6-7 the encodings of the balances before and after
+        constexpr u8 TYPE_MASK = 0x03;
+        constexpr u8 INVALID_BIT = 0x04;
+        constexpr u8 RAW_AMOUNT_BIT = 0x08;
+        constexpr u8 BEFORE_SHIFT = 4;
+        constexpr u8 AFTER_SHIFT = 6;
+        constexpr u8 ENCODING_MASK = 0x03;
+
+        inline void PutVarint(std::vector<u8> &out, u64 value)
+        {
+            while (value >= 0x80)
+            {
+                out.push_back(static_cast<u8>(value) | 0x80);
+                value >>= 7;
+            }
+            out.push_back(static_cast<u8>(value));
+        }
+
+        inline u64 GetVarint(const u8 *&p)
+        {
+            u64 value = 0;
+            u32 shift = 0;
+            while (*p & 0x80)
+            {
+                value |= static_cast<u64>(*p++ & 0x7F) << shift;
+                shift += 7;
+            }
+            return value | static_cast<u64>(*p++) << shift;
+        }
+
+        inline u64 ZigZag(i64 value) { return (static_cast<u64>(value) << 1) ^ static_cast<u64>(value >> 63); }
+        inline i64 UnZigZag(u64 value) { return static_cast<i64>(value >> 1) ^ -static_cast<i64>(value & 1); }
+
+        /**
+         * @brief Returns true if two doubles are the same bit pattern (so -0.0 and 0.0 differ).
+         */
+        inline bool SameValue(f64 a, f64 b)
+        {
+            return std::bit_cast<u64>(a) == std::bit_cast<u64>(b);
+        }
+
+        /**
+         * @brief Returns the balance a transaction would leave, using the same arithmetic as the accounts.
+         */
+        inline f64 PredictBalanceAfter(TransactionType type, bool was_invalid, f64 amount, f64 before)
+        {
+            if (was_invalid)
+                return before;
+            if (type == TransactionType::DEPOSIT)
+                return before + amount;
+
+            // Only a checking account can go negative, and then it is charged the overdraft fee
+            const f64 after = before - amount;
+            return after < 0 ? after - OVERDRAFT_FEE : after;
+        }
+
+        /**
+         * @brief Appends a value in the smallest encoding that reproduces it exactly.
+         * @param can_predict False if the value has no prediction to fall back on.
+         * @return The encoding used.
+         */
+        u8 PutValue(std::vector<u8> &out, f64 value, f64 predicted, bool can_predict)
+        {
+            if (can_predict && SameValue(value, predicted))
+                return PREDICTED;
+
+            const f64 scaled = value * 100.0;
+            if (std::fabs(scaled) < 1e15)
+            {
+                const i64 cents = std::llround(scaled);
+                if (SameValue(static_cast<f64>(cents) / 100.0, value))
+                {
+                    PutVarint(out, ZigZag(cents));
+                    return CENTS;
+                }
+            }
+
+            u8 raw[sizeof(f64)];
+            std::memcpy(raw, &value, sizeof(f64));
+            out.insert(out.end(), raw, raw + sizeof(f64));
+            return RAW;
+        }
+
+        inline f64 GetValue(const u8 *&p, u8 encoding, f64 predicted)
+        {
+            switch (encoding)
+            {
+            case CENTS:
+                return static_cast<f64>(UnZigZag(GetVarint(p))) / 100.0;
+            case RAW:
+            {
+                f64 value;
+                std::memcpy(&value, p, sizeof(f64));
+                p += sizeof(f64);
+                return value;
+            }
+            default:
+                return predicted;
+            }
+        }
+
+        /**
+         * @brief Decodes the records of a block one at a time, stopping early if visit returns false.
+         */
+        template <typename Visit>
+        void DecodeRecords(const u8 *p, size_t count, Visit &&visit)
+        {
+            TransactionImage t{};
+            for (size_t i = 0; i < count; i++)
+            {
+                const u8 flags = *p++;
+                t.transaction_type = static_cast<TransactionType>(flags & TYPE_MASK);
+                t.was_invalid = (flags & INVALID_BIT) != 0;
+                t.transaction_id = static_cast<i32>(GetVarint(p));
+                t.sequence += GetVarint(p);
+                t.timestamp += UnZigZag(GetVarint(p));
+                t.amount = GetValue(p, (flags & RAW_AMOUNT_BIT) ? RAW : CENTS, 0.0);
+                t.balance_before = GetValue(p, (flags >> BEFORE_SHIFT) & ENCODING_MASK, t.balance_after);
+                t.balance_after = GetValue(p, (flags >> AFTER_SHIFT) & ENCODING_MASK,
+                                           PredictBalanceAfter(t.transaction_type, t.was_invalid, t.amount, t.balance_before));
+                if (!visit(t))
+                    return;
+            }
+        }
+    }
+
+    /**
+     * @brief Seals a run of transactions into a block.
+     * @param transactions The transactions, in chronological (sequence) order.
+     * @param count How many there are.
+     */
+    TransactionBlock::TransactionBlock(const TransactionImage *transactions, size_t count)
+        : m_count(static_cast<u32>(count))
+    {
+        assert(count <= MAX_RECORDS);
+        std::vector<u8> bytes;
+        bytes.reserve(count * 12);
+
+        TransactionImage previous{};
+        for (size_t i = 0; i < count; i++)
+        {
+            const TransactionImage &t = transactions[i];
+            const size_t flags_at = bytes.size();
+            bytes.push_back(0);
+
+            PutVarint(bytes, static_cast<u32>(t.transaction_id));
+            PutVarint(bytes, t.sequence - previous.sequence);
+            PutVarint(bytes, ZigZag(t.timestamp - previous.timestamp));
+            const u8 amount = PutValue(bytes, t.amount, 0.0, false);
+            const u8 before = PutValue(bytes, t.balance_before, previous.balance_after, true);
+            const u8 after = PutValue(bytes, t.balance_after,
+                                      PredictBalanceAfter(t.transaction_type, t.was_invalid, t.amount, t.balance_before), true);
+
+            bytes[flags_at] = static_cast<u8>(static_cast<u8>(t.transaction_type) | (t.was_invalid ? INVALID_BIT : 0) |
+                                              (amount == RAW ? RAW_AMOUNT_BIT : 0) | before << BEFORE_SHIFT | after << AFTER_SHIFT);
+            previous = t;
+
+            const u64 bit = u64{1} << i;
+            m_type_bits[static_cast<size_t>(t.transaction_type)] |= bit;
+            if (t.was_invalid)
+                m_invalid_bits |= bit;
+            m_min_amount = i == 0 ? t.amount : std::min(m_min_amount, t.amount);
+            m_max_amount = i == 0 ? t.amount : std::max(m_max_amount, t.amount);
+        }
+
+        m_size = static_cast<u32>(bytes.size());
+        m_bytes = std::make_unique<u8[]>(bytes.size());
+        std::memcpy(m_bytes.get(), bytes.data(), bytes.size());
+    }
+
+    /**
+     * @brief Decodes every record in the block.
+     * @param out The vector to append them to, in chronological order.
+     */
+    void TransactionBlock::Decode(std::vector<TransactionImage> &out) const
+    {
+        out.reserve(out.size() + m_count);
+        DecodeRecords(m_bytes.get(), m_count, [&out](const TransactionImage &t)
+                      { out.push_back(t);
+                        return true; });
+    }
+
+    /**
+     * @brief Decodes the records whose bits are set in a selection, stopping after the last of them.
+     * @param selection Bit i selects record i, as in the block's index.
+     * @param out The vector to append them to, in chronological order.
+     */
+    void TransactionBlock::DecodeSelected(u64 selection, std::vector<TransactionImage> &out) const
+    {
+        selection &= GetAllBits();
+        if (selection == 0)
+            return;
+
+        // Records are deltas of the one before, so everything up to the last selected one is decoded
+        const size_t last = std::bit_width(selection) - 1;
+        size_t i = 0;
+        DecodeRecords(m_bytes.get(), last + 1, [&](const TransactionImage &t)
+                      {
+            if (selection & (u64{1} << i++))
+                out.push_back(t);
+            return true; });
+    }
+
+    /**
+     * @brief Looks up one record by transaction ID, decoding only as far as needed.
+     * @param transaction_id The ID of the transaction to find.
+     * @param out Receives the transaction if found.
+     * @return True if the transaction is in this block.
+     */
+    bool TransactionBlock::Find(i32 transaction_id, TransactionImage &out) const
+    {
+        bool found = false;
+        DecodeRecords(m_bytes.get(), m_count, [&](const TransactionImage &t)
+                      {
+            if (t.transaction_id != transaction_id)
+                return true;
+            out = t;
+            found = true;
+            return false; });
+        return found;
+    }
+}
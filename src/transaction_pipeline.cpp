@@ -0,0 +1,321 @@
+/**
+ * @file transaction_pipeline.cpp
+ * @brief This file implements the coroutine-based transaction pipeline used for transaction feeds: each
+ *        request is a coroutine that suspends between its stages, so a few threads carry many requests.
+ */
+
+#include "../include/transaction_pipeline.hpp"
+#include "../include/bank_account.hpp"
+#include "../include/customer.hpp"
+#include "../include/global.hpp"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <iostream>
+#include <string_view>
+
+namespace Bank
+{
+    namespace
+    {
+        using Clock = std::chrono::steady_clock;
+
+        /**
+         * @brief Parses a whole field as a number, without allocating or consulting the locale.
+         * @return False unless the entire field is a valid number.
+         */
+        template <typename T>
+        bool ParseNumber(std::string_view text, T &value)
+        {
+            const char *end = text.data() + text.size();
+            auto [ptr, ec] = std::from_chars(text.data(), end, value);
+            return ec == std::errc() && ptr == end;
+        }
+
+        /**
+         * @brief Splits a feed line: 'key,bank_id,customer_id,account_id,type,amount[,destination_account_id]'.
+         * @return False if a field is missing or not a number where one is expected.
+         */
+        bool ParseFeedLine(FeedRequest &request)
+        {
+            std::vector<std::string_view> fields;
+            std::string_view rest(request.line);
+            while (true)
+            {
+                const size_t comma = rest.find(',');
+                fields.push_back(rest.substr(0, comma));
+                if (comma == std::string_view::npos)
+                    break;
+                rest.remove_prefix(comma + 1);
+            }
+
+            i32 transaction_type = -1;
+            if (fields.size() < 6 || !ParseNumber(fields[1], request.bank_id) ||
+                !ParseNumber(fields[2], request.customer_id) || !ParseNumber(fields[4], transaction_type) ||
+                !ParseNumber(fields[5], request.amount))
+                return false;
+
+            request.key = fields[0];
+            request.account_id = AccountID::Parse(fields[3]);
+            if (fields.size() >= 7)
+                request.destination_account_id = AccountID::Parse(fields[6]);
+            if (transaction_type < MIN_TRANSACTION_TYPE || transaction_type > MAX_TRANSACTION_TYPE)
+                return false;
+            request.transaction_type = static_cast<TransactionType>(transaction_type);
+            return true;
+        }
+
+        std::string_view FeedOutcomeToString(FeedOutcome outcome)
+        {
+            switch (outcome)
+            {
+            case FeedOutcome::APPLIED:
+                return "APPLIED";
+            case FeedOutcome::DUPLICATE:
+                return "DUPLICATE";
+            default:
+                return "REJECTED";
+            }
+        }
+    }
+
+    /**
+     * @brief Parks the coroutine unless it is already its turn.
+     * @return False to carry on immediately, true if the coroutine was parked.
+     */
+    bool Sequencer::Turn::await_suspend(std::coroutine_handle<> handle)
+    {
+        std::lock_guard<std::mutex> lock(sequencer.m_mutex);
+        if (ticket == sequencer.m_next)
+            return false;
+        sequencer.m_waiting[ticket % sequencer.m_waiting.size()] = handle;
+        return true;
+    }
+
+    /**
+     * @brief Passes the turn to the next ticket, resuming it on the pool if it is already waiting.
+     */
+    void Sequencer::EndTurn()
+    {
+        std::coroutine_handle<> next;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_next++;
+            std::swap(next, m_waiting[m_next % m_waiting.size()]);
+        }
+        if (next)
+            m_pool.Post([next]()
+                        { next.resume(); });
+    }
+
+    /**
+     * @brief Prepares a pipeline for one feed.
+     * @param banks The banks the feed's transactions apply to.
+     * @param journal_path The file each request's outcome is appended to.
+     */
+    TransactionPipeline::TransactionPipeline(std::vector<std::unique_ptr<Bank>> &banks, const std::string &journal_path)
+        : m_banks(banks), m_executor(Executor()), m_sequencer(m_executor, PIPELINE_MAX_IN_FLIGHT),
+          m_journal(journal_path, std::ios::app), m_start(Clock::now())
+    {
+        if (!m_journal.is_open())
+            std::cerr << "Error: " << journal_path << " could not be opened. Outcomes will not be journaled.\n";
+    }
+
+    /**
+     * @brief Returns the small pool every pipeline's coroutines run on.
+     * @return A reference to a ThreadPool of PIPELINE_THREADS threads.
+     */
+    ThreadPool &TransactionPipeline::Executor()
+    {
+        static ThreadPool executor(PIPELINE_THREADS);
+        return executor;
+    }
+
+    /**
+     * @brief Starts a request for one feed line, first waiting for an in-flight slot if all are taken.
+     * @param line_number The line's number in the feed, for reporting.
+     * @param line The line itself.
+     */
+    void TransactionPipeline::Submit(size_t line_number, std::string line)
+    {
+        auto request = std::make_unique<FeedRequest>();
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_slot_free.wait(lock, [this]()
+                             { return m_in_flight < PIPELINE_MAX_IN_FLIGHT; });
+            m_in_flight++;
+            m_report.peak_in_flight = std::max(m_report.peak_in_flight, m_in_flight);
+            request->ticket = m_submitted++;
+        }
+        request->line_number = line_number;
+        request->line = std::move(line);
+        Run(std::move(request));
+    }
+
+    /**
+     * @brief Waits for every submitted request to be acknowledged.
+     * @return The counts and per-stage timings of the feed.
+     */
+    PipelineReport TransactionPipeline::Finish()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_slot_free.wait(lock, [this]()
+                         { return m_in_flight == 0; });
+
+        std::sort(m_report.rejected_lines.begin(), m_report.rejected_lines.end());
+        for (size_t i = 0; i < PIPELINE_STAGES; i++)
+            m_report.stage_seconds[i] = m_stage_nanoseconds[i].load() / 1e9;
+        m_report.elapsed_seconds = std::chrono::duration<f64>(Clock::now() - m_start).count();
+        return m_report;
+    }
+
+    /**
+     * @brief Adds the time since start to a stage's total.
+     * @return The current time, which starts the next stage.
+     */
+    Clock::time_point TransactionPipeline::EndStage(PipelineStage stage, Clock::time_point start)
+    {
+        const Clock::time_point now = Clock::now();
+        m_stage_nanoseconds[static_cast<size_t>(stage)] +=
+            std::chrono::duration_cast<std::chrono::nanoseconds>(now - start).count();
+        return now;
+    }
+
+    /**
+     * @brief Carries one request through every stage.
+     *
+     * The coroutine suspends twice: to leave the submitting thread for the executor, and while it waits
+     * for its turn at the apply stage. The journal and acknowledgement run on whichever thread applied
+     * the request, while the next request is already being applied on another.
+     *
+     * @param request The request, owned by the coroutine until it finishes.
+     */
+    PipelineTask TransactionPipeline::Run(std::unique_ptr<FeedRequest> request)
+    {
+        co_await ResumeOn{m_executor};
+
+        Clock::time_point start = Clock::now();
+        bool valid = ParseFeedLine(*request);
+        start = EndStage(PipelineStage::PARSE, start);
+
+        valid = valid && Validate(*request);
+        start = EndStage(PipelineStage::VALIDATE, start);
+
+        // The bank graph is not thread-safe, so requests take turns at it, in feed order
+        co_await m_sequencer.WaitForTurn(request->ticket);
+        start = EndStage(PipelineStage::ROUTE, start);
+
+        if (valid)
+            Apply(*request);
+        m_sequencer.EndTurn();
+        start = EndStage(PipelineStage::APPLY, start);
+
+        Journal(*request);
+        EndStage(PipelineStage::JOURNAL, start);
+
+        Acknowledge(*request);
+    }
+
+    /**
+     * @brief Applies the same range checks as Add Transaction, which need nothing but the request itself.
+     * @return False if the request should be rejected.
+     */
+    bool TransactionPipeline::Validate(FeedRequest &request) const
+    {
+        const bool is_transfer = request.transaction_type == TransactionType::TRANSFER;
+        return !request.key.empty() && request.account_id.IsValid() &&
+               request.amount >= MIN_TRANSACTION_AMOUNT && request.amount <= MAX_TRANSACTION_AMOUNT &&
+               (!is_transfer || (request.destination_account_id.IsValid() &&
+                                 request.destination_account_id != request.account_id));
+    }
+
+    /**
+     * @brief Finds the request's account and submits the transaction to it. Only called in the request's turn.
+     */
+    void TransactionPipeline::Apply(FeedRequest &request)
+    {
+        auto bank = std::find_if(m_banks.begin(), m_banks.end(), [&request](const std::unique_ptr<Bank> &b)
+                                 { return b->GetID() == request.bank_id; });
+        BankAccount *account = bank != m_banks.end() ? (*bank)->FindAccount(request.account_id) : nullptr;
+        if (!account || account->GetAccountOwner().GetID() != request.customer_id)
+            return; // Stays REJECTED
+
+        const bool is_transfer = request.transaction_type == TransactionType::TRANSFER;
+        const Transaction *transaction = account->SubmitTransaction(request.key, request.transaction_type, request.amount,
+                                                                    is_transfer ? request.destination_account_id : AccountID());
+        if (transaction)
+        {
+            request.outcome = FeedOutcome::APPLIED;
+            request.transaction_id = transaction->GetTransactionID();
+            request.declined = transaction->WasInvalid();
+        }
+        else
+        {
+            request.outcome = FeedOutcome::DUPLICATE;
+        }
+    }
+
+    /**
+     * @brief Appends the request's outcome to the journal: 'line_number,key,outcome[,transaction_id[,DECLINED]]'.
+     */
+    void TransactionPipeline::Journal(const FeedRequest &request)
+    {
+        std::lock_guard<std::mutex> lock(m_journal_mutex);
+        if (!m_journal.is_open())
+            return;
+
+        m_journal << request.line_number << ',' << request.key << ',' << FeedOutcomeToString(request.outcome);
+        if (request.outcome == FeedOutcome::APPLIED)
+            m_journal << ',' << request.transaction_id << (request.declined ? ",DECLINED" : "");
+        m_journal << std::endl;
+    }
+
+    /**
+     * @brief Records the request's outcome and frees its in-flight slot. Nothing may touch the pipeline after this.
+     */
+    void TransactionPipeline::Acknowledge(const FeedRequest &request)
+    {
+        const Clock::time_point start = Clock::now();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        switch (request.outcome)
+        {
+        case FeedOutcome::APPLIED:
+            m_report.applied++;
+            break;
+        case FeedOutcome::DUPLICATE:
+            m_report.duplicates++;
+            break;
+        case FeedOutcome::REJECTED:
+            m_report.rejected++;
+            m_report.rejected_lines.push_back(request.line_number);
+            break;
+        }
+        EndStage(PipelineStage::ACKNOWLEDGE, start);
+
+        // Notify under the lock, so Finish cannot return (and the pipeline go away) before this is done
+        m_in_flight--;
+        m_slot_free.notify_all();
+    }
+
+    /**
+     * @brief Returns a string representation of a PipelineStage.
+     */
+    std::string PipelineStageToString(PipelineStage stage)
+    {
+        switch (stage)
+        {
+        case PipelineStage::PARSE:
+            return "Parse";
+        case PipelineStage::VALIDATE:
+            return "Validate";
+        case PipelineStage::ROUTE:
+            return "Route (waiting for turn)";
+        case PipelineStage::APPLY:
+            return "Apply";
+        case PipelineStage::JOURNAL:
+            return "Journal";
+        default:
+            return "Acknowledge";
+        }
+    }
+}
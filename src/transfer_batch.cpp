@@ -0,0 +1,291 @@
+/**
+ * @file transfer_batch.cpp
+ * @brief This file implements batched transfers: many legs between one customer's accounts, validated
+ *        together up front and then applied all-or-nothing.
+ */
+
+#include "../include/transfer_batch.hpp"
+#include "../include/activity_log.hpp"
+#include "../include/bank.hpp"
+#include "../include/bank_account.hpp"
+#include "../include/global.hpp"
+#include "../include/replication.hpp"
+#include "../include/sim_clock.hpp"
+#include <charconv>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <string_view>
+#include <unordered_map>
+
+namespace Bank
+{
+    namespace
+    {
+        /**
+         * @brief Returns a field without surrounding spaces, tabs or a trailing carriage return.
+         */
+        std::string_view Trim(std::string_view text)
+        {
+            const size_t first = text.find_first_not_of(" \t\r");
+            if (first == std::string_view::npos)
+                return {};
+            return text.substr(first, text.find_last_not_of(" \t\r") - first + 1);
+        }
+
+        /**
+         * @brief Parses one row: 'source_account_id,destination_account_id,amount'.
+         * @return False if a field is missing or malformed.
+         */
+        bool ParseTransferLeg(std::string_view line, TransferLeg &leg)
+        {
+            const size_t first = line.find(',');
+            const size_t second = first == std::string_view::npos ? first : line.find(',', first + 1);
+            if (second == std::string_view::npos || line.find(',', second + 1) != std::string_view::npos)
+                return false;
+
+            leg.source = AccountID::Parse(Trim(line.substr(0, first)));
+            leg.destination = AccountID::Parse(Trim(line.substr(first + 1, second - first - 1)));
+            const std::string_view amount = Trim(line.substr(second + 1));
+            auto [ptr, ec] = std::from_chars(amount.data(), amount.data() + amount.size(), leg.amount);
+            return ec == std::errc() && ptr == amount.data() + amount.size() && leg.source.IsValid() &&
+                   leg.destination.IsValid();
+        }
+
+        std::string Money(f64 amount)
+        {
+            std::ostringstream oss;
+            oss << std::fixed << std::setprecision(2) << '$' << amount;
+            return oss.str();
+        }
+
+        /**
+         * @brief What validation tracks for one account the batch touches: where its balance and withdrawal
+         *        limits would stand after the legs so far.
+         */
+        struct PendingAccount
+        {
+            BankAccount *account = nullptr;
+            f64 balance = 0.0;
+            std::optional<VelocityTracker> velocity; // A copy, so checking the batch leaves the real one untouched
+        };
+    }
+
+    /**
+     * @brief Transfers money between a customer's accounts as one all-or-nothing operation.
+     *
+     * Every account is resolved once, before anything moves. The legs are then replayed in order against
+     * copies of the balances and withdrawal limits, with the same checks a single Transfer makes, so a
+     * batch that passes cannot fail half way. Only then are the legs applied, each as a TRANSFER on its
+     * source account; should one fail anyway, the legs before it are undone with reverse transfers and the
+     * failing leg is reported. Per-transaction console messages are discarded, and the replication log is
+     * flushed once for the whole batch rather than once per leg.
+     *
+     * @param customer The customer whose accounts the legs move money between.
+     * @param legs The legs, applied in order; a later leg may spend money an earlier one received.
+     * @return The counts and timings of the batch, and the first failing leg if it was not committed.
+     */
+    TransferBatchReport ApplyTransferBatch(Customer &customer, const std::vector<TransferLeg> &legs)
+    {
+        TransferBatchReport report;
+        report.legs = legs.size();
+        auto start = std::chrono::steady_clock::now();
+
+        auto fail = [&report, &start](size_t leg, std::string reason)
+        {
+            report.failed_leg = leg;
+            report.reason = std::move(reason);
+            report.validate_seconds = std::chrono::duration<f64>(std::chrono::steady_clock::now() - start).count();
+            return report;
+        };
+
+        if (legs.empty())
+            return fail(0, "The batch has no legs.");
+        if (legs.size() > MAX_TRANSFER_BATCH_LEGS)
+            return fail(0, "The batch has more than " + std::to_string(MAX_TRANSFER_BATCH_LEGS) + " legs.");
+
+        std::unordered_map<AccountID, PendingAccount> pending;
+        auto resolve = [&customer, &pending](AccountID account_id) -> PendingAccount *
+        {
+            auto [it, inserted] = pending.try_emplace(account_id);
+            if (inserted)
+            {
+                BankAccount *account = customer.GetBank().FindAccount(account_id);
+                if (account && &account->GetAccountOwner() == &customer)
+                {
+                    it->second.account = account;
+                    it->second.balance = account->GetBalance();
+                    if (const VelocityTracker *velocity = account->GetVelocityTracker())
+                        it->second.velocity = *velocity;
+                }
+            }
+            return it->second.account ? &it->second : nullptr;
+        };
+
+        std::optional<VelocityTracker> customer_velocity;
+        if (const VelocityTracker *velocity = customer.GetVelocityTracker())
+            customer_velocity = *velocity;
+
+        const i64 now = SimClock::Shared().Now();
+        std::string reason;
+        for (size_t i = 0; i < legs.size(); i++)
+        {
+            const TransferLeg &leg = legs[i];
+            if (leg.amount < MIN_TRANSACTION_AMOUNT || leg.amount > MAX_TRANSACTION_AMOUNT)
+                return fail(i + 1, "Amount " + Money(leg.amount) + " is outside " + Money(MIN_TRANSACTION_AMOUNT) +
+                                       " to " + Money(MAX_TRANSACTION_AMOUNT) + ".");
+            if (leg.source == leg.destination)
+                return fail(i + 1, "Source and destination are the same account.");
+
+            PendingAccount *source = resolve(leg.source);
+            PendingAccount *destination = resolve(leg.destination);
+            if (!source)
+                return fail(i + 1, "Account " + leg.source.ToString() + " does not belong to " + std::string(customer.GetName()) + ".");
+            if (!destination)
+                return fail(i + 1, "Account " + leg.destination.ToString() + " does not belong to " + std::string(customer.GetName()) + ".");
+
+            if ((source->velocity && !source->velocity->Allows(leg.amount, now, reason)) ||
+                (customer_velocity && !customer_velocity->Allows(leg.amount, now, reason)))
+                return fail(i + 1, "Velocity limit exceeded (" + reason + ").");
+            if (leg.amount > source->balance)
+                return fail(i + 1, "Insufficient funds: " + leg.source.ToString() + " would have " +
+                                       Money(source->balance) + " left to transfer " + Money(leg.amount) + ".");
+
+            // The same arithmetic, in the same order, as Transfer itself
+            source->balance -= leg.amount;
+            destination->balance += leg.amount;
+            if (source->velocity)
+                source->velocity->Record(leg.amount, now);
+            if (customer_velocity)
+                customer_velocity->Record(leg.amount, now);
+            report.total += leg.amount;
+        }
+        report.accounts = pending.size();
+
+        auto applied = std::chrono::steady_clock::now();
+        report.validate_seconds = std::chrono::duration<f64>(applied - start).count();
+
+        ReplicationLog &log = ReplicationLog::Shared();
+        log.BeginBatch();
+        {
+            QuietScope quiet;
+            for (size_t i = 0; i < legs.size(); i++)
+            {
+                const TransferLeg &leg = legs[i];
+                const Transaction &transaction =
+                    pending[leg.source].account->CreateTransaction(TransactionType::TRANSFER, leg.amount, leg.destination);
+                if (!transaction.WasInvalid())
+                    continue;
+
+                // Validation should have made this impossible, so put back what moved rather than leave half a batch
+                size_t reversed = 0;
+                for (size_t j = i; j-- > 0;)
+                {
+                    const TransferLeg &applied_leg = legs[j];
+                    const Transaction &reversal = pending[applied_leg.destination].account->CreateTransaction(
+                        TransactionType::TRANSFER, applied_leg.amount, applied_leg.source);
+                    if (!reversal.WasInvalid())
+                        reversed++;
+                }
+                log.EndBatch();
+
+                std::cerr << "Error: Leg " << i + 1 << " of the transfer batch failed after validation; " << reversed
+                          << " of the " << i << " leg(s) already applied were reversed.\n";
+                report.failed_leg = i + 1;
+                report.reason = "The leg failed when applied.";
+                report.unreversed = i - reversed;
+                report.apply_seconds = std::chrono::duration<f64>(std::chrono::steady_clock::now() - applied).count();
+                return report;
+            }
+        }
+        log.EndBatch();
+
+        report.committed = true;
+        report.apply_seconds = std::chrono::duration<f64>(std::chrono::steady_clock::now() - applied).count();
+        return report;
+    }
+
+    /**
+     * @brief Reads a file of transfer legs and applies them as one batch.
+     *
+     * Each row is 'source_account_id,destination_account_id,amount'. Blank lines and lines starting with
+     * '#' are ignored. A malformed row rejects the whole batch, as does any leg that fails validation;
+     * either way the failing row is reported by line number.
+     *
+     * @param customer The customer whose accounts the legs move money between.
+     * @param path The file to read.
+     * @return The outcome of the batch.
+     */
+    TransferBatchReport ImportTransferBatch(Customer &customer, const std::string &path)
+    {
+        TransferBatchReport report;
+        std::ifstream file(path);
+        if (!file.is_open())
+        {
+            std::cerr << "Error: " << path << " could not be opened.\n";
+            report.reason = path + " could not be opened.";
+            return report;
+        }
+
+        std::vector<TransferLeg> legs;
+        std::vector<size_t> line_numbers;
+        size_t line_number = 0;
+        std::string line;
+        while (std::getline(file, line))
+        {
+            line_number++;
+            const std::string_view row = Trim(line);
+            if (row.empty() || row[0] == '#')
+                continue;
+
+            TransferLeg &leg = legs.emplace_back();
+            if (!ParseTransferLeg(row, leg))
+            {
+                report.legs = legs.size();
+                report.failed_leg = line_number;
+                report.reason = "The line is not a valid transfer leg.";
+                return report;
+            }
+            line_numbers.push_back(line_number);
+        }
+
+        report = ApplyTransferBatch(customer, legs);
+        if (report.failed_leg != 0)
+            report.failed_leg = line_numbers[report.failed_leg - 1];
+        return report;
+    }
+
+    /**
+     * @brief Prints the outcome of a transfer batch.
+     * @param report The report to print.
+     * @param os The stream to print to.
+     */
+    void PrintTransferBatchReport(const TransferBatchReport &report, std::ostream &os)
+    {
+        os << "Legs: " << report.legs << "\n";
+        if (!report.committed)
+        {
+            os << "Batch rejected";
+            if (report.failed_leg != 0)
+                os << " at line " << report.failed_leg;
+            os << ": " << report.reason;
+            if (report.unreversed == 0)
+                os << " Nothing was transferred.\n";
+            else
+                os << " " << report.unreversed << " leg(s) before it stayed applied and could not be undone.\n";
+            return;
+        }
+
+        const std::ios::fmtflags flags = os.flags();
+        const std::streamsize precision = os.precision();
+        os << "Accounts involved: " << report.accounts << "\n";
+        os << "Total transferred: " << Money(report.total) << "\n";
+        os << std::fixed << std::setprecision(3) << "Validated in " << report.validate_seconds << "s, applied in "
+           << report.apply_seconds << "s\n";
+        os.flags(flags);
+        os.precision(precision);
+    }
+}
@@ -6,6 +6,21 @@
 
 #include "../include/utilities.hpp"
 #include "../include/global.hpp"
+#include "../include/audit.hpp"
+#include "../include/end_of_day.hpp"
+#include "../include/scheduler.hpp"
+#include "../include/snapshot.hpp"
+#include "../include/sim_clock.hpp"
+#include "../include/replication.hpp"
+#include "../include/idempotency.hpp"
+#include "../include/bulk_loader.hpp"
+#include "../include/memory_report.hpp"
+#include "../include/transaction_pipeline.hpp"
+#include "../include/transfer_batch.hpp"
+#include "../include/query.hpp"
+#include "../include/thread_pool.hpp"
+#include "../include/checkpoint.hpp"
+#include "../include/trace.hpp"
 #include <limits>
 #include <sstream>
 #include <algorithm>
@@ -59,11 +74,7 @@ Bank::Bank *FindBank(const std::vector<std::unique_ptr<Bank::Bank>> &banks, i32
  */
 Bank::Customer *FindCustomer(const Bank::Bank *const bank, i32 customer_id)
 {
-    // Similar approach: find_if on the bank's customers
-    auto it = std::find_if(bank->GetCustomers().begin(), bank->GetCustomers().end(),
-                           [customer_id](const std::unique_ptr<Bank::Customer> &c)
-                           { return c->GetID() == customer_id; });
-    return (it != bank->GetCustomers().end()) ? it->get() : nullptr;
+    return bank->FindCustomer(customer_id);
 }
 
 /**
@@ -72,13 +83,22 @@ Bank::Customer *FindCustomer(const Bank::Bank *const bank, i32 customer_id)
  * @param account_id The ID of the BankAccount to find.
  * @return A pointer to the BankAccount if found, otherwise nullptr.
  */
-Bank::BankAccount *FindAccount(const Bank::Customer *const customer, const std::string &account_id)
+Bank::BankAccount *FindAccount(const Bank::Customer *const customer, Bank::AccountID account_id)
 {
-    // If the account ID matches, return that BankAccount
-    auto it = std::find_if(customer->GetAccounts().begin(), customer->GetAccounts().end(),
-                           [account_id](const std::unique_ptr<Bank::BankAccount> &a)
-                           { return a->GetID() == account_id; });
-    return (it != customer->GetAccounts().end()) ? it->get() : nullptr;
+    // Accounts are indexed per bank, so check that this customer is the owner
+    Bank::BankAccount *account = customer->GetBank().FindAccount(account_id);
+    return (account && &account->GetAccountOwner() == customer) ? account : nullptr;
+}
+
+/**
+ * @brief Searches for and returns a pointer to a BankAccount object by the text form of its ID (e.g. "123456C").
+ * @param customer Pointer to the Customer that contains the accounts.
+ * @param account_id The ID of the BankAccount to find, as entered by a user or read from a file.
+ * @return A pointer to the BankAccount if found, otherwise nullptr (including when the text is not an account ID).
+ */
+Bank::BankAccount *FindAccount(const Bank::Customer *const customer, std::string_view account_id)
+{
+    return FindAccount(customer, Bank::AccountID::Parse(account_id));
 }
 
 /**
@@ -178,6 +198,7 @@ void DisplayMenu(i32 &choice, bool &is_running, std::vector<std::unique_ptr<Bank
 {
     // Then your actual menu title and items
     std::cout << "========= BANK MANAGEMENT MENU =========\n";
+    std::cout << "Date: " << Bank::SimClock::FormatDate(Bank::SimClock::Shared().Now()) << "\n";
     std::cout << "1.  Add Bank\n";
     std::cout << "2.  Add Customer\n";
     std::cout << "3.  Add Account\n";
@@ -192,7 +213,22 @@ void DisplayMenu(i32 &choice, bool &is_running, std::vector<std::unique_ptr<Bank
     std::cout << "12. Search For Transaction\n";
     std::cout << "13. Apply Interest\n";
     std::cout << "14. Write To File\n";
-    std::cout << "15. Exit\n";
+    std::cout << "15. Audit Ledger\n";
+    std::cout << "16. Schedule Standing Order\n";
+    std::cout << "17. View Standing Orders\n";
+    std::cout << "18. Advance Clock\n";
+    std::cout << "19. Run End Of Day\n";
+    std::cout << "20. Submit Transaction Feed\n";
+    std::cout << "21. Set Velocity Limits\n";
+    std::cout << "22. Bulk Load Customers\n";
+    std::cout << "23. Memory Report\n";
+    std::cout << "24. Archive Old Transactions\n";
+    std::cout << "25. Batch Transfer\n";
+    std::cout << "26. Query Transactions\n";
+    std::cout << "27. Balance Rankings\n";
+    std::cout << "28. Save Checkpoint\n";
+    std::cout << "29. Cancel Standing Order\n";
+    std::cout << "30. Exit\n";
     std::cout << "========================================\n";
 
     // Obtain user choice and proceed
@@ -208,6 +244,8 @@ void DisplayMenu(i32 &choice, bool &is_running, std::vector<std::unique_ptr<Bank
  */
 void HandleUserChoice(i32 &choice, bool &is_running, std::vector<std::unique_ptr<Bank::Bank>> &banks)
 {
+    Bank::TraceSpan span("HandleUserChoice");
+
     // Switch statement to handle each menu option
     switch (choice)
     {
@@ -254,7 +292,55 @@ void HandleUserChoice(i32 &choice, bool &is_running, std::vector<std::unique_ptr
         WriteToFile(banks);
         break;
     case 15:
-        // User wants to exit the program
+        AuditAllAccounts(banks);
+        break;
+    case 16:
+        ScheduleStandingOrder(banks);
+        break;
+    case 17:
+        ViewStandingOrders();
+        break;
+    case 18:
+        AdvanceClock();
+        break;
+    case 19:
+        RunEndOfDay(banks);
+        break;
+    case 20:
+        SubmitTransactionFeed(banks);
+        break;
+    case 21:
+        ConfigureVelocityLimits(banks);
+        break;
+    case 22:
+        BulkLoadCustomers(banks);
+        break;
+    case 23:
+        ReportMemoryUsage(banks);
+        break;
+    case 24:
+        ArchiveOldTransactions(banks);
+        break;
+    case 25:
+        BatchTransfer(banks);
+        break;
+    case 26:
+        QueryTransactions(banks);
+        break;
+    case 27:
+        RankBalances(banks);
+        break;
+    case 28:
+        SaveBankCheckpoint(banks);
+        break;
+    case 29:
+        CancelStandingOrder();
+        break;
+    case 30:
+        // User wants to exit the program, once any checkpoint being saved is on disk
+        if (Bank::CheckpointWriter::Shared().IsRunning())
+            std::cout << "Waiting for the checkpoint to " << Bank::CheckpointWriter::Shared().GetPath() << " to be saved...\n";
+        CollectCheckpoint(true);
         is_running = false;
         return;
     default:
@@ -262,6 +348,11 @@ void HandleUserChoice(i32 &choice, bool &is_running, std::vector<std::unique_ptr
         return;
     }
 
+    // Every action has committed by now, so readers may see its effects
+    Bank::SnapshotManager::Shared().Publish(banks);
+    CollectCheckpoint(false);
+    span.End();
+
     // Wait for user input, then clear screen for next operation
     WaitForUser();
     ClearScreen();
@@ -290,7 +381,9 @@ void CreateBank(std::vector<std::unique_ptr<Bank::Bank>> &banks)
             return a->GetID() < b->GetID();
         });
 
-    banks.insert(it, std::move(new_bank));
+    const Bank::Bank &bank = **banks.insert(it, std::move(new_bank));
+    Bank::SnapshotManager::Shared().MarkBanksDirty();
+    Bank::ReplicationLog::Shared().LogBankCreated(bank);
 }
 
 /**
@@ -357,14 +450,17 @@ void ViewAllCustomer(const std::vector<std::unique_ptr<Bank::Bank>> &banks)
     if (!bank)
         return;
 
-    if (bank->GetNumberOfCustomers() == 0)
+    // Read from a snapshot so the listing is consistent even if writers are active
+    std::shared_ptr<const Bank::SystemImage> snapshot = Bank::SnapshotManager::Shared().Acquire();
+    const Bank::BankImage *bank_image = snapshot->FindBank(bank->GetID());
+    if (!bank_image || bank_image->customers.empty())
     {
         std::cerr << "Error: No customers available in this bank.\n";
         return;
     }
 
     std::cout << "\n========= All Customers =========\n";
-    bank->ViewAllCustomers();
+    bank_image->ViewAllCustomers();
 }
 
 /**
@@ -400,7 +496,7 @@ void SearchForBank(const std::vector<std::unique_ptr<Bank::Bank>> &banks)
 }
 
 /**
- * @brief Searches for a Customer by ID in a selected Bank using a sorted approach.
+ * @brief Searches for a Customer by ID in a selected Bank through the bank's ID index.
  * @param banks A reference to a vector of unique_ptr to Bank objects.
  */
 void SearchForCustomer(std::vector<std::unique_ptr<Bank::Bank>> &banks)
@@ -424,19 +520,13 @@ void SearchForCustomer(std::vector<std::unique_ptr<Bank::Bank>> &banks)
 
     i32 customer_id = Utility::GetValidInput("Enter customer ID: ", MIN_CUSTOMER_ID, MAX_CUSTOMER_ID);
 
-    auto it = std::lower_bound(bank->GetCustomers().begin(), bank->GetCustomers().end(), customer_id,
-                               [](const std::unique_ptr<Bank::Customer> &c, i32 customer_id)
-                               {
-                                   return c->GetID() < customer_id;
-                               });
-
-    if (it != bank->GetCustomers().end() && (*it)->GetID() == customer_id)
+    if (const Bank::Customer *customer = bank->FindCustomer(customer_id))
     {
         // Found the customer
         std::cout << "Customer found!\n";
-        std::cout << "Customer ID: " << (*it)->GetID() << "\n";
-        std::cout << "Name: " << (*it)->GetName() << "\n";
-        std::cout << "Age: " << (*it)->GetAge() << "\n";
+        std::cout << "Customer ID: " << customer->GetID() << "\n";
+        std::cout << "Name: " << customer->GetName() << "\n";
+        std::cout << "Age: " << customer->GetAge() << "\n";
     }
     else
     {
@@ -482,6 +572,7 @@ void AddAccount(std::vector<std::unique_ptr<Bank::Bank>> &banks)
 
 void AddTransaction(std::vector<std::unique_ptr<Bank::Bank>> &banks)
 {
+    Bank::TraceSpan span("AddTransaction");
     if (banks.empty())
     {
         std::cerr << "Error: No banks available. Create a bank first.\n";
@@ -540,8 +631,8 @@ void AddTransaction(std::vector<std::unique_ptr<Bank::Bank>> &banks)
             return;
         }
 
-        // Prompt user for the destination account ID
-        std::string dest_id = Utility::GetValidString("Enter the ID of the destination account: ");
+        // Prompt user for the destination account ID (a malformed ID simply matches no account)
+        Bank::AccountID dest_id = Bank::AccountID::Parse(Utility::GetValidString("Enter the ID of the destination account: "));
 
         // Check that the user isn't transferring to the same account
         if (dest_id == source_account->GetID())
@@ -641,11 +732,17 @@ void ViewAllTransactions(std::vector<std::unique_ptr<Bank::Bank>> &banks)
         return;
     }
 
-    const Bank::BankAccount *account = SelectAccount(customer);
+    Bank::BankAccount *account = SelectAccount(customer);
     if (!account)
         return;
-
-    if (account->GetNumberOfTransactions() == 0)
+    account->LoadHistory();
+
+    // Read from a snapshot so the history is consistent even if writers are active
+    std::shared_ptr<const Bank::SystemImage> snapshot = Bank::SnapshotManager::Shared().Acquire();
+    const Bank::BankImage *bank_image = snapshot->FindBank(bank->GetID());
+    const Bank::CustomerImage *customer_image = bank_image ? bank_image->FindCustomer(customer->GetID()) : nullptr;
+    const Bank::AccountImage *account_image = customer_image ? customer_image->FindAccount(account->GetID()) : nullptr;
+    if (!account_image || account_image->transaction_count == 0)
     {
         std::cerr << "Error: This account has no transactions.\n";
         return;
@@ -653,11 +750,11 @@ void ViewAllTransactions(std::vector<std::unique_ptr<Bank::Bank>> &banks)
 
     // Display the transaction history for the selected account
     std::cout << "\n========= Account Transactions =========\n";
-    account->ViewAccountTransactions();
+    account_image->ViewAccountTransactions();
 }
 
 /**
- * @brief Searches for a BankAccount by ID in a selected Customer/Bank using a sorted approach.
+ * @brief Searches for a BankAccount by ID in a selected Customer/Bank through the bank's ID index.
  * @param banks A reference to a vector of unique_ptr to Bank objects.
  */
 void SearchForAccount(std::vector<std::unique_ptr<Bank::Bank>> &banks)
@@ -691,20 +788,14 @@ void SearchForAccount(std::vector<std::unique_ptr<Bank::Bank>> &banks)
     }
 
     // Finally, search for the account by ID
-    std::string account_id = Utility::GetValidString("Enter account ID: ");
+    Bank::AccountID account_id = Bank::AccountID::Parse(Utility::GetValidString("Enter account ID: "));
 
-    auto it = std::lower_bound(customer->GetAccounts().begin(), customer->GetAccounts().end(), account_id,
-                               [](const std::unique_ptr<Bank::BankAccount> &a, const std::string &account_id)
-                               {
-                                   return a->GetID() < account_id;
-                               });
-
-    if (it != customer->GetAccounts().end() && (*it)->GetID() == account_id)
+    if (const Bank::BankAccount *account = FindAccount(customer, account_id))
     {
         // Found it
         std::cout << "Account found!\n";
-        std::cout << "Account ID: " << (*it)->GetID() << "\n";
-        std::cout << "Balance: $" << std::fixed << std::setprecision(2) << (*it)->GetBalance() << "\n";
+        std::cout << "Account ID: " << account->GetID() << "\n";
+        std::cout << "Balance: $" << std::fixed << std::setprecision(2) << account->GetBalance() << "\n";
     }
     else
     {
@@ -745,9 +836,10 @@ void SearchForTransaction(std::vector<std::unique_ptr<Bank::Bank>> &banks)
         return;
     }
 
-    const Bank::BankAccount *account = SelectAccount(customer);
+    Bank::BankAccount *account = SelectAccount(customer);
     if (!account)
         return;
+    account->LoadHistory();
 
     if (account->GetNumberOfTransactions() == 0)
     {
@@ -758,22 +850,23 @@ void SearchForTransaction(std::vector<std::unique_ptr<Bank::Bank>> &banks)
     // Query the user for the transaction ID
     i32 transaction_id = Utility::GetValidInput("Enter transaction ID: ", MIN_TRANSACTION_ID, MAX_TRANSACTION_ID);
 
-    const std::vector<std::unique_ptr<Bank::Transaction>> &transactions = account->GetTransactions();
-    auto it = std::lower_bound(transactions.begin(), transactions.end(), transaction_id,
-                               [](const std::unique_ptr<Bank::Transaction> &t, i32 id)
-                               {
-                                   return t->GetTransactionID() < id;
-                               });
-
-    if (it != transactions.end() && (*it)->GetTransactionID() == transaction_id)
+    Bank::TransactionImage found;
+    if (account->FindTransaction(transaction_id, found))
     {
         std::cout << "Transaction found!\n";
-        (*it)->DisplayTransaction();
+    }
+    else if (account->GetArchivedHistory() && account->GetArchivedHistory()->Find(transaction_id, found))
+    {
+        // Not in memory, but the account's older history is in the archive
+        std::cout << "Transaction found in the archive!\n";
     }
     else
     {
         std::cerr << "Error: Transaction not found.\n";
+        return;
     }
+    Bank::DisplayTransactionDetails(found.transaction_id, found.transaction_type, found.timestamp,
+                                    found.amount, found.balance_before, found.balance_after);
 }
 
 /**
@@ -782,33 +875,17 @@ void SearchForTransaction(std::vector<std::unique_ptr<Bank::Bank>> &banks)
  */
 void ApplyInterest(const std::vector<std::unique_ptr<Bank::Bank>> &banks)
 {
+    Bank::TraceSpan span("ApplyInterest");
     if (banks.empty())
     {
         std::cerr << "Error: No banks available.\n";
         return;
     }
 
-    bool has_savings_accounts = false;
-
     // Check if there's at least one SavingsAccount among all banks
-    for (const auto &bank : banks)
-    {
-        for (const auto &customer : bank->GetCustomers())
-        {
-            for (const auto &account : customer->GetAccounts())
-            {
-                if (dynamic_cast<Bank::SavingAccount *>(account.get()))
-                {
-                    has_savings_accounts = true;
-                    break;
-                }
-            }
-            if (has_savings_accounts)
-                break;
-        }
-        if (has_savings_accounts)
-            break;
-    }
+    bool has_savings_accounts = std::any_of(banks.begin(), banks.end(),
+                                            [](const std::unique_ptr<Bank::Bank> &b)
+                                            { return b->GetNumberOfSavingAccounts() > 0; });
 
     if (!has_savings_accounts)
     {
@@ -824,12 +901,625 @@ void ApplyInterest(const std::vector<std::unique_ptr<Bank::Bank>> &banks)
     std::cout << "Interest applied to all savings accounts in all banks.\n";
 }
 
+/**
+ * @brief Audits every account in every Bank and reports any ledger discrepancies.
+ * @param banks A const reference to a vector of unique_ptr to Bank objects.
+ */
+void AuditAllAccounts(const std::vector<std::unique_ptr<Bank::Bank>> &banks)
+{
+    if (banks.empty())
+    {
+        std::cerr << "Error: No banks available.\n";
+        return;
+    }
+
+    Bank::AuditReport report = Bank::AuditLedger(banks);
+    std::cout << "\n========= Ledger Audit =========\n";
+    Bank::PrintAuditReport(report, std::cout);
+}
+
+/**
+ * @brief Registers a recurring deposit, withdrawal or transfer against a selected BankAccount.
+ * @param banks A reference to a vector of unique_ptr to Bank objects.
+ */
+void ScheduleStandingOrder(std::vector<std::unique_ptr<Bank::Bank>> &banks)
+{
+    if (banks.empty())
+    {
+        std::cerr << "Error: No banks available. Create a bank first.\n";
+        return;
+    }
+
+    // Select bank -> customer -> account
+    Bank::Bank *bank = SelectBank(banks);
+    if (!bank)
+        return;
+
+    Bank::Customer *customer = SelectCustomer(bank);
+    if (!customer)
+        return;
+
+    Bank::BankAccount *account = SelectAccount(customer);
+    if (!account)
+        return;
+
+    auto transaction_type = static_cast<Bank::TransactionType>(Utility::GetValidInput(
+        "Enter transaction type (0: DEPOSIT, 1: WITHDRAW, 2: TRANSFER): ",
+        MIN_TRANSACTION_TYPE, MAX_TRANSACTION_TYPE));
+
+    Bank::AccountID dest_id;
+    if (transaction_type == Bank::TransactionType::TRANSFER)
+    {
+        if (customer->GetNumberOfAccounts() < 2)
+        {
+            std::cerr << "Error: You must have at least two accounts to transfer funds.\n";
+            return;
+        }
+
+        dest_id = Bank::AccountID::Parse(Utility::GetValidString("Enter the ID of the destination account: "));
+        if (dest_id == account->GetID() || !FindAccount(customer, dest_id))
+        {
+            std::cerr << "Error: Invalid destination account.\n";
+            return;
+        }
+    }
+
+    f64 amount = Utility::GetValidInput("Enter amount: ", MIN_TRANSACTION_AMOUNT, MAX_TRANSACTION_AMOUNT, true);
+    auto frequency = static_cast<Bank::Frequency>(Utility::GetValidInput(
+        "Enter frequency (0: DAILY, 1: WEEKLY, 2: MONTHLY): ", MIN_FREQUENCY, MAX_FREQUENCY));
+    i32 delay_days = Utility::GetValidInput("Enter days until the first run: ", MIN_SCHEDULE_DELAY_DAYS, MAX_SCHEDULE_DELAY_DAYS);
+
+    i64 first_due = Bank::SimClock::Shared().Now() + delay_days * SECONDS_PER_DAY;
+    Bank::Scheduler::Shared().AddStandingOrder(*account, transaction_type, amount, frequency, first_due, dest_id);
+}
+
+/**
+ * @brief Displays every standing order currently registered.
+ */
+void ViewStandingOrders()
+{
+    const Bank::Scheduler &scheduler = Bank::Scheduler::Shared();
+    if (scheduler.GetNumberOfStandingOrders() == 0)
+    {
+        std::cerr << "Error: No standing orders scheduled.\n";
+        return;
+    }
+
+    std::cout << "\n========= Standing Orders =========\n";
+    scheduler.ViewStandingOrders(std::cout);
+}
+
+/**
+ * @brief Lists the standing orders and cancels the one the user selects, so it never runs again.
+ */
+void CancelStandingOrder()
+{
+    Bank::Scheduler &scheduler = Bank::Scheduler::Shared();
+    if (scheduler.GetNumberOfStandingOrders() == 0)
+    {
+        std::cerr << "Error: No standing orders scheduled.\n";
+        return;
+    }
+
+    std::cout << "\n========= Standing Orders =========\n";
+    scheduler.ViewStandingOrders(std::cout);
+
+    u64 order_id = Utility::GetValidInput("Enter the ID of the order to cancel: ", MIN_STANDING_ORDER_ID, MAX_STANDING_ORDER_ID);
+    if (!scheduler.CancelStandingOrder(order_id))
+    {
+        std::cerr << "Error: Standing order #" << order_id << " not found.\n";
+        return;
+    }
+
+    std::cout << "Standing order #" << order_id << " cancelled.\n";
+}
+
+/**
+ * @brief Fast-forwards the simulated clock by a number of days, running every standing order that falls due.
+ */
+void AdvanceClock()
+{
+    i32 days = Utility::GetValidInput("Enter number of days to advance: ", MIN_ADVANCE_DAYS, MAX_ADVANCE_DAYS);
+
+    i64 target = Bank::SimClock::Shared().Now() + days * SECONDS_PER_DAY;
+    size_t executed = Bank::Scheduler::Shared().AdvanceTo(target);
+
+    std::cout << "Clock advanced to " << Bank::SimClock::FormatDate(target) << ". "
+              << executed << " standing order transaction(s) executed.\n";
+}
+
+/**
+ * @brief Runs (or resumes) the end-of-day batch and prints its per-stage report.
+ * @param banks A const reference to a vector of unique_ptr to Bank objects.
+ */
+void RunEndOfDay(const std::vector<std::unique_ptr<Bank::Bank>> &banks)
+{
+    if (banks.empty())
+    {
+        std::cerr << "Error: No banks available.\n";
+        return;
+    }
+
+    Bank::EndOfDay &end_of_day = Bank::EndOfDay::Shared();
+    bool finished = end_of_day.Run(banks);
+
+    std::cout << "\n========= End Of Day =========\n";
+    end_of_day.PrintReport(std::cout);
+    if (!finished)
+        std::cout << "End of day was interrupted. Run it again to resume from the last completed batch.\n";
+}
+
+/**
+ * @brief Applies every transaction in a feed file, skipping lines whose request key was already submitted.
+ *
+ * Each line is 'key,bank_id,customer_id,account_id,type,amount[,destination_account_id]', with type
+ * 0 (DEPOSIT), 1 (WITHDRAW) or 2 (TRANSFER). Blank lines and lines starting with '#' are ignored.
+ * Because every line carries a key, submitting the same file again after a timeout applies nothing twice.
+ *
+ * Lines are run through a TransactionPipeline, which applies them in feed order while parsing and
+ * journaling others; each line's outcome is appended to '<path>.journal'.
+ *
+ * @param banks A reference to a vector of unique_ptr to Bank objects.
+ */
+void SubmitTransactionFeed(std::vector<std::unique_ptr<Bank::Bank>> &banks)
+{
+    std::string path = Utility::GetValidString("Enter feed file path: ");
+    std::ifstream feed(path);
+    if (!feed.is_open())
+    {
+        std::cerr << "Error: " << path << " could not be opened.\n";
+        return;
+    }
+
+    Bank::PipelineReport report;
+    {
+        Bank::TransactionPipeline pipeline(banks, path + ".journal");
+        size_t line_number = 0;
+        std::string line;
+        while (std::getline(feed, line))
+        {
+            line_number++;
+            if (!line.empty() && line[0] != '#')
+                pipeline.Submit(line_number, std::move(line));
+        }
+        report = pipeline.Finish();
+    }
+
+    for (size_t line_number : report.rejected_lines)
+        std::cerr << "Error: Line " << line_number << " is not a valid transaction. Skipped.\n";
+
+    Bank::IdempotencyFilter &filter = Bank::IdempotencyFilter::Shared();
+    const std::ios::fmtflags flags = std::cout.flags();
+    const std::streamsize precision = std::cout.precision();
+    std::cout << "\n========= Transaction Feed =========\n";
+    std::cout << "Applied: " << report.applied << "\n";
+    std::cout << "Duplicates ignored: " << report.duplicates << "\n";
+    std::cout << "Invalid lines skipped: " << report.rejected << "\n";
+    std::cout << "Request keys remembered: " << filter.GetRememberedKeys() << " (up to " << IDEMPOTENCY_CAPACITY
+              << ", " << filter.GetBloomNegatives() << " new key(s) cleared by the Bloom filter alone)\n";
+    std::cout << "Pipeline: " << report.peak_in_flight << " request(s) in flight at peak on " << PIPELINE_THREADS
+              << " thread(s), " << std::fixed << std::setprecision(3) << report.elapsed_seconds << "s elapsed\n";
+    for (size_t i = 0; i < Bank::PIPELINE_STAGES; i++)
+        std::cout << "  " << std::left << std::setw(26) << Bank::PipelineStageToString(static_cast<Bank::PipelineStage>(i))
+                  << std::right << report.stage_seconds[i] << "s\n";
+    std::cout.flags(flags);
+    std::cout.precision(precision);
+}
+
+/**
+ * @brief Imports a CSV file of customers, and the accounts to open for them, into a selected Bank.
+ *
+ * Each row is 'customer_id,first_name,last_name,age[,C:balance|S:balance]...', where a customer_id of 0
+ * generates a random ID and each trailing field opens a checking (C) or saving (S) account.
+ *
+ * @param banks A reference to a vector of unique_ptr to Bank objects.
+ */
+void BulkLoadCustomers(std::vector<std::unique_ptr<Bank::Bank>> &banks)
+{
+    if (banks.empty())
+    {
+        std::cerr << "Error: No banks available. Create a bank first.\n";
+        return;
+    }
+
+    Bank::Bank *bank = SelectBank(banks);
+    if (!bank)
+        return;
+
+    std::string path = Utility::GetValidString("Enter customer file path: ");
+    Bank::BulkLoadReport report = Bank::ImportCustomers(*bank, path);
+
+    std::cout << "\n========= Bulk Load =========\n";
+    Bank::PrintBulkLoadReport(report, std::cout);
+}
+
+/**
+ * @brief Shows how much memory each bank holds per kind of entity, and how much of it is unused capacity.
+ *
+ * The same report is written to 'memory_report.txt' so it can be kept for sizing hosts.
+ *
+ * @param banks A const reference to a vector of unique_ptr to Bank objects.
+ */
+void ReportMemoryUsage(const std::vector<std::unique_ptr<Bank::Bank>> &banks)
+{
+    Bank::MemoryReport report = Bank::MeasureMemory(banks);
+
+    std::cout << "\n========= Memory Report =========\n";
+    Bank::PrintMemoryReport(report, std::cout);
+
+    std::ofstream ofs("memory_report.txt");
+    if (!ofs.is_open())
+    {
+        std::cerr << "Error: memory_report.txt could not be opened.\n";
+        return;
+    }
+    Bank::PrintMemoryReport(report, ofs);
+    std::cout << "Report written to memory_report.txt\n";
+}
+
+/**
+ * @brief Moves transactions older than a given age out of memory and into each bank's archive file.
+ *
+ * Accounts keep their recent history and a checkpoint of the rest; viewing, searching and writing
+ * transactions still read the archived ones back when needed.
+ *
+ * @param banks A reference to a vector of unique_ptr to Bank objects.
+ */
+void ArchiveOldTransactions(std::vector<std::unique_ptr<Bank::Bank>> &banks)
+{
+    if (banks.empty())
+    {
+        std::cerr << "Error: No banks available.\n";
+        return;
+    }
+
+    i32 days = Utility::GetValidInput("Archive transactions at least how many days old? ",
+                                      MIN_ARCHIVE_AGE_DAYS, MAX_ARCHIVE_AGE_DAYS);
+    const i64 cutoff = Bank::SimClock::Shared().Now() - static_cast<i64>(days) * SECONDS_PER_DAY;
+
+    size_t total = 0;
+    for (const auto &bank : banks)
+    {
+        size_t archived = bank->ArchiveTransactions(cutoff);
+        if (archived > 0)
+            std::cout << "Bank " << bank->GetID() << ": archived " << archived << " transaction(s) to "
+                      << bank->GetArchive()->GetPath() << "\n";
+        total += archived;
+    }
+    std::cout << "Archived " << total << " transaction(s) executed on or before "
+              << Bank::SimClock::FormatDate(cutoff) << ".\n";
+}
+
+/**
+ * @brief Applies a file of transfers between a selected Customer's accounts as one all-or-nothing batch.
+ *
+ * Each row is 'source_account_id,destination_account_id,amount'. If any leg is malformed or would fail
+ * (unknown account, out-of-range amount, insufficient funds at that point in the batch, velocity limit),
+ * nothing is transferred.
+ *
+ * @param banks A reference to a vector of unique_ptr to Bank objects.
+ */
+void BatchTransfer(std::vector<std::unique_ptr<Bank::Bank>> &banks)
+{
+    if (banks.empty())
+    {
+        std::cerr << "Error: No banks available. Create a bank first.\n";
+        return;
+    }
+
+    Bank::Bank *bank = SelectBank(banks);
+    if (!bank)
+        return;
+    Bank::Customer *customer = SelectCustomer(bank);
+    if (!customer)
+        return;
+
+    std::string path = Utility::GetValidString("Enter transfer batch file path: ");
+    Bank::TransferBatchReport report = Bank::ImportTransferBatch(*customer, path);
+    std::cout << "\n========= Batch Transfer =========\n";
+    Bank::PrintTransferBatchReport(report, std::cout);
+}
+
+/**
+ * @brief Answers an ad-hoc query over every transaction, e.g. withdrawals over $5,000 at one bank, or
+ *        the sum of deposits by account type.
+ *
+ * The query runs against the current snapshot: totals first, by the chosen group, then the matching
+ * transactions a page of QUERY_PAGE_SIZE at a time for as long as the user asks for more.
+ *
+ * @param banks A const reference to a vector of unique_ptr to Bank objects.
+ */
+void QueryTransactions(const std::vector<std::unique_ptr<Bank::Bank>> &banks)
+{
+    if (banks.empty())
+    {
+        std::cerr << "Error: No banks available.\n";
+        return;
+    }
+
+    Bank::TransactionQuery query;
+    query.bank_id = Utility::GetValidInput("Enter bank ID (0 for all): ", 0, MAX_BANK_ID);
+    query.customer_id = Utility::GetValidInput("Enter customer ID (0 for all): ", 0, MAX_CUSTOMER_ID);
+
+    i32 type = Utility::GetValidInput("Enter transaction type (0: DEPOSIT, 1: WITHDRAW, 2: TRANSFER, 3: any): ",
+                                      MIN_TRANSACTION_TYPE, MAX_TRANSACTION_TYPE + 1);
+    if (type <= MAX_TRANSACTION_TYPE)
+        query.transaction_types = static_cast<u8>(1u << type);
+    i32 account_type = Utility::GetValidInput("Enter account type (0: CHECKING, 1: SAVING, 2: any): ",
+                                              MIN_ACCOUNT_TYPE, MAX_ACCOUNT_TYPE + 1);
+    if (account_type <= MAX_ACCOUNT_TYPE)
+        query.account_types = static_cast<u8>(1u << account_type);
+    query.validity = static_cast<Bank::QueryValidity>(
+        Utility::GetValidInput("Enter status (0: any, 1: valid only, 2: declined only): ", 0, MAX_QUERY_VALIDITY));
+    query.min_amount = Utility::GetValidInput("Enter minimum amount: ", 0.0, MAX_TRANSACTION_AMOUNT, true);
+    query.max_amount = Utility::GetValidInput("Enter maximum amount: ", query.min_amount, MAX_TRANSACTION_AMOUNT, true);
+    query.group_by = static_cast<Bank::QueryGroup>(Utility::GetValidInput(
+        "Group totals by (0: none, 1: bank, 2: customer, 3: account type, 4: transaction type): ", 0, MAX_QUERY_GROUP));
+
+    std::shared_ptr<const Bank::SystemImage> snapshot = Bank::SnapshotManager::Shared().Acquire();
+    Bank::QuerySummary summary = Bank::RunQuery(*snapshot, query);
+
+    const std::ios::fmtflags flags = std::cout.flags();
+    const std::streamsize precision = std::cout.precision();
+    std::cout << "\n========= Query Results =========\n";
+    std::cout << std::fixed << std::setprecision(2);
+    for (const auto &[key, total] : summary.groups)
+        std::cout << Bank::QueryGroupLabel(query.group_by, key) << ": " << total.count << " transaction(s), $" << total.sum << "\n";
+    std::cout << "Total: " << summary.total.count << " transaction(s), $" << summary.total.sum << "\n";
+    std::cout << "Scanned " << summary.stats.accounts_scanned << " account(s) (" << summary.stats.accounts_skipped
+              << " skipped) and " << summary.stats.blocks_scanned << " block(s) (" << summary.stats.blocks_skipped
+              << " skipped by index) in " << std::setprecision(3) << summary.seconds << "s on "
+              << ThreadPool::Shared().GetThreadCount() << " thread(s)\n";
+    std::cout.flags(flags);
+    std::cout.precision(precision);
+
+    Bank::QueryCursor cursor(snapshot, query);
+    std::vector<Bank::QueryRow> page;
+    size_t shown = 0;
+    while (shown < summary.total.count && cursor.NextPage(QUERY_PAGE_SIZE, page))
+    {
+        std::cout << "\n--- Rows " << shown + 1 << " to " << shown + page.size() << " of " << summary.total.count << " ---\n";
+        for (const Bank::QueryRow &row : page)
+        {
+            std::cout << "Bank " << row.bank_id << ", Customer " << row.customer_id << ", Account " << row.account_id << "\n";
+            Bank::DisplayTransactionDetails(row.transaction.transaction_id, row.transaction.transaction_type,
+                                            row.transaction.timestamp, row.transaction.amount,
+                                            row.transaction.balance_before, row.transaction.balance_after);
+            if (row.transaction.was_invalid)
+                std::cout << "Status: DECLINED\n";
+        }
+        shown += page.size();
+        if (shown < summary.total.count && Utility::GetValidInput("Show the next page? (1: yes, 0: no): ", 0, 1) == 0)
+            break;
+    }
+}
+
+/**
+ * @brief Prints accounts with their owners and balances, one per line, up to MAX_RANKING_RESULTS of them.
+ * @param accounts The accounts, in the order to print them.
+ */
+void PrintBalanceRanking(const std::vector<Bank::BankAccount *> &accounts)
+{
+    const std::ios::fmtflags flags = std::cout.flags();
+    const std::streamsize precision = std::cout.precision();
+    std::cout << std::fixed << std::setprecision(2);
+    const size_t shown = std::min(accounts.size(), MAX_RANKING_RESULTS);
+    for (size_t i = 0; i < shown; i++)
+    {
+        const Bank::BankAccount &account = *accounts[i];
+        std::cout << i + 1 << ". Bank " << account.GetBank().GetID() << ", Customer " << account.GetAccountOwner().GetID()
+                  << ", Account " << account.GetID() << ": $" << account.GetBalance() << "\n";
+    }
+    if (accounts.size() > shown)
+        std::cout << "... and " << accounts.size() - shown << " more\n";
+    if (accounts.empty())
+        std::cout << "No accounts found.\n";
+    std::cout.flags(flags);
+    std::cout.precision(precision);
+}
+
+/**
+ * @brief Ranks accounts by balance at one bank or all of them: the largest balances, the balances within a
+ *        range, or where one account stands.
+ *
+ * Each bank keeps its accounts ordered by balance as they change, so none of these scans every account.
+ *
+ * @param banks A const reference to a vector of unique_ptr to Bank objects.
+ */
+void RankBalances(const std::vector<std::unique_ptr<Bank::Bank>> &banks)
+{
+    if (banks.empty())
+    {
+        std::cerr << "Error: No banks available.\n";
+        return;
+    }
+
+    i32 mode = Utility::GetValidInput("Rank by (0: largest balances, 1: balance range, 2: one account's rank): ", 0, MAX_RANKING_MODE);
+    if (mode == 2)
+    {
+        Bank::Bank *bank = SelectBank(banks);
+        if (!bank)
+            return;
+        Bank::Customer *customer = SelectCustomer(bank);
+        if (!customer)
+            return;
+        Bank::BankAccount *account = SelectAccount(customer);
+        if (!account)
+            return;
+
+        const f64 balance = account->GetBalance();
+        const std::ios::fmtflags flags = std::cout.flags();
+        const std::streamsize precision = std::cout.precision();
+        std::cout << "Account " << account->GetID() << " ($" << std::fixed << std::setprecision(2) << balance
+                  << ") ranks " << bank->GetBalanceIndex().CountAbove(*account) + 1 << " of " << bank->GetBalanceIndex().size()
+                  << " at bank " << bank->GetID() << " and " << Bank::CountBalancesAbove(banks, *account) + 1
+                  << " across all banks\n";
+        std::cout.flags(flags);
+        std::cout.precision(precision);
+        return;
+    }
+
+    // A single bank is queried through its own index; 0 combines every bank's
+    i32 bank_id = Utility::GetValidInput("Enter bank ID (0 for all): ", 0, MAX_BANK_ID);
+    Bank::Bank *bank = nullptr;
+    if (bank_id != 0 && !(bank = FindBank(banks, bank_id)))
+    {
+        std::cerr << "Error: Bank not found.\n";
+        return;
+    }
+
+    std::vector<Bank::BankAccount *> accounts;
+    if (mode == 0)
+    {
+        size_t count = static_cast<size_t>(Utility::GetValidInput("How many accounts? ", 1, static_cast<i32>(MAX_RANKING_RESULTS)));
+        if (bank)
+            bank->GetBalanceIndex().Top(count, accounts);
+        else
+            accounts = Bank::TopBalances(banks, count);
+    }
+    else
+    {
+        f64 min_balance = Utility::GetValidInput("Enter minimum balance: ", -MAX_BALANCE, MAX_BALANCE, true);
+        f64 max_balance = Utility::GetValidInput("Enter maximum balance: ", min_balance, MAX_BALANCE, true);
+        if (bank)
+            bank->GetBalanceIndex().Range(min_balance, max_balance, accounts);
+        else
+            accounts = Bank::BalancesInRange(banks, min_balance, max_balance);
+    }
+
+    std::cout << "\n========= Balance Rankings =========\n";
+    PrintBalanceRanking(accounts);
+}
+
+/**
+ * @brief Saves every bank, customer, account and transaction to a checkpoint file.
+ *
+ * Starting the program with '--restore <file>' brings them back; each account's history then stays in
+ * the file until it is first viewed or searched.
+ *
+ * @param banks A const reference to a vector of unique_ptr to Bank objects.
+ */
+void SaveBankCheckpoint(const std::vector<std::unique_ptr<Bank::Bank>> &banks)
+{
+    if (banks.empty())
+    {
+        std::cerr << "Error: No banks available.\n";
+        return;
+    }
+
+    std::string path = Utility::GetValidString("Enter checkpoint file path: ");
+    Bank::CheckpointWriter &writer = Bank::CheckpointWriter::Shared();
+    if (!writer.Start(banks, path))
+        return;
+
+    // Saved in place where the writer cannot fork
+    if (CollectCheckpoint(false))
+        return;
+
+    std::cout << "Saving checkpoint to " << path << " in the background; you will be told when it is done.\n";
+}
+
+/**
+ * @brief Reports on the checkpoint being saved in the background, if it has finished.
+ * @param wait True to wait for it to finish.
+ * @return True if a checkpoint finished and was reported on.
+ */
+bool CollectCheckpoint(bool wait)
+{
+    Bank::CheckpointWriter &writer = Bank::CheckpointWriter::Shared();
+    bool succeeded = false;
+    Bank::CheckpointReport report;
+    if (!writer.Collect(wait, succeeded, report))
+        return false;
+
+    if (!succeeded)
+    {
+        std::cerr << "Error: Could not save checkpoint to " << writer.GetPath() << ".\n";
+        return true;
+    }
+
+    std::cout << "\n========= Checkpoint Saved =========\n";
+    Bank::PrintCheckpointReport(report, std::cout);
+    std::cout << "Restore it with: --restore " << writer.GetPath() << "\n";
+    return true;
+}
+
+/**
+ * @brief Sets how many withdrawals per hour and how much money per day may leave a Customer's accounts or one account.
+ * @param banks A reference to a vector of unique_ptr to Bank objects.
+ */
+void ConfigureVelocityLimits(std::vector<std::unique_ptr<Bank::Bank>> &banks)
+{
+    if (banks.empty())
+    {
+        std::cerr << "Error: No banks available.\n";
+        return;
+    }
+
+    Bank::Bank *bank = SelectBank(banks);
+    if (!bank)
+        return;
+
+    if (bank->GetNumberOfCustomers() == 0)
+    {
+        std::cerr << "Error: No customers available in this bank.\n";
+        return;
+    }
+
+    Bank::Customer *customer = SelectCustomer(bank);
+    if (!customer)
+        return;
+
+    i32 scope = Utility::GetValidInput("Apply limits to (0: CUSTOMER, 1: ACCOUNT): ", MIN_LIMIT_SCOPE, MAX_LIMIT_SCOPE);
+
+    Bank::BankAccount *account = nullptr;
+    if (scope == 1)
+    {
+        if (customer->GetNumberOfAccounts() == 0)
+        {
+            std::cerr << "Error: This customer has no accounts.\n";
+            return;
+        }
+
+        account = SelectAccount(customer);
+        if (!account)
+            return;
+    }
+
+    Bank::VelocityLimits limits;
+    limits.max_withdrawals_per_hour = Utility::GetValidInput(
+        "Enter max withdrawals per hour (0 for unlimited): ", 0, MAX_WITHDRAWALS_PER_HOUR);
+    limits.max_amount_per_day = Utility::GetValidInput(
+        "Enter max amount withdrawn per day (0 for unlimited): ", 0.0, MAX_BALANCE, true);
+
+    if (account)
+        account->SetVelocityLimits(limits);
+    else
+        customer->SetVelocityLimits(limits);
+
+    if (account)
+        std::cout << "Velocity limits set for account " << account->GetID() << "\n";
+    else
+        std::cout << "Velocity limits set for " << customer->GetName() << "\n";
+    std::cout << "Max withdrawals per hour: ";
+    if (limits.max_withdrawals_per_hour > 0)
+        std::cout << limits.max_withdrawals_per_hour << "\n";
+    else
+        std::cout << "unlimited\n";
+    std::cout << "Max amount per day: ";
+    if (limits.max_amount_per_day > 0.0)
+        std::cout << "$" << std::fixed << std::setprecision(2) << limits.max_amount_per_day << "\n";
+    else
+        std::cout << "unlimited\n";
+}
+
 /**
  * @brief Writes all bank information (banks, customers, accounts, transactions) to a text file named 'bank_info.txt'.
  * @param banks A const reference to a vector of unique_ptr to Bank objects.
  */
 void WriteToFile(const std::vector<std::unique_ptr<Bank::Bank>> &banks)
 {
+    Bank::TraceSpan span("WriteToFile");
     std::ofstream ofs("bank_info.txt");
     if (!ofs.is_open())
     {
@@ -837,37 +1527,51 @@ void WriteToFile(const std::vector<std::unique_ptr<Bank::Bank>> &banks)
         return;
     }
 
-    // Iterate through each bank and its associated customers, accounts, and transactions
-    for (const auto &bank : banks)
+    // Export a published snapshot, so the file is a consistent point-in-time image even while writers run
+    std::shared_ptr<const Bank::SystemImage> snapshot = Bank::SnapshotManager::Shared().Publish(banks);
+    snapshot->WriteToStream(ofs);
+    ofs.close();
+}
+
+/**
+ * @brief Writes the header line of a Bank in the 'bank_info.txt' format.
+ * @param os The stream to write to.
+ * @param bank The Bank to write.
+ */
+void WriteBankRecord(std::ostream &os, const Bank::Bank &bank)
+{
+    os << "Bank: " << bank.GetID() << " | " << bank.GetName() << std::endl;
+}
+
+/**
+ * @brief Writes a Customer with all of its accounts and transactions in the 'bank_info.txt' format.
+ * @param os The stream to write to.
+ * @param customer The Customer to write.
+ */
+void WriteCustomerRecord(std::ostream &os, const Bank::Customer &customer)
+{
+    os << "\t"
+       << "Customer: " << customer.GetID() << " | "
+       << customer.GetName() << " | " << customer.GetAge() << std::endl;
+    for (const Bank::BankAccount &account : customer.GetAccounts())
     {
-        ofs << "Bank: " << bank->GetID() << " | " << bank->GetName() << std::endl;
-        for (const auto &customer : bank->GetCustomers())
+        os << "\t\t"
+           << "Account: " << account.GetID() << " | $"
+           << std::fixed << std::setprecision(2) << account.GetBalance() << std::endl;
+        for (const Bank::TransactionImage &transaction : account.GetHistoryByID())
         {
-            ofs << "\t"
-                << "Customer: " << customer->GetID() << " | "
-                << customer->GetName() << " | " << customer->GetAge() << std::endl;
-            for (const auto &account : customer->GetAccounts())
+            os << "\t\t\t"
+               << "Transaction: " << transaction.transaction_id << " | $"
+               << std::fixed << std::setprecision(2)
+               << transaction.amount << " | "
+               << Bank::TransactionTypeToString(transaction.transaction_type);
+
+            // If it was invalid, add an extra marker
+            if (transaction.was_invalid)
             {
-                ofs << "\t\t"
-                    << "Account: " << account->GetID() << " | $"
-                    << std::fixed << std::setprecision(2) << account->GetBalance() << std::endl;
-                for (const auto &transaction : account->GetTransactions())
-                {
-                    ofs << "\t\t\t"
-                        << "Transaction: " << transaction->GetTransactionID() << " | $"
-                        << std::fixed << std::setprecision(2)
-                        << transaction->GetTransactionAmount() << " | "
-                        << transaction->GetTransactionType();
-
-                    // If it was invalid, add an extra marker
-                    if (transaction->WasInvalid())
-                    {
-                        ofs << " [INVALID]";
-                    }
-                    ofs << '\n';
-                }
+                os << " [INVALID]";
             }
+            os << '\n';
         }
     }
-    ofs.close();
 }
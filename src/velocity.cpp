@@ -0,0 +1,75 @@
+/**
+ * @file velocity.cpp
+ * @brief This file implements the VelocityTracker, which enforces per-account and per-customer limits
+ *        on how often and how much money may be withdrawn.
+ */
+
+#include "../include/velocity.hpp"
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+namespace Bank
+{
+    namespace
+    {
+        /**
+         * @brief Converts a monetary amount to whole cents.
+         */
+        i64 ToCents(f64 amount)
+        {
+            return std::llround(amount * 100.0);
+        }
+    }
+
+    /**
+     * @class VelocityTracker
+     * @brief Sliding-window counters of recent withdrawals, checked against configurable limits.
+     */
+
+    /**
+     * @brief Constructs a tracker with no recorded activity.
+     * @param limits The limits to enforce.
+     */
+    VelocityTracker::VelocityTracker(const VelocityLimits &limits) : m_limits(limits)
+    {
+    }
+
+    /**
+     * @brief Checks whether one more withdrawal of the given amount stays within the limits.
+     * @param amount The amount about to be withdrawn or transferred out.
+     * @param now The current simulated time.
+     * @param reason Receives a description of the limit that would be exceeded.
+     * @return True if the withdrawal is allowed.
+     */
+    bool VelocityTracker::Allows(f64 amount, i64 now, std::string &reason)
+    {
+        if (m_limits.max_withdrawals_per_hour > 0 &&
+            m_withdrawals_per_hour.Total(now) + 1 > m_limits.max_withdrawals_per_hour)
+        {
+            reason = "at most " + std::to_string(m_limits.max_withdrawals_per_hour) + " withdrawal(s) per hour";
+            return false;
+        }
+
+        if (m_limits.max_amount_per_day > 0.0 &&
+            m_cents_per_day.Total(now) + ToCents(amount) > ToCents(m_limits.max_amount_per_day))
+        {
+            std::ostringstream oss;
+            oss << "at most $" << std::fixed << std::setprecision(2) << m_limits.max_amount_per_day << " per day";
+            reason = oss.str();
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Counts a withdrawal that has been applied.
+     * @param amount The amount withdrawn or transferred out.
+     * @param now The current simulated time.
+     */
+    void VelocityTracker::Record(f64 amount, i64 now)
+    {
+        m_withdrawals_per_hour.Add(now, 1);
+        m_cents_per_day.Add(now, ToCents(amount));
+    }
+}